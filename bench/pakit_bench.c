@@ -0,0 +1,296 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pakit.h"
+#include "pakit_parallel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PAKIT_BENCH_HAVE_TSC 1
+#endif
+
+// Throughput and latency benchmarks for the receive and encode paths.
+// Results go to stdout as one JSON document so runs can be compared by tools.
+//
+// Usage: pakit_bench [stream_megabytes] [repetitions]
+
+#define BENCH_READ_SIZE 4096     // Bytes handed to the receiver per call
+#define BENCH_MAX_VIEWS 256
+
+typedef struct {
+    PakitReceiver receiver;
+    PakitView views[BENCH_MAX_VIEWS];
+} BenchContext;
+
+// Decodes one read and returns the number of packets delivered
+typedef size_t (*BenchRun)(BenchContext* context, const uint8_t* data, size_t length);
+
+typedef struct {
+    const char* name;
+    BenchRun run;
+    size_t read_size;            // 0 to hand over the whole stream at once
+} BenchCase;
+
+static uint64_t bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static uint64_t bench_cycles(void) {
+#ifdef PAKIT_BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static size_t run_receive_byte(BenchContext* context, const uint8_t* data, size_t length) {
+    size_t packets = 0;
+    for (size_t i = 0; i < length; i++) {
+        packets += pakit_receive_byte(&context->receiver, data[i]) == PAKIT_STATUS_SUCCESS;
+    }
+    return packets;
+}
+
+static size_t run_receive_buffer(BenchContext* context, const uint8_t* data, size_t length) {
+    size_t packets = 0;
+    size_t position = 0;
+    while (position < length) {
+        packets += pakit_receive_buffer(&context->receiver, data, length, &position) == PAKIT_STATUS_SUCCESS;
+    }
+    return packets;
+}
+
+static size_t run_next_view(BenchContext* context, const uint8_t* data, size_t length) {
+    size_t packets = 0;
+    size_t position = 0;
+    while (position < length) {
+        packets += pakit_next_view(&context->receiver, data, length, &position,
+                                   &context->views[0]) == PAKIT_STATUS_SUCCESS;
+    }
+    return packets;
+}
+
+static size_t run_receive_batch(BenchContext* context, const uint8_t* data, size_t length) {
+    size_t packets = 0;
+    size_t position = 0;
+    while (position < length) {
+        size_t consumed = 0;
+        packets += pakit_receive_batch(&context->receiver, &data[position], length - position,
+                                       context->views, BENCH_MAX_VIEWS, &consumed);
+        position += consumed;
+    }
+    return packets;
+}
+
+static bool count_packet(void* context, size_t offset, const PakitView* view) {
+    (void)context;
+    (void)offset;
+    (void)view;
+    return true;
+}
+
+static size_t run_decode_parallel(BenchContext* context, const uint8_t* data, size_t length) {
+    PakitParallelOptions options = {0, 0, context->receiver.max_payload_size};
+    return pakit_decode_parallel(data, length, &options, count_packet, NULL);
+}
+
+static const BenchCase bench_cases[] = {
+    {"receive_byte", run_receive_byte, BENCH_READ_SIZE},
+    {"receive_buffer", run_receive_buffer, BENCH_READ_SIZE},
+    {"next_view", run_next_view, BENCH_READ_SIZE},
+    {"receive_batch", run_receive_batch, BENCH_READ_SIZE},
+    {"decode_parallel", run_decode_parallel, 0},
+};
+
+static uint32_t bench_seed = 12345;
+
+static uint8_t bench_random(void) {
+    bench_seed = bench_seed * 1103515245u + 12345u;
+    return (uint8_t)(bench_seed >> 16);
+}
+
+// Fills data with back-to-back packets of one payload size. With noise set,
+// every packet is preceded by a garbage run of up to 2 * payload_size + 16 bytes.
+static size_t build_stream(uint8_t* data, size_t capacity, uint16_t payload_size, bool noise,
+                           size_t* packet_count) {
+    uint8_t* payload = malloc(payload_size > 0 ? payload_size : 1);
+    size_t length = 0;
+    uint16_t count = 0;
+
+    for (uint16_t i = 0; i < payload_size; i++) {
+        payload[i] = bench_random();
+    }
+
+    *packet_count = 0;
+    while (true) {
+        size_t garbage = noise ? bench_random() % (2u * payload_size + 17u) : 0;
+        if (capacity - length < garbage + HEADER_SIZE + payload_size) {
+            break;
+        }
+        for (size_t i = 0; i < garbage; i++) {
+            data[length++] = bench_random();
+        }
+
+        Packet packet;
+        pakit_packet_create(&packet, 0x0101, count++, payload_size ? payload : NULL, payload_size);
+        size_t written = 0;
+        pakit_encode_batch(&packet, 1, &data[length], capacity - length, &written, NULL);
+        length += written;
+        (*packet_count)++;
+    }
+
+    free(payload);
+    return length;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void print_result(bool* first, const char* name, const char* stream, uint16_t payload_size,
+                         size_t bytes, size_t packets, uint64_t elapsed_ns, uint64_t cycles,
+                         uint64_t* latencies, size_t latency_count) {
+    qsort(latencies, latency_count, sizeof(uint64_t), compare_u64);
+    double seconds = (double)elapsed_ns / 1e9;
+
+    printf("%s\n    {\"name\": \"%s\", \"stream\": \"%s\", \"payload_size\": %u, "
+           "\"bytes\": %zu, \"packets\": %zu, \"mb_per_s\": %.2f, \"packets_per_s\": %.0f, ",
+           *first ? "" : ",", name, stream, payload_size, bytes, packets,
+           (double)bytes / 1e6 / seconds, (double)packets / seconds);
+#ifdef PAKIT_BENCH_HAVE_TSC
+    printf("\"cycles_per_byte\": %.3f, ", (double)cycles / (double)bytes);
+#else
+    (void)cycles;
+    printf("\"cycles_per_byte\": null, ");
+#endif
+    printf("\"p50_ns\": %llu, \"p99_ns\": %llu}",
+           (unsigned long long)latencies[latency_count / 2],
+           (unsigned long long)latencies[latency_count * 99 / 100]);
+    *first = false;
+}
+
+static void bench_receive(bool* first, const BenchCase* bench, const char* stream_name,
+                          const uint8_t* data, size_t length, uint16_t payload_size,
+                          unsigned repetitions) {
+    BenchContext* context = malloc(sizeof(BenchContext));
+    pakit_create(&context->receiver, NULL, payload_size > MAX_PACKET_SIZE ? payload_size : 0);
+
+    size_t read_size = bench->read_size ? bench->read_size : length;
+    size_t reads = (length + read_size - 1) / read_size;
+    uint64_t* latencies = malloc(reads * repetitions * sizeof(uint64_t));
+    size_t latency_count = 0;
+    size_t packets = 0;
+    uint64_t elapsed = 0;
+    uint64_t cycles = 0;
+
+    for (unsigned rep = 0; rep < repetitions; rep++) {
+        for (size_t offset = 0; offset < length; offset += read_size) {
+            size_t chunk = (length - offset < read_size) ? length - offset : read_size;
+
+            uint64_t start_cycles = bench_cycles();
+            uint64_t start = bench_now_ns();
+            packets += bench->run(context, &data[offset], chunk);
+            uint64_t took = bench_now_ns() - start;
+            cycles += bench_cycles() - start_cycles;
+
+            elapsed += took;
+            latencies[latency_count++] = took;
+        }
+    }
+
+    print_result(first, bench->name, stream_name, payload_size, length * repetitions, packets,
+                 elapsed, cycles, latencies, latency_count);
+
+    free(latencies);
+    pakit_destroy(&context->receiver);
+    free(context);
+}
+
+static void bench_encode(bool* first, uint16_t payload_size, size_t stream_size, unsigned repetitions) {
+    enum { BATCH = 64 };
+    uint8_t* payload = calloc(payload_size > 0 ? payload_size : 1, 1);
+    Packet packets[BATCH];
+    for (size_t i = 0; i < BATCH; i++) {
+        pakit_packet_create(&packets[i], 0x0101, 0, payload_size ? payload : NULL, payload_size);
+    }
+
+    size_t buffer_size = (size_t)BATCH * (HEADER_SIZE + payload_size);
+    uint8_t* buffer = malloc(buffer_size);
+    size_t batches = stream_size / buffer_size + 1;
+    uint64_t* latencies = malloc(batches * repetitions * sizeof(uint64_t));
+    size_t latency_count = 0;
+    size_t bytes = 0;
+    size_t encoded = 0;
+    uint64_t elapsed = 0;
+    uint64_t cycles = 0;
+    uint16_t sequence = 0;
+
+    for (unsigned rep = 0; rep < repetitions; rep++) {
+        for (size_t b = 0; b < batches; b++) {
+            size_t written = 0;
+
+            uint64_t start_cycles = bench_cycles();
+            uint64_t start = bench_now_ns();
+            encoded += pakit_encode_batch(packets, BATCH, buffer, buffer_size, &written, &sequence);
+            uint64_t took = bench_now_ns() - start;
+            cycles += bench_cycles() - start_cycles;
+
+            bytes += written;
+            elapsed += took;
+            latencies[latency_count++] = took;
+        }
+    }
+
+    print_result(first, "encode_batch", "clean", payload_size, bytes, encoded, elapsed, cycles,
+                 latencies, latency_count);
+
+    free(latencies);
+    free(buffer);
+    free(payload);
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = (argc > 1) ? strtoul(argv[1], NULL, 10) : 8;
+    unsigned repetitions = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 3;
+    if (megabytes == 0) {
+        megabytes = 1;
+    }
+    if (repetitions == 0) {
+        repetitions = 1;
+    }
+
+    const uint16_t payload_sizes[] = {0, 8, 64, 255, 1024, 8192};
+    size_t capacity = megabytes * 1024 * 1024;
+    uint8_t* data = malloc(capacity);
+    if (data == NULL) {
+        fprintf(stderr, "pakit_bench: cannot allocate %zu MiB\n", megabytes);
+        return 1;
+    }
+
+    bool first = true;
+    printf("{\n  \"read_size\": %d,\n  \"repetitions\": %u,\n  \"results\": [", BENCH_READ_SIZE,
+           repetitions);
+
+    for (size_t s = 0; s < sizeof(payload_sizes) / sizeof(payload_sizes[0]); s++) {
+        for (int noise = 0; noise < 2; noise++) {
+            size_t packet_count = 0;
+            size_t length = build_stream(data, capacity, payload_sizes[s], noise, &packet_count);
+
+            for (size_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+                bench_receive(&first, &bench_cases[c], noise ? "corrupt" : "clean", data, length,
+                              payload_sizes[s], repetitions);
+            }
+        }
+        bench_encode(&first, payload_sizes[s], capacity, repetitions);
+    }
+
+    printf("\n  ]\n}\n");
+    free(data);
+    return 0;
+}
@@ -0,0 +1,884 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "pakit.h"
+#include "pakit_dispatch.h"
+#include "pakit_filter.h"
+#include "pakit_packet_pool.h"
+#include "pakit_parallel.h"
+#include "pakit_spec.h"
+#include "pakit_stream.h"
+
+// Differential fuzz target for the receive paths. Every input is decoded by the
+// per-byte state machine (pakit_receive_byte), which is the reference, and by
+// each fast path with the stream cut into reads of varying sizes. The packets
+// delivered, and the partial packet a receiver holds at the end, must match
+// the reference exactly.
+//
+// Built with -DPAKIT_FUZZ_LIBFUZZER=ON this is a libFuzzer target. Otherwise
+// main() checks corpus files (one input per file, so AFL can run it with @@)
+// or generated streams, then reports the parse rate of every path on that
+// corpus as JSON. Given an earlier report it flags paths that got slower.
+//
+// Input layout: byte 0 selects the options (bit 0 CRC mode, bits 1-2 the payload
+// limit, bit 3 a type filter passing even types), byte 1 seeds the read sizes
+// and the rest is the byte stream.
+//
+// Usage: pakit_fuzz [-n cases] [-s seed] [-w dir] [-b baseline.json] [-t percent] [file|dir ...]
+
+#define FUZZ_CONFIG_SIZE 2
+#define FUZZ_MAX_VIEWS 4          // Small, so batches end mid-read
+#define FUZZ_SPEC_MAX_PAYLOAD 1024
+#define FUZZ_PENDING_UNKNOWN ((size_t)-1)
+
+static const uint16_t fuzz_payload_limits[] = {8, 64, MAX_PACKET_SIZE, FUZZ_SPEC_MAX_PAYLOAD};
+
+// The library's own format, specialized at compile time
+PAKIT_SPEC_RECEIVER(fuzz_spec, EXPECTED_SOP_0, EXPECTED_SOP_1, 2, 2, 2, true, FUZZ_SPEC_MAX_PAYLOAD)
+
+typedef struct {
+    bool crc;
+    bool filter;                  // Only even types are delivered
+    uint16_t max_payload_size;
+    uint32_t seed;                // Seeds the read sizes
+} FuzzConfig;
+
+typedef struct {
+    uint16_t type;
+    uint16_t count;
+    uint16_t size;
+    size_t offset;                // Payload position in FuzzLog.bytes
+} FuzzPacket;
+
+// Packets delivered by one path, with their payloads copied out
+typedef struct {
+    FuzzPacket *packets;
+    size_t count;
+    size_t capacity;
+    uint8_t *bytes;
+    size_t length;
+    size_t bytes_capacity;
+    bool streaming;               // A streamed packet is being collected
+    PakitView stream_header;
+    size_t stream_start;
+} FuzzLog;
+
+// Decodes data and logs each packet. Sets pending to the bytes of the partial
+// packet left in the receiver, or FUZZ_PENDING_UNKNOWN.
+// Returns false if the path does not support the configuration.
+typedef bool (*FuzzRun)(const FuzzConfig* config, const uint8_t* data, size_t length,
+                        FuzzLog* log, size_t* pending);
+
+typedef struct {
+    const char* name;
+    FuzzRun run;
+} FuzzPath;
+
+// Input under test, written out when a check fails
+static const uint8_t* fuzz_input;
+static size_t fuzz_input_size;
+
+static void fuzz_fail(const char* path, const char* what, size_t index) {
+    fprintf(stderr, "pakit_fuzz: %s differs from receive_byte: %s (packet %zu)\n", path, what, index);
+
+#ifndef PAKIT_FUZZ_LIBFUZZER
+    FILE* file = fopen("pakit_fuzz_failure.bin", "wb");
+    if (file != NULL) {
+        fwrite(fuzz_input, 1, fuzz_input_size, file);
+        fclose(file);
+        fprintf(stderr, "pakit_fuzz: input written to pakit_fuzz_failure.bin\n");
+    }
+#endif
+    abort();
+}
+
+static void* fuzz_grow(void* data, size_t* capacity, size_t needed, size_t element_size) {
+    if (needed <= *capacity) {
+        return data;
+    }
+
+    size_t capacity_new = (*capacity == 0) ? 256 : *capacity;
+    while (capacity_new < needed) {
+        capacity_new *= 2;
+    }
+    data = realloc(data, capacity_new * element_size);
+    if (data == NULL) {
+        fprintf(stderr, "pakit_fuzz: out of memory\n");
+        abort();
+    }
+    *capacity = capacity_new;
+    return data;
+}
+
+static void fuzz_log_reset(FuzzLog* log) {
+    log->count = 0;
+    log->length = 0;
+    log->streaming = false;
+}
+
+static void fuzz_log_free(FuzzLog* log) {
+    free(log->packets);
+    free(log->bytes);
+    memset(log, 0, sizeof(FuzzLog));
+}
+
+static void fuzz_log_bytes(FuzzLog* log, const uint8_t* data, size_t length) {
+    log->bytes = fuzz_grow(log->bytes, &log->bytes_capacity, log->length + length, 1);
+    if (length > 0) {
+        memcpy(&log->bytes[log->length], data, length);
+    }
+    log->length += length;
+}
+
+// Logs a packet whose payload already sits at offset in the log
+static void fuzz_log_packet(FuzzLog* log, const PakitView* view, size_t offset) {
+    log->packets = fuzz_grow(log->packets, &log->capacity, log->count + 1, sizeof(FuzzPacket));
+    FuzzPacket* packet = &log->packets[log->count++];
+    packet->type = view->type;
+    packet->count = view->count;
+    packet->size = view->size;
+    packet->offset = offset;
+}
+
+static void fuzz_log_view(FuzzLog* log, const PakitView* view) {
+    size_t offset = log->length;
+    fuzz_log_bytes(log, view->payload, view->size);
+    fuzz_log_packet(log, view, offset);
+}
+
+static void fuzz_compare(const char* path, const FuzzLog* expected, size_t expected_pending,
+                         const FuzzLog* actual, size_t actual_pending) {
+    size_t count = (expected->count < actual->count) ? expected->count : actual->count;
+
+    for (size_t i = 0; i < count; i++) {
+        const FuzzPacket* want = &expected->packets[i];
+        const FuzzPacket* got = &actual->packets[i];
+        if (want->type != got->type || want->count != got->count || want->size != got->size) {
+            fuzz_fail(path, "header fields", i);
+        }
+        if (memcmp(&expected->bytes[want->offset], &actual->bytes[got->offset], want->size) != 0) {
+            fuzz_fail(path, "payload", i);
+        }
+    }
+    if (expected->count != actual->count) {
+        fuzz_fail(path, "packet count", count);
+    }
+    if (actual_pending != FUZZ_PENDING_UNKNOWN && actual_pending != expected_pending) {
+        fuzz_fail(path, "partial packet left in the receiver", count);
+    }
+}
+
+// Next read size: mostly short reads, with the occasional large one
+static size_t fuzz_read_size(uint32_t* seed) {
+    static const size_t limits[] = {1, 3, 16, 300, 4096};
+
+    *seed = *seed * 1103515245u + 12345u;
+    uint32_t r = *seed >> 8;
+    return 1 + r % limits[(r >> 16) % (sizeof(limits) / sizeof(limits[0]))];
+}
+
+static PakitTypeFilter fuzz_even_types;
+
+static void fuzz_receiver(PakitReceiver* receiver, const FuzzConfig* config) {
+    if (pakit_create(receiver, NULL, config->max_payload_size) != PAKIT_STATUS_SUCCESS) {
+        fprintf(stderr, "pakit_fuzz: out of memory\n");
+        abort();
+    }
+    pakit_set_crc(receiver, config->crc);
+
+    if (config->filter) {
+        if (!pakit_filter_accepts(&fuzz_even_types, 0)) {
+            for (uint32_t type = 0; type <= 0xFFFF; type += 2) {
+                pakit_filter_set(&fuzz_even_types, (uint16_t)type, (uint16_t)type, true);
+            }
+        }
+        pakit_set_filter(receiver, &fuzz_even_types);
+    }
+}
+
+static size_t fuzz_pending(const PakitReceiver* receiver) {
+    return (receiver->state == STATE_COMPLETE) ? 0 : receiver->received_bytes;
+}
+
+static bool run_receive_byte(const FuzzConfig* config, const uint8_t* data, size_t length,
+                             FuzzLog* log, size_t* pending) {
+    PakitReceiver receiver;
+    fuzz_receiver(&receiver, config);
+
+    for (size_t i = 0; i < length; i++) {
+        Packet packet;
+        if (pakit_receive_byte(&receiver, data[i]) == PAKIT_STATUS_SUCCESS &&
+            pakit_is_packet_complete(&receiver, &packet)) {
+            PakitView view = {((uint16_t)packet.type[0] << 8) | packet.type[1], packet.count,
+                              packet.size, packet.payload};
+            fuzz_log_view(log, &view);
+        }
+    }
+
+    *pending = fuzz_pending(&receiver);
+    pakit_destroy(&receiver);
+    return true;
+}
+
+static bool run_receive_buffer(const FuzzConfig* config, const uint8_t* data, size_t length,
+                               FuzzLog* log, size_t* pending) {
+    PakitReceiver receiver;
+    uint32_t seed = config->seed;
+    fuzz_receiver(&receiver, config);
+
+    for (size_t offset = 0; offset < length;) {
+        size_t read = fuzz_read_size(&seed);
+        size_t chunk = (length - offset < read) ? length - offset : read;
+        size_t position = 0;
+
+        while (position < chunk) {
+            Packet packet;
+            if (pakit_receive_buffer(&receiver, &data[offset], chunk, &position) == PAKIT_STATUS_SUCCESS &&
+                pakit_is_packet_complete(&receiver, &packet)) {
+                PakitView view = {((uint16_t)packet.type[0] << 8) | packet.type[1], packet.count,
+                                  packet.size, packet.payload};
+                fuzz_log_view(log, &view);
+            }
+        }
+        offset += chunk;
+    }
+
+    *pending = fuzz_pending(&receiver);
+    pakit_destroy(&receiver);
+    return true;
+}
+
+static bool run_next_view(const FuzzConfig* config, const uint8_t* data, size_t length,
+                          FuzzLog* log, size_t* pending) {
+    PakitReceiver receiver;
+    uint32_t seed = config->seed;
+    fuzz_receiver(&receiver, config);
+
+    for (size_t offset = 0; offset < length;) {
+        size_t read = fuzz_read_size(&seed);
+        size_t chunk = (length - offset < read) ? length - offset : read;
+        size_t position = 0;
+
+        while (position < chunk) {
+            PakitView view;
+            if (pakit_next_view(&receiver, &data[offset], chunk, &position, &view) == PAKIT_STATUS_SUCCESS) {
+                fuzz_log_view(log, &view);
+            }
+        }
+        offset += chunk;
+    }
+
+    *pending = fuzz_pending(&receiver);
+    pakit_destroy(&receiver);
+    return true;
+}
+
+static bool run_receive_batch(const FuzzConfig* config, const uint8_t* data, size_t length,
+                              FuzzLog* log, size_t* pending) {
+    PakitReceiver receiver;
+    uint32_t seed = config->seed;
+    fuzz_receiver(&receiver, config);
+
+    for (size_t offset = 0; offset < length;) {
+        size_t read = fuzz_read_size(&seed);
+        size_t chunk = (length - offset < read) ? length - offset : read;
+        size_t position = 0;
+
+        while (position < chunk) {
+            PakitView views[FUZZ_MAX_VIEWS];
+            size_t consumed = 0;
+            size_t count = pakit_receive_batch(&receiver, &data[offset + position], chunk - position,
+                                               views, FUZZ_MAX_VIEWS, &consumed);
+            if (count == 0 && consumed == 0) {
+                fuzz_fail("receive_batch", "no progress", log->count);
+            }
+            for (size_t i = 0; i < count; i++) {
+                fuzz_log_view(log, &views[i]);
+            }
+            position += consumed;
+        }
+        offset += chunk;
+    }
+
+    *pending = fuzz_pending(&receiver);
+    pakit_destroy(&receiver);
+    return true;
+}
+
+static bool fuzz_dispatch_handler(void* context, const PakitView* view) {
+    fuzz_log_view(context, view);
+    return true;
+}
+
+static bool run_dispatch(const FuzzConfig* config, const uint8_t* data, size_t length,
+                         FuzzLog* log, size_t* pending) {
+    PakitReceiver receiver;
+    uint32_t seed = config->seed;
+    fuzz_receiver(&receiver, config);
+    pakit_on_unhandled(&receiver, fuzz_dispatch_handler, log);
+
+    for (size_t offset = 0; offset < length;) {
+        size_t read = fuzz_read_size(&seed);
+        size_t chunk = (length - offset < read) ? length - offset : read;
+        size_t consumed = 0;
+
+        pakit_receive_dispatch(&receiver, &data[offset], chunk, &consumed);
+        if (consumed != chunk) {
+            fuzz_fail("dispatch", "read not fully consumed", log->count);
+        }
+        offset += chunk;
+    }
+
+    *pending = fuzz_pending(&receiver);
+    pakit_destroy(&receiver);
+    return true;
+}
+
+static void fuzz_stream_header(void* context, const PakitView* header) {
+    FuzzLog* log = context;
+    if (log->streaming) {
+        fuzz_fail("stream", "header before the previous packet ended", log->count);
+    }
+    log->streaming = true;
+    log->stream_header = *header;
+    log->stream_start = log->length;
+}
+
+static void fuzz_stream_chunk(void* context, size_t offset, const uint8_t* data, size_t length) {
+    FuzzLog* log = context;
+    if (!log->streaming || offset != log->length - log->stream_start ||
+        offset + length > log->stream_header.size) {
+        fuzz_fail("stream", "chunk out of order", log->count);
+    }
+    fuzz_log_bytes(log, data, length);
+}
+
+static void fuzz_stream_end(void* context, PakitStatus status) {
+    FuzzLog* log = context;
+    if (!log->streaming) {
+        fuzz_fail("stream", "end without a header", log->count);
+    }
+
+    log->streaming = false;
+    if (status == PAKIT_STATUS_SUCCESS) {
+        if (log->length - log->stream_start != log->stream_header.size) {
+            fuzz_fail("stream", "payload length", log->count);
+        }
+        fuzz_log_packet(log, &log->stream_header, log->stream_start);
+    } else {
+        log->length = log->stream_start;
+    }
+}
+
+static bool run_stream(const FuzzConfig* config, const uint8_t* data, size_t length,
+                       FuzzLog* log, size_t* pending) {
+    PakitReceiver receiver;
+    PakitStream stream = {fuzz_stream_header, fuzz_stream_chunk, fuzz_stream_end, log,
+                          config->max_payload_size};
+    uint32_t seed = config->seed;
+
+    // Streaming needs no payload storage beyond what pakit_create sets up
+    fuzz_receiver(&receiver, config);
+    pakit_set_stream(&receiver, &stream);
+
+    for (size_t offset = 0; offset < length;) {
+        size_t read = fuzz_read_size(&seed);
+        size_t chunk = (length - offset < read) ? length - offset : read;
+        size_t position = 0;
+
+        while (position < chunk) {
+            pakit_receive_buffer(&receiver, &data[offset], chunk, &position);
+        }
+        offset += chunk;
+    }
+
+    // Drop the payload of a packet still being streamed
+    if (log->streaming) {
+        log->length = log->stream_start;
+        log->streaming = false;
+    }
+
+    *pending = fuzz_pending(&receiver);
+    pakit_destroy(&receiver);
+    return true;
+}
+
+static bool run_packet_pool(const FuzzConfig* config, const uint8_t* data, size_t length,
+                            FuzzLog* log, size_t* pending) {
+    PakitReceiver receiver;
+    PakitPacketPool pool;
+    uint32_t seed = config->seed;
+
+    if (pakit_packet_pool_create(&pool, 2, config->max_payload_size) != PAKIT_STATUS_SUCCESS) {
+        fprintf(stderr, "pakit_fuzz: out of memory\n");
+        abort();
+    }
+    fuzz_receiver(&receiver, config);
+    pakit_attach_packet_pool(&receiver, &pool);
+
+    for (size_t offset = 0; offset < length;) {
+        size_t read = fuzz_read_size(&seed);
+        size_t chunk = (length - offset < read) ? length - offset : read;
+        size_t position = 0;
+
+        while (position < chunk) {
+            if (pakit_receive_buffer(&receiver, &data[offset], chunk, &position) != PAKIT_STATUS_SUCCESS) {
+                continue;
+            }
+
+            PakitPacket* packet = pakit_take_packet(&receiver);
+            if (packet == NULL) {
+                fuzz_fail("packet_pool", "completed packet could not be taken", log->count);
+            }
+            fuzz_log_view(log, &packet->view);
+            pakit_packet_release(packet);
+        }
+        offset += chunk;
+    }
+
+    *pending = fuzz_pending(&receiver);
+    pakit_destroy(&receiver);
+    pakit_packet_pool_destroy(&pool);
+    return true;
+}
+
+static bool run_spec(const FuzzConfig* config, const uint8_t* data, size_t length,
+                     FuzzLog* log, size_t* pending) {
+    static fuzz_spec_receiver receiver;
+    uint32_t seed = config->seed;
+
+    // The specialized receiver has a fixed payload limit, no CRC mode and no filter
+    if (config->crc || config->filter || config->max_payload_size != FUZZ_SPEC_MAX_PAYLOAD) {
+        return false;
+    }
+
+    fuzz_spec_init(&receiver);
+    for (size_t offset = 0; offset < length;) {
+        size_t read = fuzz_read_size(&seed);
+        size_t chunk = (length - offset < read) ? length - offset : read;
+        size_t position = 0;
+
+        while (position < chunk) {
+            PakitView view;
+            if (fuzz_spec_receive_buffer(&receiver, &data[offset], chunk, &position, &view) ==
+                PAKIT_STATUS_SUCCESS) {
+                fuzz_log_view(log, &view);
+            }
+        }
+        offset += chunk;
+    }
+
+    *pending = receiver.received;
+    return true;
+}
+
+static bool fuzz_parallel_packet(void* context, size_t offset, const PakitView* view) {
+    (void)offset;
+    fuzz_log_view(context, view);
+    return true;
+}
+
+static bool run_decode_parallel(const FuzzConfig* config, const uint8_t* data, size_t length,
+                                FuzzLog* log, size_t* pending) {
+    // Small chunks, so packets straddle chunk boundaries
+    PakitParallelOptions options = {3, (size_t)64 << (config->seed % 6), config->max_payload_size};
+
+    if (config->crc || config->filter) {
+        return false;
+    }
+
+    pakit_decode_parallel(data, length, &options, fuzz_parallel_packet, log);
+    *pending = FUZZ_PENDING_UNKNOWN;
+    return true;
+}
+
+// The reference comes first
+static const FuzzPath fuzz_paths[] = {
+    {"receive_byte", run_receive_byte},
+    {"receive_buffer", run_receive_buffer},
+    {"next_view", run_next_view},
+    {"receive_batch", run_receive_batch},
+    {"dispatch", run_dispatch},
+    {"stream", run_stream},
+    {"packet_pool", run_packet_pool},
+    {"spec", run_spec},
+    {"decode_parallel", run_decode_parallel},
+};
+
+#define FUZZ_PATH_COUNT (sizeof(fuzz_paths) / sizeof(fuzz_paths[0]))
+
+static FuzzConfig fuzz_config(const uint8_t* data) {
+    FuzzConfig config;
+    config.crc = (data[0] & 1) != 0;
+    config.filter = (data[0] & 8) != 0;
+    config.max_payload_size = fuzz_payload_limits[(data[0] >> 1) & 3];
+    config.seed = ((uint32_t)data[0] << 8) | data[1];
+    return config;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static FuzzLog expected;
+    static FuzzLog actual;
+
+    if (size < FUZZ_CONFIG_SIZE) {
+        return 0;
+    }
+
+    FuzzConfig config = fuzz_config(data);
+    const uint8_t* stream = &data[FUZZ_CONFIG_SIZE];
+    size_t length = size - FUZZ_CONFIG_SIZE;
+    size_t expected_pending = 0;
+
+    fuzz_input = data;
+    fuzz_input_size = size;
+
+    fuzz_log_reset(&expected);
+    fuzz_paths[0].run(&config, stream, length, &expected, &expected_pending);
+
+    for (size_t p = 1; p < FUZZ_PATH_COUNT; p++) {
+        size_t pending = 0;
+        fuzz_log_reset(&actual);
+        if (fuzz_paths[p].run(&config, stream, length, &actual, &pending)) {
+            fuzz_compare(fuzz_paths[p].name, &expected, expected_pending, &actual, pending);
+        }
+    }
+
+    return 0;
+}
+
+#ifndef PAKIT_FUZZ_LIBFUZZER
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} FuzzCase;
+
+typedef struct {
+    FuzzCase *cases;
+    size_t count;
+    size_t capacity;
+    size_t bytes;
+} FuzzCorpus;
+
+static uint32_t fuzz_seed = 12345;
+
+static uint32_t fuzz_random(void) {
+    fuzz_seed = fuzz_seed * 1103515245u + 12345u;
+    return fuzz_seed >> 8;
+}
+
+static uint64_t fuzz_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static void fuzz_corpus_add(FuzzCorpus* corpus, uint8_t* data, size_t size) {
+    corpus->cases = fuzz_grow(corpus->cases, &corpus->capacity, corpus->count + 1, sizeof(FuzzCase));
+    corpus->cases[corpus->count].data = data;
+    corpus->cases[corpus->count].size = size;
+    corpus->count++;
+    corpus->bytes += size;
+}
+
+static bool fuzz_load_file(FuzzCorpus* corpus, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    uint8_t* data = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+    size_t got;
+    do {
+        data = fuzz_grow(data, &capacity, size + 4096, 1);
+        got = fread(&data[size], 1, capacity - size, file);
+        size += got;
+    } while (got > 0);
+    fclose(file);
+
+    fuzz_corpus_add(corpus, data, size);
+    return true;
+}
+
+// Loads a file, or every file in a directory
+static bool fuzz_load(FuzzCorpus* corpus, const char* path) {
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        return false;
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        return fuzz_load_file(corpus, path);
+    }
+
+    DIR* directory = opendir(path);
+    if (directory == NULL) {
+        return false;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+
+        char file[4096];
+        snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+        if (stat(file, &info) == 0 && S_ISREG(info.st_mode)) {
+            fuzz_load_file(corpus, file);
+        }
+    }
+    closedir(directory);
+    return true;
+}
+
+// Builds one input: options, a run of valid packets (with trailers in CRC
+// mode), then a few random corruptions
+static void fuzz_generate(FuzzCorpus* corpus) {
+    enum { CAPACITY = 32768 };
+    uint8_t* data = malloc(CAPACITY);
+    uint8_t payload[FUZZ_SPEC_MAX_PAYLOAD + 64];
+    size_t length = FUZZ_CONFIG_SIZE;
+
+    data[0] = (uint8_t)fuzz_random();
+    data[1] = (uint8_t)fuzz_random();
+    FuzzConfig config = fuzz_config(data);
+
+    unsigned packet_count = 1 + fuzz_random() % 48;
+    for (unsigned i = 0; i < packet_count; i++) {
+        // Mostly packets within the limit, a few just over it
+        uint16_t size = (uint16_t)(fuzz_random() % (config.max_payload_size + 1u));
+        if (fuzz_random() % 16 == 0) {
+            size = (uint16_t)(config.max_payload_size + 1 + fuzz_random() % 32);
+        }
+        if (CAPACITY - length < (size_t)HEADER_SIZE + size + PAKIT_CRC_SIZE) {
+            break;
+        }
+
+        for (uint16_t b = 0; b < size; b++) {
+            // Payloads full of SOP bytes exercise the resync paths after corruption
+            uint32_t r = fuzz_random();
+            payload[b] = (r % 8 == 0) ? EXPECTED_SOP_0 : (r % 8 == 1) ? EXPECTED_SOP_1 : (uint8_t)(r >> 8);
+        }
+
+        Packet packet;
+        pakit_packet_create(&packet, (uint16_t)(fuzz_random() % 4), (uint16_t)i,
+                            size > 0 ? payload : NULL, size);
+        if (config.crc) {
+            length += pakit_encode_crc(&packet, &data[length], CAPACITY - length);
+        } else {
+            size_t written = 0;
+            pakit_encode_batch(&packet, 1, &data[length], CAPACITY - length, &written, NULL);
+            length += written;
+        }
+    }
+
+    unsigned corruptions = fuzz_random() % 6;
+    for (unsigned i = 0; i < corruptions && length > FUZZ_CONFIG_SIZE; i++) {
+        size_t at = FUZZ_CONFIG_SIZE + fuzz_random() % (length - FUZZ_CONFIG_SIZE);
+        switch (fuzz_random() % 4) {
+            case 0:
+                // Flip a bit
+                data[at] ^= (uint8_t)(1u << (fuzz_random() % 8));
+                break;
+            case 1:
+                // Insert a stray first SOP byte
+                if (length < CAPACITY) {
+                    memmove(&data[at + 1], &data[at], length - at);
+                    data[at] = EXPECTED_SOP_0;
+                    length++;
+                }
+                break;
+            case 2: {
+                // Drop a few bytes
+                size_t count = 1 + fuzz_random() % 16;
+                count = (length - at < count) ? length - at : count;
+                memmove(&data[at], &data[at + count], length - at - count);
+                length -= count;
+                break;
+            }
+            default: {
+                // Insert garbage
+                size_t count = 1 + fuzz_random() % 64;
+                if (CAPACITY - length >= count) {
+                    memmove(&data[at + count], &data[at], length - at);
+                    for (size_t b = 0; b < count; b++) {
+                        data[at + b] = (uint8_t)fuzz_random();
+                    }
+                    length += count;
+                }
+                break;
+            }
+        }
+    }
+
+    fuzz_corpus_add(corpus, data, length);
+}
+
+static bool fuzz_write_corpus(const FuzzCorpus* corpus, const char* directory) {
+    for (size_t i = 0; i < corpus->count; i++) {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/case-%05zu.bin", directory, i);
+
+        FILE* file = fopen(path, "wb");
+        if (file == NULL) {
+            return false;
+        }
+        fwrite(corpus->cases[i].data, 1, corpus->cases[i].size, file);
+        fclose(file);
+    }
+    return true;
+}
+
+// Rate a path reached in an earlier report, or a negative value if it has none
+static double fuzz_baseline_rate(const char* baseline, const char* name) {
+    char needle[64];
+    snprintf(needle, sizeof(needle), "\"name\": \"%s\",", name);
+
+    const char* entry = strstr(baseline, needle);
+    const char* rate = (entry != NULL) ? strstr(entry, "\"mb_per_s\": ") : NULL;
+    return (rate != NULL) ? strtod(rate + strlen("\"mb_per_s\": "), NULL) : -1.0;
+}
+
+static char* fuzz_read_text(const char* path) {
+    FuzzCorpus file = {0};
+    if (!fuzz_load_file(&file, path)) {
+        return NULL;
+    }
+
+    char* text = realloc(file.cases[0].data, file.cases[0].size + 1);
+    text[file.cases[0].size] = '\0';
+    free(file.cases);
+    return text;
+}
+
+// Times every receive path over the corpus and prints the report. Returns the
+// number of paths more than tolerance percent slower than in baseline.
+static unsigned fuzz_report_rates(const FuzzCorpus* corpus, const char* baseline, double tolerance) {
+    enum { MIN_BYTES = 32 * 1024 * 1024 };
+    FuzzLog log = {0};
+    unsigned regressions = 0;
+    unsigned repetitions = (corpus->bytes > 0) ? (unsigned)(MIN_BYTES / corpus->bytes) + 1 : 1;
+
+    printf("{\n  \"cases\": %zu,\n  \"bytes\": %zu,\n  \"repetitions\": %u,\n  \"results\": [",
+           corpus->count, corpus->bytes, repetitions);
+
+    // decode_parallel is left out: on small inputs it times thread start-up
+    bool first = true;
+    for (size_t p = 0; p < FUZZ_PATH_COUNT; p++) {
+        if (fuzz_paths[p].run == run_decode_parallel) {
+            continue;
+        }
+
+        size_t bytes = 0;
+        uint64_t start = fuzz_now_ns();
+        for (unsigned rep = 0; rep < repetitions; rep++) {
+            for (size_t i = 0; i < corpus->count; i++) {
+                const FuzzCase* input = &corpus->cases[i];
+                if (input->size < FUZZ_CONFIG_SIZE) {
+                    continue;
+                }
+
+                FuzzConfig config = fuzz_config(input->data);
+                size_t pending;
+                fuzz_log_reset(&log);
+                if (fuzz_paths[p].run(&config, &input->data[FUZZ_CONFIG_SIZE],
+                                      input->size - FUZZ_CONFIG_SIZE, &log, &pending)) {
+                    bytes += input->size - FUZZ_CONFIG_SIZE;
+                }
+            }
+        }
+        double seconds = (double)(fuzz_now_ns() - start) / 1e9;
+        double rate = (seconds > 0) ? (double)bytes / 1e6 / seconds : 0;
+
+        printf("%s\n    {\"name\": \"%s\", \"bytes\": %zu, \"mb_per_s\": %.2f", first ? "" : ",",
+               fuzz_paths[p].name, bytes, rate);
+        if (baseline != NULL) {
+            double before = fuzz_baseline_rate(baseline, fuzz_paths[p].name);
+            bool slower = before > 0 && rate < before * (1.0 - tolerance / 100.0);
+            if (before > 0) {
+                printf(", \"baseline_mb_per_s\": %.2f", before);
+            }
+            printf(", \"regression\": %s", slower ? "true" : "false");
+            regressions += slower;
+        }
+        printf("}");
+        first = false;
+    }
+
+    printf("\n  ],\n  \"regressions\": %u\n}\n", regressions);
+    fuzz_log_free(&log);
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    FuzzCorpus corpus = {0};
+    size_t generated = 2000;
+    const char* write_directory = NULL;
+    const char* baseline_path = NULL;
+    double tolerance = 10.0;
+    bool have_files = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "-n") == 0 && value != NULL) {
+            generated = strtoul(value, NULL, 10);
+            i++;
+        } else if (strcmp(argv[i], "-s") == 0 && value != NULL) {
+            fuzz_seed = (uint32_t)strtoul(value, NULL, 10);
+            i++;
+        } else if (strcmp(argv[i], "-w") == 0 && value != NULL) {
+            write_directory = value;
+            i++;
+        } else if (strcmp(argv[i], "-b") == 0 && value != NULL) {
+            baseline_path = value;
+            i++;
+        } else if (strcmp(argv[i], "-t") == 0 && value != NULL) {
+            tolerance = strtod(value, NULL);
+            i++;
+        } else if (fuzz_load(&corpus, argv[i])) {
+            have_files = true;
+        } else {
+            fprintf(stderr, "pakit_fuzz: cannot read %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (!have_files) {
+        for (size_t i = 0; i < generated; i++) {
+            fuzz_generate(&corpus);
+        }
+    }
+    if (write_directory != NULL && !fuzz_write_corpus(&corpus, write_directory)) {
+        fprintf(stderr, "pakit_fuzz: cannot write to %s\n", write_directory);
+        return 1;
+    }
+
+    char* baseline = NULL;
+    if (baseline_path != NULL && (baseline = fuzz_read_text(baseline_path)) == NULL) {
+        fprintf(stderr, "pakit_fuzz: cannot read %s\n", baseline_path);
+        return 1;
+    }
+
+    // A mismatch aborts inside the check
+    for (size_t i = 0; i < corpus.count; i++) {
+        LLVMFuzzerTestOneInput(corpus.cases[i].data, corpus.cases[i].size);
+    }
+    fprintf(stderr, "pakit_fuzz: %zu inputs, %zu bytes, all paths agree\n", corpus.count, corpus.bytes);
+
+    unsigned regressions = fuzz_report_rates(&corpus, baseline, tolerance);
+
+    free(baseline);
+    for (size_t i = 0; i < corpus.count; i++) {
+        free(corpus.cases[i].data);
+    }
+    free(corpus.cases);
+    return (regressions > 0) ? 2 : 0;
+}
+
+#endif // PAKIT_FUZZ_LIBFUZZER
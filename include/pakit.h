@@ -1,9 +1,19 @@
 #ifndef pakit_H
 #define pakit_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifdef PAKIT_ENABLE_STATS
+#include <stdatomic.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+#define PAKIT_HAVE_IOVEC 1
+#endif
+
 #define PACKET_SOP_SIZE 2
 #define PACKET_TYPE_SIZE 2
 #define PACKET_COUNT_SIZE 2
@@ -15,7 +25,10 @@ typedef enum {
     PAKIT_STATUS_ERROR_INVALID_SOP, // Error: Invalid unique identifier
     PAKIT_STATUS_ERROR_SIZE_LARGE, // Error: Payload size too large
     PAKIT_STATUS_ERROR_OVERFLOW,   // Error: Buffer overflow
-    PAKIT_STATUS_ERROR_NULL_PARAM  // Error: NULL parameter provided
+    PAKIT_STATUS_ERROR_NULL_PARAM, // Error: NULL parameter provided
+    PAKIT_STATUS_ERROR_NO_MEMORY,  // Error: Payload storage could not be allocated
+    PAKIT_STATUS_ERROR_IO,         // Error: File or device I/O failed
+    PAKIT_STATUS_ERROR_CRC         // Error: CRC trailer does not match the packet
 } PakitStatus;
 
 typedef struct {
@@ -26,6 +39,15 @@ typedef struct {
     uint8_t *payload;
 } Packet;
 
+// Read-only view of a received packet. The payload points either straight into
+// the caller's input buffer or into the receiver's payload storage.
+typedef struct {
+    uint16_t type;
+    uint16_t count;
+    uint16_t size;
+    const uint8_t *payload;
+} PakitView;
+
 // Define states for the packet receiver state machine
 typedef enum {
     STATE_UNIQUE_SOP,
@@ -33,15 +55,19 @@ typedef enum {
     STATE_COUNT,
     STATE_SIZE,
     STATE_PAYLOAD,
+    STATE_CRC,
+    STATE_SKIP,                   // Stepping over a packet rejected by the type filter
     STATE_COMPLETE
 } ReceiverState;
 
 #define HEADER_SIZE (PACKET_SOP_SIZE + PACKET_TYPE_SIZE + PACKET_COUNT_SIZE + PACKET_SIZE_SIZE)
-#define MAX_PACKET_SIZE (255 + HEADER_SIZE)
+#define MAX_PACKET_SIZE (255 + HEADER_SIZE)   // Default payload capacity of a receiver
+#define PAKIT_MAX_PAYLOAD_LIMIT 0xFFFF         // Largest payload the size field can describe
 #define EXPECTED_SOP_0 0xB0
 #define EXPECTED_SOP_1 0xB2
+#define PAKIT_CRC_SIZE 4                       // Optional CRC32C trailer, MSB first
 
-// Header structure that overlays the beginning of the packet buffer
+// Header structure as it appears on the wire
 typedef struct {
     uint8_t sop[PACKET_SOP_SIZE];
     uint8_t type[PACKET_TYPE_SIZE];
@@ -49,38 +75,121 @@ typedef struct {
     uint8_t size_bytes[PACKET_SIZE_SIZE];  // Raw size bytes to handle endianness
 } PacketHeader;
 
-// Union to access packet data either as a byte buffer or structured fields
-typedef union {
-    struct {
-        PacketHeader header;
-        uint8_t payload[MAX_PACKET_SIZE];
-    } fields;
-    uint8_t buffer[HEADER_SIZE + MAX_PACKET_SIZE];
-} PacketBuffer;
+// Snapshot of a receiver's instrumentation counters (see pakit_get_stats)
+typedef struct {
+    uint64_t bytes_in;            // Bytes fed to the receiver
+    uint64_t packets_out;         // Packets delivered
+    uint64_t dropped_invalid_sop; // Bytes discarded while hunting for a SOP
+    uint64_t dropped_size_large;  // Bytes discarded with an oversized header
+    uint64_t dropped_overflow;    // Bytes refused because the storage was full
+    uint64_t dropped_crc;         // Bytes of packets failing their CRC check
+    uint64_t filtered;            // Bytes of packets skipped by the type filter
+    uint64_t resyncs;             // Errors after which the receiver resynchronized
+    uint64_t max_complete_ns;     // Longest time from a packet's first byte to its completion
+} PakitStats;
+
+#ifdef PAKIT_ENABLE_STATS
+// Live counters; written by the receiving thread only, readable from any thread
+typedef struct {
+    _Atomic uint64_t bytes_in;
+    _Atomic uint64_t packets_out;
+    _Atomic uint64_t dropped_invalid_sop;
+    _Atomic uint64_t dropped_size_large;
+    _Atomic uint64_t dropped_overflow;
+    _Atomic uint64_t dropped_crc;
+    _Atomic uint64_t filtered;
+    _Atomic uint64_t resyncs;
+    _Atomic uint64_t max_complete_ns;
+    uint64_t packet_start_ns;     // When the first byte of the buffered packet arrived
+} PakitStatsCounters;
+#endif
 
+// PAKIT_MINIMAL builds the smallest receiver, for microcontrollers: the state
+// takes one byte and the optional attachments below are compiled out, along
+// with the modules using them (only the core decoder, CRC and pakit_ring.h
+// remain). Give pakit_create storage of exactly the largest payload expected.
 typedef struct {
-    PacketBuffer packet;
+    PacketHeader header;
+    uint8_t *payload;             // Payload storage, max_payload_size bytes
     size_t received_bytes;
-    bool header_complete;
-    ReceiverState state;
+    uint16_t max_payload_size;    // Largest payload this receiver accepts
     uint16_t expected_payload_size;
+    uint32_t crc;                 // CRC of the header and payload bytes received so far
+    uint32_t crc_trailer;         // Trailer bytes received so far
+#ifdef PAKIT_MINIMAL
+    uint8_t state;                // A ReceiverState
+#else
+    ReceiverState state;
+#endif
+    bool owns_storage;            // Storage was allocated by pakit_create
+    bool crc_enabled;             // Packets carry a CRC32C trailer
+#ifndef PAKIT_MINIMAL
+    struct PakitSequenceTracker *sequence;  // Optional sequence tracking, see pakit_sequence.h
+    struct PakitDispatchTable *handlers;    // Per-type handlers, see pakit_dispatch.h
+    struct PakitStream *stream;             // Optional streaming delivery, see pakit_stream.h
+    struct PakitPacket *pooled;             // Pooled slot holding payload, see pakit_packet_pool.h
+    struct PakitTiming *timing;             // Optional latency measurement, see pakit_timing.h
+    struct PakitTypeFilter *filter;         // Types to deliver, see pakit_filter.h
+#endif
+#ifdef PAKIT_ENABLE_STATS
+    PakitStatsCounters stats;
+#endif
 } PakitReceiver;
 
-// Initializes a packet receiver instance
+// Initializes a packet receiver instance with its payload storage
 // Parameters:
 //   receiver - Pointer to the PakitReceiver to initialize
-void pakit_create(PakitReceiver* receiver);
+//   storage - Caller-owned payload storage of storage_size bytes, or NULL to have
+//             storage_size bytes allocated (MAX_PACKET_SIZE when storage_size is 0)
+//   storage_size - Largest payload the receiver accepts, capped at PAKIT_MAX_PAYLOAD_LIMIT
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The receiver is ready
+//   PAKIT_STATUS_ERROR_NULL_PARAM - receiver is NULL
+//   PAKIT_STATUS_ERROR_NO_MEMORY - Storage could not be allocated
+PakitStatus pakit_create(PakitReceiver* receiver, uint8_t* storage, size_t storage_size);
 
 // Releases resources associated with a packet receiver
+// Storage allocated by pakit_create and the handler table are freed and a
+// pooled slot is returned; caller-owned storage is left alone
 // Parameters:
 //   receiver - Pointer to the PakitReceiver to be destroyed
 void pakit_destroy(PakitReceiver* receiver);
 
 // Initializes or resets a packet receiver to its initial state
+// Only the parse state is reset; bytes of the previous packet stay in the buffer
 // Parameters:
 //   receiver - Pointer to the PakitReceiver to initialize
 void pakit_init(PakitReceiver* receiver);
 
+// Resets a packet receiver and scrubs its header and payload storage
+// Use this when previously received data must not linger in memory
+// Parameters:
+//   receiver - Pointer to the PakitReceiver to clear
+void pakit_clear(PakitReceiver* receiver);
+
+// Reads the instrumentation counters of a receiver
+// The counters are only kept when the library is built with PAKIT_ENABLE_STATS;
+// this may be called from another thread while the receiver is in use
+// Parameters:
+//   receiver - Pointer to the PakitReceiver
+//   stats - Receives the counters (all zero when stats are compiled out)
+// Returns:
+//   true if stats are compiled in, false otherwise
+bool pakit_get_stats(const PakitReceiver* receiver, PakitStats* stats);
+
+// Resets the instrumentation counters of a receiver
+void pakit_reset_stats(PakitReceiver* receiver);
+
+// Enables or disables the CRC trailer mode of a receiver
+// In CRC mode every packet is followed by PAKIT_CRC_SIZE bytes holding the
+// CRC32C of its header and payload (see pakit_encode_crc). The CRC is updated
+// as bytes arrive and checked when the trailer is complete; a mismatch drops
+// the packet with PAKIT_STATUS_ERROR_CRC.
+// Parameters:
+//   receiver - Pointer to the PakitReceiver
+//   enabled - true to expect CRC trailers
+void pakit_set_crc(PakitReceiver* receiver, bool enabled);
+
 // Processes a single byte of incoming data
 // Parameters:
 //   receiver - Pointer to the PakitReceiver
@@ -102,11 +211,60 @@ PakitStatus pakit_receive_byte(PakitReceiver* receiver, uint8_t byte);
 //   PAKIT_STATUS_SUCCESS - A complete packet has been received
 //   PAKIT_STATUS_IN_PROGRESS - More bytes needed to complete the packet
 //   PAKIT_STATUS_ERROR_* - An error occurred during processing
+// Notes:
+//   When no packet is in progress and the bytes at position do not start a SOP,
+//   everything up to the next candidate SOP is discarded in one step and reported
+//   as a single PAKIT_STATUS_ERROR_INVALID_SOP.
 PakitStatus pakit_receive_buffer(PakitReceiver* receiver,
                                 const uint8_t* buffer,
                                 size_t buffer_length,
                                 size_t* position);
 
+// Returns the next packet in the buffer as a view, without copying it when possible
+// Parameters:
+//   receiver - Pointer to the PakitReceiver used for packets that span two reads
+//   buffer - Pointer to the buffer containing bytes to process
+//   buffer_length - Number of bytes in the buffer
+//   position - Pointer to position variable: input is starting position, output is ending position
+//              Can be NULL, in which case processing starts at position 0
+//   view - Pointer to a PakitView that receives the packet on success
+// Returns:
+//   PAKIT_STATUS_SUCCESS - A complete packet is available in view
+//   PAKIT_STATUS_IN_PROGRESS - The remaining bytes were buffered, more data needed
+//   PAKIT_STATUS_ERROR_* - An error occurred during processing
+// Notes:
+//   When the receiver holds no partial packet and the whole packet lies inside
+//   buffer, view->payload points into buffer and the receiver is left untouched.
+//   Otherwise the bytes go through pakit_receive_buffer and view->payload points
+//   into the receiver's storage, valid until the next call that feeds it.
+PakitStatus pakit_next_view(PakitReceiver* receiver,
+                            const uint8_t* buffer,
+                            size_t buffer_length,
+                            size_t* position,
+                            PakitView* view);
+
+// Decodes as many complete packets from the buffer as fit in the views array
+// Parameters:
+//   receiver - Pointer to the PakitReceiver used for packets that span two reads
+//   buffer - Pointer to the buffer containing bytes to process
+//   buffer_length - Number of bytes in the buffer
+//   views - Array receiving one PakitView per decoded packet
+//   max_views - Number of entries available in views
+//   consumed - Receives the number of buffer bytes processed (can be NULL)
+// Returns:
+//   The number of packets written to views
+// Notes:
+//   Invalid bytes are skipped the same way pakit_receive_buffer discards them.
+//   Only views[0] can point into the receiver (a packet completed from an earlier
+//   read); in that case the batch stops before overwriting it, leaving the rest
+//   unconsumed. All views stay valid until the next call that feeds the receiver.
+size_t pakit_receive_batch(PakitReceiver* receiver,
+                           const uint8_t* buffer,
+                           size_t buffer_length,
+                           PakitView* views,
+                           size_t max_views,
+                           size_t* consumed);
+
 // Checks if a complete packet has been received and copies it to the provided structure
 // Parameters:
 //   receiver - Pointer to the PakitReceiver
@@ -116,6 +274,15 @@ PakitStatus pakit_receive_buffer(PakitReceiver* receiver,
 //   false - No complete packet is available
 bool pakit_is_packet_complete(PakitReceiver* receiver, Packet* packet);
 
+// Finds the next candidate start of packet in a buffer
+// Parameters:
+//   buffer - Pointer to the bytes to scan
+//   buffer_length - Number of bytes in the buffer
+// Returns:
+//   Offset of the first EXPECTED_SOP_0 followed by EXPECTED_SOP_1, or of a trailing
+//   EXPECTED_SOP_0 in the last byte; buffer_length if there is none
+size_t pakit_find_sop(const uint8_t* buffer, size_t buffer_length);
+
 // Creates and initializes a packet structure with the provided values
 // Parameters:
 //   packet - Pointer to the Packet structure to initialize
@@ -128,4 +295,62 @@ bool pakit_is_packet_complete(PakitReceiver* receiver, Packet* packet);
 bool pakit_packet_create(Packet* packet, uint16_t packet_type,
                        uint16_t count, const uint8_t* payload, uint16_t payload_size);
 
+
+// Serializes the header of a packet into wire format
+// Parameters:
+//   header - Output buffer of HEADER_SIZE bytes
+//   packet - Pointer to the Packet to encode (see pakit_packet_create)
+// Returns:
+//   true if the header was written, false if parameters were invalid
+bool pakit_encode_header(uint8_t header[HEADER_SIZE], const Packet* packet);
+
+// Serializes a burst of packets back to back into one contiguous buffer
+// Parameters:
+//   packets - Array of packets to encode
+//   packet_count - Number of packets in the array
+//   buffer - Output buffer
+//   buffer_size - Size of the output buffer in bytes
+//   written - Receives the number of bytes written (can be NULL)
+//   sequence - Running sequence number (can be NULL). When provided, each packet
+//              is sent with count = *sequence, which is then incremented; when
+//              NULL, each packet's own count is used
+// Returns:
+//   Number of packets encoded. Encoding stops at the first packet that is
+//   invalid or does not fit in the remaining buffer space
+size_t pakit_encode_batch(const Packet* packets, size_t packet_count,
+                          uint8_t* buffer, size_t buffer_size,
+                          size_t* written, uint16_t* sequence);
+
+// Computes or continues a CRC32C (Castagnoli) checksum
+// Parameters:
+//   crc - 0 to start, or the result of a previous call to continue it
+//   data - Pointer to the bytes to add
+//   length - Number of bytes
+// Returns:
+//   The updated CRC
+uint32_t pakit_crc32c(uint32_t crc, const uint8_t* data, size_t length);
+
+// Serializes a packet followed by its CRC32C trailer
+// Parameters:
+//   packet - Pointer to the Packet to encode
+//   buffer - Output buffer
+//   buffer_size - Size of the output buffer in bytes
+// Returns:
+//   Number of bytes written (HEADER_SIZE + size + PAKIT_CRC_SIZE), 0 if
+//   parameters were invalid or the packet does not fit
+size_t pakit_encode_crc(const Packet* packet, uint8_t* buffer, size_t buffer_size);
+
+#ifdef PAKIT_HAVE_IOVEC
+// Describes a packet on the wire as header and payload segments for writev/sendmsg
+// The payload is referenced, not copied
+// Parameters:
+//   packet - Pointer to the Packet to encode
+//   header - Storage for the encoded header, must outlive the write
+//   iov - Output array of two iovec entries
+// Returns:
+//   Number of iovec entries used (1 for an empty payload, 2 otherwise),
+//   0 if parameters were invalid
+int pakit_encode_iov(const Packet* packet, uint8_t header[HEADER_SIZE], struct iovec iov[2]);
+#endif
+
 #endif // pakit_H
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef pakit_demux_H
+#define pakit_demux_H
+
+#include <stddef.h>
+#include "pakit.h"
+#include "pakit_dispatch.h"
+#include "pakit_filter.h"
+#include "pakit_packet_pool.h"
+#include "pakit_queue.h"
+#include "pakit_sequence.h"
+
+// Demultiplexing of logical streams interleaved on one link. Each packet type
+// is a stream with its own sink, either a packet queue (pakit_queue.h) drained
+// by worker threads or a callback, its own count sequence and its own policy
+// for a full sink, so one slow stream can shed load without touching the others.
+// Streams live on caller storage and are found through a two-level table
+// indexed by the high and low type byte, as in pakit_dispatch.h: routing a
+// packet is two loads, with no hashing.
+//
+// Payloads are copied at most once. Callback streams see packets in place when
+// they lie inside the read. Queue streams get the receiver's pooled slot when
+// the packet spanned reads (attach the receiver to a pool with
+// pakit_attach_packet_pool), and a single copy into the demux pool otherwise.
+// A wait stream only waits for slots consumers can give back: the receiver's
+// pool has at least two slots (one-slot pools are refused on attach), and a
+// packet to copy without a demux pool is dropped.
+
+typedef enum {
+    PAKIT_DEMUX_WAIT,            // Yield until the sink has room, pushing back on the reader
+    PAKIT_DEMUX_DROP             // Drop the packet and count it
+} PakitDemuxPolicy;
+
+typedef struct {
+    uint64_t packets;            // Packets handed to the sink
+    uint64_t dropped;            // Packets dropped: sink full, or no pool slot free
+} PakitDemuxStats;
+
+typedef struct PakitDemuxStream {
+    uint16_t type;
+    PakitQueue *queue;                // Queue sink, or NULL for a callback sink
+    PakitTypeHandler handler;         // Callback sink; returning false pauses the input
+    void *context;
+    PakitDemuxPolicy policy;          // Queue sinks only
+    PakitSequenceTracker sequence;    // This stream's count sequence
+    PakitSequenceEntry sequence_entry;
+    PakitDemuxStats stats;
+} PakitDemuxStream;
+
+typedef struct {
+    PakitDemuxStream **pages[256];    // Indexed by the high type byte, NULL if unused
+    PakitPacketPool *pool;            // Slots for queued packets decoded in place
+    PakitTypeFilter *filter;          // Kept in step with the streams, see pakit_demux_set_filter
+    uint64_t unrouted;                // Packets of types without a stream
+} PakitDemux;
+
+// Initializes an empty demux
+// Parameters:
+//   demux - Pointer to the PakitDemux to initialize
+//   pool - Pool queued packets are copied into when decoded in place; can be
+//          NULL without queue streams
+void pakit_demux_init(PakitDemux* demux, PakitPacketPool* pool);
+
+// Frees the routing table; the streams themselves are caller storage
+void pakit_demux_destroy(PakitDemux* demux);
+
+// Routes a type to a queue
+// Parameters:
+//   demux - Pointer to the PakitDemux
+//   stream - Caller storage for the stream, valid while registered
+//   type - Packet type carried by the stream
+//   queue - Queue receiving the stream's packets; consumers release them
+//   policy - What to do when the queue is full or no pool slot is free
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The stream is registered, replacing any previous one
+//   PAKIT_STATUS_ERROR_NULL_PARAM - demux, stream or queue is NULL
+//   PAKIT_STATUS_ERROR_NO_MEMORY - The routing table could not be allocated
+PakitStatus pakit_demux_add_queue(PakitDemux* demux, PakitDemuxStream* stream, uint16_t type,
+                                  PakitQueue* queue, PakitDemuxPolicy policy);
+
+// Routes a type to a callback; returns as for pakit_demux_add_queue
+// The handler sees the view in place or in the receiver's storage, valid only
+// during the call. Returning false ends pakit_demux_receive after that packet,
+// leaving the rest of the read for the next call.
+PakitStatus pakit_demux_add_callback(PakitDemux* demux, PakitDemuxStream* stream, uint16_t type,
+                                     PakitTypeHandler handler, void* context);
+
+// Removes the stream of a type, if any
+void pakit_demux_remove(PakitDemux* demux, uint16_t type);
+
+// Stream a type is routed to, or NULL
+static inline PakitDemuxStream* pakit_demux_find(const PakitDemux* demux, uint16_t type) {
+    PakitDemuxStream* const* page = demux->pages[type >> 8];
+    return (page != NULL) ? page[type & 0xFF] : NULL;
+}
+
+// Keeps filter accepting exactly the routed types, from now on, so a receiver
+// with the same filter attached (pakit_set_filter) skips the payloads of
+// unrouted packets without copying them. NULL stops updating it.
+void pakit_demux_set_filter(PakitDemux* demux, PakitTypeFilter* filter);
+
+// Decodes a buffer and routes every packet to its stream
+// Parameters:
+//   demux - Pointer to the PakitDemux
+//   receiver - Receiver used for packets that span two reads
+//   buffer - Pointer to the buffer containing bytes to process
+//   buffer_length - Number of bytes in the buffer
+//   consumed - Receives the number of buffer bytes processed (can be NULL)
+// Returns:
+//   Number of packets handed to a sink
+// Notes:
+//   Invalid bytes are skipped and packets without a stream are counted in
+//   demux->unrouted. Processing ends at the end of buffer or after a callback
+//   returns false.
+size_t pakit_demux_receive(PakitDemux* demux, PakitReceiver* receiver, const uint8_t* buffer,
+                           size_t buffer_length, size_t* consumed);
+
+#endif // pakit_demux_H
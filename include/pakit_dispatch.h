@@ -0,0 +1,63 @@
+#ifndef pakit_dispatch_H
+#define pakit_dispatch_H
+
+#include <stddef.h>
+#include "pakit.h"
+
+// Callback delivery keyed by packet type. Handlers are kept in a two-level
+// table indexed by the high and low type byte; second-level pages of 256
+// handlers are only allocated for the high bytes that are actually used, so a
+// lookup is two loads without the 1 MiB of a flat 65536-entry table.
+
+// Called for each packet of a registered type
+// Parameters:
+//   context - User context given at registration
+//   view - The packet; view->payload is valid only during the call
+// Returns:
+//   true to continue dispatching, false to stop after this packet
+typedef bool (*PakitTypeHandler)(void* context, const PakitView* view);
+
+typedef struct {
+    PakitTypeHandler handler;
+    void *context;
+} PakitHandlerEntry;
+
+typedef struct PakitDispatchTable {
+    PakitHandlerEntry *pages[256];  // Indexed by the high type byte, NULL if unused
+    PakitHandlerEntry unhandled;    // Called for types without a handler
+} PakitDispatchTable;
+
+// Registers the handler for a packet type, replacing any previous one
+// Parameters:
+//   receiver - Pointer to the PakitReceiver
+//   type - Packet type to handle
+//   handler - Function to call, or NULL to remove the registration
+//   context - User context passed to handler
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The handler is registered
+//   PAKIT_STATUS_ERROR_NULL_PARAM - receiver is NULL
+//   PAKIT_STATUS_ERROR_NO_MEMORY - The handler table could not be allocated
+PakitStatus pakit_on_type(PakitReceiver* receiver, uint16_t type,
+                          PakitTypeHandler handler, void* context);
+
+// Registers the handler for packets of types without their own handler
+// Parameters and returns as for pakit_on_type
+PakitStatus pakit_on_unhandled(PakitReceiver* receiver, PakitTypeHandler handler, void* context);
+
+// Decodes a buffer and hands every packet to the handler of its type
+// Parameters:
+//   receiver - Pointer to the PakitReceiver used for packets that span two reads
+//   buffer - Pointer to the buffer containing bytes to process
+//   buffer_length - Number of bytes in the buffer
+//   consumed - Receives the number of buffer bytes processed (can be NULL)
+// Returns:
+//   Number of packets handed to a handler
+// Notes:
+//   Packets are decoded as with pakit_next_view: in place when they lie inside
+//   buffer, from the receiver's storage when they span reads. Invalid bytes are
+//   skipped. Packets without any handler are dropped. Processing ends at the
+//   end of buffer or after a handler returns false.
+size_t pakit_receive_dispatch(PakitReceiver* receiver, const uint8_t* buffer,
+                              size_t buffer_length, size_t* consumed);
+
+#endif // pakit_dispatch_H
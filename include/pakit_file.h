@@ -0,0 +1,103 @@
+#ifndef pakit_file_H
+#define pakit_file_H
+
+#include <stddef.h>
+#include "pakit.h"
+#include "pakit_parallel.h"
+
+// Capture files: a plain concatenation of encoded packets.
+// The reader maps the file and iterates packets as zero-copy views over the
+// mapping; the writer encodes packets into a large aligned buffer and writes it
+// out in big blocks, optionally bypassing the page cache with O_DIRECT.
+
+typedef struct {
+    int fd;
+    const uint8_t *data;         // Mapping of the whole file (NULL when empty)
+    size_t length;
+    size_t position;             // Offset of the next packet to decode
+    uint16_t max_payload_size;
+} PakitFileReader;
+
+#define PAKIT_FILE_DIRECT 0x1                    // Writer flag: use O_DIRECT where supported
+#define PAKIT_FILE_BUFFER_SIZE (1024 * 1024)     // Default writer buffer size
+#define PAKIT_FILE_BLOCK_SIZE 4096               // O_DIRECT alignment
+
+typedef struct {
+    int fd;
+    uint8_t *buffer;             // PAKIT_FILE_BLOCK_SIZE aligned
+    size_t capacity;
+    size_t used;
+    bool direct;                 // fd was opened with O_DIRECT
+} PakitFileWriter;
+
+// Opens and maps a capture file for reading
+// Parameters:
+//   reader - Pointer to the PakitFileReader to initialize
+//   path - Path of the capture file
+//   max_payload_size - Largest payload accepted, 0 for MAX_PACKET_SIZE
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The file is mapped
+//   PAKIT_STATUS_ERROR_NULL_PARAM - reader or path is NULL
+//   PAKIT_STATUS_ERROR_IO - The file could not be opened or mapped
+PakitStatus pakit_file_open(PakitFileReader* reader, const char* path, uint16_t max_payload_size);
+
+// Unmaps and closes a capture file
+void pakit_file_close(PakitFileReader* reader);
+
+// Returns the next packet of the file as a view into the mapping
+// Invalid bytes are skipped the same way pakit_receive_buffer discards them
+// Parameters:
+//   reader - Pointer to the PakitFileReader
+//   view - Receives the packet; view->payload stays valid until pakit_file_close
+//   offset - Receives the file offset of the packet's SOP (can be NULL)
+// Returns:
+//   true if a packet was returned, false at the end of the file
+bool pakit_file_next(PakitFileReader* reader, PakitView* view, size_t* offset);
+
+// Decodes the whole file with pakit_decode_parallel
+// Parameters:
+//   reader - Pointer to the PakitFileReader
+//   options - Decoder options (can be NULL); max_payload_size defaults to the reader's
+//   callback - Function receiving each packet in order
+//   context - User context passed to callback
+// Returns:
+//   Number of packets delivered to callback
+size_t pakit_file_decode_parallel(const PakitFileReader* reader,
+                                  const PakitParallelOptions* options,
+                                  PakitPacketCallback callback, void* context);
+
+// Creates (or truncates) a capture file for writing
+// Parameters:
+//   writer - Pointer to the PakitFileWriter to initialize
+//   path - Path of the capture file
+//   flags - PAKIT_FILE_DIRECT or 0; O_DIRECT is dropped if the file system refuses it
+//   buffer_size - Size of the write buffer, 0 for PAKIT_FILE_BUFFER_SIZE. It is
+//                 raised if needed to hold the largest possible packet
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The file is ready
+//   PAKIT_STATUS_ERROR_NULL_PARAM - writer or path is NULL
+//   PAKIT_STATUS_ERROR_NO_MEMORY - The buffer could not be allocated
+//   PAKIT_STATUS_ERROR_IO - The file could not be created
+PakitStatus pakit_file_create(PakitFileWriter* writer, const char* path,
+                              unsigned flags, size_t buffer_size);
+
+// Encodes packets and appends them to the file
+// Parameters:
+//   writer - Pointer to the PakitFileWriter
+//   packets - Array of packets to append
+//   packet_count - Number of packets in the array
+//   sequence - Running sequence number as for pakit_encode_batch (can be NULL)
+// Returns:
+//   PAKIT_STATUS_SUCCESS - All packets were appended
+//   PAKIT_STATUS_ERROR_NULL_PARAM - A parameter or packet was invalid
+//   PAKIT_STATUS_ERROR_IO - Writing to the file failed
+PakitStatus pakit_file_write(PakitFileWriter* writer, const Packet* packets,
+                             size_t packet_count, uint16_t* sequence);
+
+// Writes out all buffered packets and closes the file
+// Returns:
+//   PAKIT_STATUS_SUCCESS - Everything reached the file
+//   PAKIT_STATUS_ERROR_IO - Writing or closing failed
+PakitStatus pakit_file_finish(PakitFileWriter* writer);
+
+#endif // pakit_file_H
@@ -0,0 +1,38 @@
+#ifndef pakit_filter_H
+#define pakit_filter_H
+
+#include <stdint.h>
+#include "pakit.h"
+
+// Filtering by packet type before the payload is touched. A receiver with a
+// filter attached looks at the type once the header is complete; packets of
+// types the filter rejects are stepped over, payload and CRC trailer alike,
+// with no copy, no CRC check and no delivery. The filter is a bitmap with one
+// bit per type, so the check is a single load whatever the number of types.
+
+#define PAKIT_FILTER_WORDS (65536 / 64)
+
+typedef struct PakitTypeFilter {
+    uint64_t accepted[PAKIT_FILTER_WORDS];  // Bit set for each type delivered
+} PakitTypeFilter;
+
+// Initializes a filter
+// Parameters:
+//   filter - Pointer to the PakitTypeFilter to initialize
+//   accept_all - true to start with every type accepted, false with none
+void pakit_filter_init(PakitTypeFilter* filter, bool accept_all);
+
+// Accepts or rejects the types first to last, inclusive
+void pakit_filter_set(PakitTypeFilter* filter, uint16_t first, uint16_t last, bool accepted);
+
+// True when packets of type pass the filter
+static inline bool pakit_filter_accepts(const PakitTypeFilter* filter, uint16_t type) {
+    return (filter->accepted[type >> 6] >> (type & 63)) & 1;
+}
+
+// Attaches a filter to a receiver, or removes it when filter is NULL
+// A partially received packet is dropped. The filter may be changed while
+// attached; the change applies from the next packet header.
+void pakit_set_filter(PakitReceiver* receiver, PakitTypeFilter* filter);
+
+#endif // pakit_filter_H
@@ -0,0 +1,121 @@
+#ifndef pakit_index_H
+#define pakit_index_H
+
+#include <stddef.h>
+#include "pakit.h"
+#include "pakit_file.h"
+#include "pakit_parallel.h"
+
+// Sidecar index of a capture file: one fixed-size record per packet, so any
+// packet can be reached without re-parsing the capture from byte 0.
+// The index file is, in host byte order:
+//   PakitIndexFileHeader
+//   entry_count PakitIndexEntry records, in file order
+//   type_count PakitIndexTypeList records, sorted by type
+//   entry_count uint64_t ordinals: the posting list of each type, ascending
+//   entry_count PakitIndexCountKey records, sorted by count then ordinal
+// The last three let lookups by type and by sequence number binary search.
+
+#define PAKIT_INDEX_MAGIC "PKIX"
+#define PAKIT_INDEX_VERSION 2u
+#define PAKIT_INDEX_NOT_FOUND ((size_t)-1)
+
+typedef struct {
+    char magic[4];               // PAKIT_INDEX_MAGIC
+    uint32_t version;            // PAKIT_INDEX_VERSION, also detects a byte order mismatch
+    uint64_t entry_count;
+    uint64_t source_size;        // Size of the indexed capture file
+    uint64_t type_count;         // Distinct packet types
+} PakitIndexFileHeader;
+
+typedef struct {
+    uint64_t offset;             // File offset of the packet's SOP
+    uint16_t type;
+    uint16_t count;
+    uint16_t size;
+    uint16_t reserved;
+} PakitIndexEntry;
+
+typedef struct {
+    uint16_t type;
+    uint16_t reserved[3];
+    uint64_t first;              // Position of the type's posting list among the ordinals
+    uint64_t length;             // Packets of the type
+} PakitIndexTypeList;
+
+typedef struct {
+    uint64_t ordinal;
+    uint16_t count;
+    uint16_t reserved[3];
+} PakitIndexCountKey;
+
+typedef struct {
+    int fd;
+    void *mapping;
+    size_t mapping_length;
+    const PakitIndexEntry *entries;
+    size_t entry_count;
+    uint64_t source_size;
+    const PakitIndexTypeList *types;
+    size_t type_count;
+    const uint64_t *type_ordinals;
+    const PakitIndexCountKey *counts;
+} PakitIndex;
+
+// Decodes a capture and writes its index file
+// Parameters:
+//   reader - Open capture file to index
+//   path - Path of the index file to create
+//   options - Decoder options (can be NULL); thread_count 1 builds in a single pass
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The index was written
+//   PAKIT_STATUS_ERROR_NULL_PARAM - reader or path is NULL
+//   PAKIT_STATUS_ERROR_IO - The index file could not be written
+PakitStatus pakit_index_build(const PakitFileReader* reader, const char* path,
+                              const PakitParallelOptions* options);
+
+// Opens and maps an index file
+// Parameters:
+//   index - Pointer to the PakitIndex to initialize
+//   path - Path of the index file
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The index is mapped
+//   PAKIT_STATUS_ERROR_NULL_PARAM - index or path is NULL
+//   PAKIT_STATUS_ERROR_IO - The file could not be read or is not a valid index
+PakitStatus pakit_index_open(PakitIndex* index, const char* path);
+
+// Unmaps and closes an index file
+void pakit_index_close(PakitIndex* index);
+
+// Returns the entry of the packet with the given ordinal, or NULL if out of range
+const PakitIndexEntry* pakit_index_get(const PakitIndex* index, size_t ordinal);
+
+// Finds the first packet whose SOP is at or after a file offset (binary search)
+// Returns:
+//   Ordinal of the packet, or PAKIT_INDEX_NOT_FOUND
+size_t pakit_index_find_offset(const PakitIndex* index, uint64_t offset);
+
+// Finds the first packet at or after ordinal from with the given sequence number
+// (binary search)
+// Returns:
+//   Ordinal of the packet, or PAKIT_INDEX_NOT_FOUND
+size_t pakit_index_find_count(const PakitIndex* index, uint16_t count, size_t from);
+
+// Finds the first packet at or after ordinal from with the given type (binary search)
+// Returns:
+//   Ordinal of the packet, or PAKIT_INDEX_NOT_FOUND
+size_t pakit_index_find_type(const PakitIndex* index, uint16_t type, size_t from);
+
+// Returns a packet of the indexed capture as a view into the reader's mapping
+// Parameters:
+//   index - The index of the capture
+//   reader - The capture file the index was built from
+//   ordinal - Ordinal of the packet
+//   view - Receives the packet
+// Returns:
+//   true on success, false if ordinal is out of range or the index does not match the
+//   file, including when the bytes at the entry's offset are not its packet header
+bool pakit_index_view(const PakitIndex* index, const PakitFileReader* reader,
+                      size_t ordinal, PakitView* view);
+
+#endif // pakit_index_H
@@ -0,0 +1,114 @@
+#ifndef pakit_io_H
+#define pakit_io_H
+
+#include <stddef.h>
+#include "pakit.h"
+
+// Event loop integration for file descriptors (Linux only).
+// Receivers are attached to descriptors; pakit_io_poll waits for data, reads it
+// and hands the packets of each read to the channel's callback as one batch.
+// The epoll backend reads readable descriptors into one shared buffer. The
+// io_uring backend keeps a read armed on every descriptor (multishot recv for
+// sockets) that lands in a ring of registered, provided buffers, so the kernel
+// fills parse-ready buffers without a read syscall per descriptor.
+#if defined(__linux__)
+#define PAKIT_HAVE_IO 1
+
+typedef enum {
+    PAKIT_IO_EPOLL,
+    PAKIT_IO_URING
+} PakitIoBackend;
+
+// Called with the packets decoded from one read
+// Parameters:
+//   context - User context given to pakit_io_attach
+//   channel - Channel the packets arrived on
+//   views - The packets, valid only during the call
+//   count - Number of packets. 0 (with views NULL) reports that the peer closed
+//           the descriptor or reading failed; the channel is detached afterwards
+typedef void (*PakitIoCallback)(void* context, size_t channel, const PakitView* views, size_t count);
+
+typedef struct {
+    int fd;
+    PakitReceiver *receiver;
+    PakitIoCallback callback;
+    void *context;
+    bool attached;
+    bool socket;                 // fd is a socket (multishot recv with io_uring)
+    bool armed;                  // A read is queued in the kernel (io_uring)
+    bool rearm;                  // The read waits for a free SQE; pakit_io_poll retries (io_uring)
+    uint32_t generation;         // Tells completions of an earlier use of the slot apart
+} PakitIoChannel;
+
+typedef struct {
+    PakitIoBackend backend;
+    int fd;                      // epoll or io_uring descriptor
+    PakitIoChannel *channels;
+    size_t channel_count;
+    uint8_t *buffers;            // One buffer (epoll) or PAKIT_IO_URING_BUFFERS (io_uring)
+    size_t buffer_size;
+    struct PakitUring *uring;    // io_uring rings, NULL with epoll
+} PakitIoLoop;
+
+#define PAKIT_IO_BUFFER_SIZE 16384   // Default read size
+#define PAKIT_IO_URING_BUFFERS 256   // Provided buffers shared by all io_uring reads
+#define PAKIT_IO_MAX_VIEWS 64        // Largest batch handed to a callback
+
+// Creates an event loop
+// Parameters:
+//   loop - Pointer to the PakitIoLoop to initialize
+//   backend - PAKIT_IO_EPOLL or PAKIT_IO_URING
+//   channel_count - Largest number of descriptors attached at once
+//   buffer_size - Bytes per read, 0 for PAKIT_IO_BUFFER_SIZE
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The loop is ready
+//   PAKIT_STATUS_ERROR_NULL_PARAM - loop is NULL
+//   PAKIT_STATUS_ERROR_NO_MEMORY - Channels or buffers could not be allocated
+//   PAKIT_STATUS_ERROR_IO - The backend is not available on this kernel
+PakitStatus pakit_io_create(PakitIoLoop* loop, PakitIoBackend backend,
+                            size_t channel_count, size_t buffer_size);
+
+// Destroys an event loop; attached descriptors are left open
+void pakit_io_destroy(PakitIoLoop* loop);
+
+// Attaches a descriptor and the receiver that decodes its bytes
+// With epoll the descriptor must be non-blocking
+// Parameters:
+//   loop - Pointer to the PakitIoLoop
+//   fd - Descriptor to read from
+//   receiver - Receiver for the descriptor's byte stream
+//   callback - Function receiving decoded packets
+//   context - User context passed to callback
+//   channel - Receives the channel number (can be NULL)
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The descriptor is being read
+//   PAKIT_STATUS_ERROR_NULL_PARAM - A parameter is invalid
+//   PAKIT_STATUS_ERROR_NO_MEMORY - All channels are in use
+//   PAKIT_STATUS_ERROR_IO - The descriptor could not be registered
+PakitStatus pakit_io_attach(PakitIoLoop* loop, int fd, PakitReceiver* receiver,
+                            PakitIoCallback callback, void* context, size_t* channel);
+
+// Stops reading a channel's descriptor; the descriptor is not closed
+// Safe to call from a callback
+// Returns:
+//   PAKIT_STATUS_SUCCESS - No read is left in flight; the descriptor may be closed
+//   PAKIT_STATUS_ERROR_NULL_PARAM - loop is NULL or channel is not attached
+//   PAKIT_STATUS_ERROR_IO - The io_uring read could not be cancelled because the
+//                           submission queue is full; the channel stays attached,
+//                           retry after pakit_io_poll
+PakitStatus pakit_io_detach(PakitIoLoop* loop, size_t channel);
+
+// Waits for data and delivers the packets read
+// Parameters:
+//   loop - Pointer to the PakitIoLoop
+//   timeout_ms - Longest wait in milliseconds, 0 to return at once, -1 to wait forever
+//   delivered - Receives the number of packets handed to callbacks (can be NULL)
+// Returns:
+//   PAKIT_STATUS_SUCCESS - Data was processed or the timeout expired
+//   PAKIT_STATUS_ERROR_NULL_PARAM - loop is NULL
+//   PAKIT_STATUS_ERROR_IO - Waiting failed
+PakitStatus pakit_io_poll(PakitIoLoop* loop, int timeout_ms, size_t* delivered);
+
+#endif // __linux__
+
+#endif // pakit_io_H
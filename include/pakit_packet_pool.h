@@ -0,0 +1,102 @@
+#ifndef pakit_packet_pool_H
+#define pakit_packet_pool_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include "pakit.h"
+
+// Fixed-size pool of reference-counted packets for handing received packets to
+// other threads without a malloc and memcpy per packet.
+// Every slot is a cache-line aligned block holding a PakitPacket followed by its
+// payload, so two slots never share a cache line. Free slots are kept on a
+// lock-free stack whose head carries a tag against ABA; any thread may acquire
+// and release. A receiver attached to a pool writes payloads straight into a
+// slot, and pakit_take_packet swaps the filled slot for a fresh one.
+
+#define PAKIT_CACHE_LINE 64
+#define PAKIT_PACKET_NONE 0xFFFFFFFFu   // Empty freelist link
+
+typedef struct PakitPacketPool PakitPacketPool;
+
+typedef struct PakitPacket {
+    PakitView view;              // Header fields; payload points at the slot's data
+    PakitPacketPool *pool;
+    _Atomic uint32_t refs;
+    _Atomic uint32_t next;       // Freelist link while the slot is free
+    uint32_t index;
+} PakitPacket;
+
+struct PakitPacketPool {
+    uint8_t *slab;
+    size_t slot_size;            // PakitPacket header room plus payload, cache-line multiple
+    uint32_t slot_count;
+    uint16_t max_payload_size;
+    _Alignas(PAKIT_CACHE_LINE) _Atomic uint64_t free_head;  // Tag << 32 | slot index
+    _Alignas(PAKIT_CACHE_LINE) _Atomic uint32_t free_count;
+};
+
+// Creates a pool
+// Parameters:
+//   pool - Pointer to the PakitPacketPool to initialize
+//   slot_count - Number of packets that can be held at once
+//   max_payload_size - Payload capacity of every slot
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The pool is ready
+//   PAKIT_STATUS_ERROR_NULL_PARAM - pool is NULL or slot_count is 0 or too large
+//   PAKIT_STATUS_ERROR_NO_MEMORY - The slab could not be allocated
+PakitStatus pakit_packet_pool_create(PakitPacketPool* pool, uint32_t slot_count, uint16_t max_payload_size);
+
+// Releases the slab; no packet of the pool may be in use any more
+void pakit_packet_pool_destroy(PakitPacketPool* pool);
+
+// Takes a free packet with one reference; safe from any thread
+// Returns:
+//   The packet, or NULL if every slot is in use
+PakitPacket* pakit_packet_acquire(PakitPacketPool* pool);
+
+// Adds a reference, e.g. before handing the packet to another consumer
+void pakit_packet_retain(PakitPacket* packet);
+
+// Drops a reference; the slot returns to the pool with the last one
+// Returns:
+//   true if this released the last reference
+bool pakit_packet_release(PakitPacket* packet);
+
+// Writable payload storage of a packet, max_payload_size bytes
+static inline uint8_t* pakit_packet_data(PakitPacket* packet) {
+    return (uint8_t*)packet + ((sizeof(PakitPacket) + PAKIT_CACHE_LINE - 1) & ~(size_t)(PAKIT_CACHE_LINE - 1));
+}
+
+// Copies a view, e.g. one decoded in place, into a pooled packet
+// Returns:
+//   The packet with one reference, or NULL if the pool is empty or the
+//   payload does not fit
+PakitPacket* pakit_packet_from_view(PakitPacketPool* pool, const PakitView* view);
+
+// Makes a receiver collect payloads in slots of pool instead of its own storage
+// The receiver's allocated storage is freed, the parse state is reset and its
+// payload limit becomes pool->max_payload_size. pakit_destroy returns the slot.
+// Parameters:
+//   receiver - Pointer to the PakitReceiver
+//   pool - Pool to take slots from, with at least 2 slots (the receiver always
+//          holds one); must outlive the attachment
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The receiver writes into a pooled slot
+//   PAKIT_STATUS_ERROR_NULL_PARAM - A parameter is NULL, the pool has a single
+//                                   slot or a pool is already attached
+//   PAKIT_STATUS_ERROR_NO_MEMORY - The pool has no free slot
+PakitStatus pakit_attach_packet_pool(PakitReceiver* receiver, PakitPacketPool* pool);
+
+// Hands out the packet a pooled receiver has just completed
+// Call after pakit_receive_byte or pakit_receive_buffer returned
+// PAKIT_STATUS_SUCCESS. The filled slot is replaced by a free one and the
+// receiver is reset for the next packet, so the returned packet stays valid,
+// with one reference, until released from any thread.
+// Parameters:
+//   receiver - Pointer to a receiver attached with pakit_attach_packet_pool
+// Returns:
+//   The packet, or NULL if no packet is complete or the pool has no free slot
+//   (the packet then stays in the receiver until its next byte)
+PakitPacket* pakit_take_packet(PakitReceiver* receiver);
+
+#endif // pakit_packet_pool_H
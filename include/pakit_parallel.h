@@ -0,0 +1,47 @@
+#ifndef pakit_parallel_H
+#define pakit_parallel_H
+
+#include <stddef.h>
+#include "pakit.h"
+
+// Parallel decoding of large in-memory captures (e.g. a mapped file).
+// The data is cut into chunks; each worker finds a safe start point in its chunk
+// by scanning for a SOP with a plausible header, and decodes it independently.
+// Chunk boundaries are then stitched so the packets delivered, and their order,
+// are exactly those of decoding the whole buffer with a single receiver.
+// The workers persist for the whole call and keep decoding up to two windows
+// of thread_count chunks ahead, so later chunks are decoded while earlier ones
+// are stitched and delivered.
+
+// Called once per packet, in stream order, from the thread that called
+// pakit_decode_parallel
+// Parameters:
+//   context - User context passed to pakit_decode_parallel
+//   offset - Offset of the packet's SOP in data
+//   view - The packet; view->payload points into data
+// Returns:
+//   true to continue decoding, false to stop
+typedef bool (*PakitPacketCallback)(void* context, size_t offset, const PakitView* view);
+
+typedef struct {
+    unsigned thread_count;       // Decoding threads, 0 for the number of online CPUs
+    size_t chunk_size;           // Bytes per chunk, 0 for PAKIT_PARALLEL_CHUNK_SIZE
+    uint16_t max_payload_size;   // Largest payload accepted, 0 for MAX_PACKET_SIZE
+} PakitParallelOptions;
+
+#define PAKIT_PARALLEL_CHUNK_SIZE (1024 * 1024)
+
+// Decodes every packet in data using several threads
+// Parameters:
+//   data - Pointer to the bytes to decode
+//   length - Number of bytes in data
+//   options - Decoder options (can be NULL for defaults)
+//   callback - Function receiving each packet in order
+//   context - User context passed to callback
+// Returns:
+//   Number of packets delivered to callback
+size_t pakit_decode_parallel(const uint8_t* data, size_t length,
+                             const PakitParallelOptions* options,
+                             PakitPacketCallback callback, void* context);
+
+#endif // pakit_parallel_H
@@ -0,0 +1,78 @@
+#ifndef pakit_pool_H
+#define pakit_pool_H
+
+#include <stddef.h>
+#include "pakit.h"
+
+// Pool of packet receivers for many independent channels.
+// Per-channel parse state is kept in densely packed arrays so the hot fields of
+// thousands of channels share cache lines, and payload storage is taken from a
+// shared slab only while a packet is in flight on a channel.
+typedef struct {
+    size_t channel_count;
+    uint16_t max_payload_size;   // Size of one slab slot
+
+    // Per-channel state, indexed by channel
+    uint8_t *state;              // ReceiverState of the channel
+    uint32_t *received_bytes;    // Header plus payload bytes received
+    uint16_t *expected_payload_size;
+    uint32_t *slot;              // Slab slot holding the payload, PAKIT_POOL_NO_SLOT if none
+    PacketHeader *headers;       // Header bytes received so far
+
+    // Shared payload slab with a stack of free slot indices
+    uint8_t *slab;
+    uint32_t *free_slots;
+    uint32_t slot_count;
+    uint32_t free_count;
+} PakitReceiverPool;
+
+#define PAKIT_POOL_NO_SLOT 0xFFFFFFFFu
+
+// Creates a pool of channel receivers
+// Parameters:
+//   pool - Pointer to the PakitReceiverPool to initialize
+//   channel_count - Number of channels
+//   slot_count - Number of payloads that can be in flight at once across all channels
+//   max_payload_size - Largest payload accepted on any channel
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The pool is ready
+//   PAKIT_STATUS_ERROR_NULL_PARAM - pool is NULL
+//   PAKIT_STATUS_ERROR_NO_MEMORY - The pool could not be allocated or its size overflows
+PakitStatus pakit_pool_create(PakitReceiverPool* pool, size_t channel_count,
+                              uint32_t slot_count, uint16_t max_payload_size);
+
+// Releases all memory owned by a pool
+// Parameters:
+//   pool - Pointer to the PakitReceiverPool to destroy
+void pakit_pool_destroy(PakitReceiverPool* pool);
+
+// Resets one channel, dropping any partial packet and releasing its slot
+// Parameters:
+//   pool - Pointer to the PakitReceiverPool
+//   channel - Channel index
+void pakit_pool_reset(PakitReceiverPool* pool, size_t channel);
+
+// Processes bytes received on one channel until a packet completes
+// Parameters:
+//   pool - Pointer to the PakitReceiverPool
+//   channel - Channel index
+//   buffer - Pointer to the buffer containing bytes to process
+//   buffer_length - Number of bytes in the buffer
+//   position - Pointer to position variable: input is starting position, output is ending position
+//              Can be NULL, in which case processing starts at position 0
+//   view - Receives the packet on success
+// Returns:
+//   PAKIT_STATUS_SUCCESS - A complete packet is available in view
+//   PAKIT_STATUS_IN_PROGRESS - More bytes needed to complete the packet
+//   PAKIT_STATUS_ERROR_NO_MEMORY - No free slot for the payload; the packet was dropped
+//   PAKIT_STATUS_ERROR_* - Other errors as reported by pakit_receive_buffer
+// Notes:
+//   Like pakit_next_view, a packet that lies entirely in buffer is returned in
+//   place. Otherwise view->payload points into the channel's slab slot, which is
+//   kept until the next call for that channel. A zero-size packet that
+//   arrived across reads has payload NULL.
+PakitStatus pakit_pool_receive(PakitReceiverPool* pool, size_t channel,
+                               const uint8_t* buffer, size_t buffer_length,
+                               size_t* position, PakitView* view);
+
+#endif // pakit_pool_H
@@ -0,0 +1,89 @@
+#ifndef pakit_queue_H
+#define pakit_queue_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include "pakit.h"
+#include "pakit_packet_pool.h"
+
+// Bounded lock-free queues moving pooled packets from receiver threads to
+// worker threads. Each cell carries a sequence number that tells producers and
+// consumers whose turn it is, so any number of threads can push and pop with a
+// single compare-and-swap per operation and no lock (Vyukov's MPMC design).
+// A sharded queue routes each packet type to a fixed shard, keeping the order
+// within a type while workers each drain their own shard.
+
+typedef struct {
+    _Atomic size_t sequence;
+    PakitPacket *packet;
+} PakitQueueCell;
+
+typedef struct {
+    PakitQueueCell *cells;
+    size_t mask;                                        // Capacity - 1
+    _Alignas(PAKIT_CACHE_LINE) _Atomic size_t head;     // Next cell to push
+    _Alignas(PAKIT_CACHE_LINE) _Atomic size_t tail;     // Next cell to pop
+} PakitQueue;
+
+typedef struct {
+    PakitQueue *shards;
+    size_t shard_count;
+} PakitShardedQueue;
+
+// Creates a queue
+// Parameters:
+//   queue - Pointer to the PakitQueue to initialize
+//   capacity - Number of packets the queue holds, a power of two of at least 2
+// Returns:
+//   PAKIT_STATUS_SUCCESS - The queue is ready
+//   PAKIT_STATUS_ERROR_NULL_PARAM - queue is NULL or capacity is invalid
+//   PAKIT_STATUS_ERROR_NO_MEMORY - The cells could not be allocated
+PakitStatus pakit_queue_create(PakitQueue* queue, size_t capacity);
+
+// Releases the cells; packets still queued are not released
+void pakit_queue_destroy(PakitQueue* queue);
+
+// Appends a packet; safe from any thread
+// Returns:
+//   true if the packet was queued, false if the queue is full
+bool pakit_queue_push(PakitQueue* queue, PakitPacket* packet);
+
+// Removes up to max_packets packets in queue order; safe from any thread
+// Returns:
+//   Number of packets stored in packets, 0 if the queue is empty
+size_t pakit_queue_pop_batch(PakitQueue* queue, PakitPacket** packets, size_t max_packets);
+
+// Creates shard_count queues of capacity packets each
+// Returns as for pakit_queue_create
+PakitStatus pakit_shards_create(PakitShardedQueue* queue, size_t shard_count, size_t capacity);
+
+// Releases all shards
+void pakit_shards_destroy(PakitShardedQueue* queue);
+
+// Shard that packets of a type are routed to
+static inline size_t pakit_shard_for_type(const PakitShardedQueue* queue, uint16_t type) {
+    return type % queue->shard_count;
+}
+
+// Appends a packet to the shard of its type
+// Returns:
+//   true if the packet was queued, false if that shard is full
+bool pakit_shards_push(PakitShardedQueue* queue, PakitPacket* packet);
+
+// Decodes a buffer with a pooled receiver and queues every packet
+// Parameters:
+//   receiver - Receiver attached to a pool with pakit_attach_packet_pool
+//   buffer - Pointer to the buffer containing bytes to process
+//   buffer_length - Number of bytes in the buffer
+//   queue - Sharded queue taking the packets
+//   consumed - Receives the number of buffer bytes processed (can be NULL)
+// Returns:
+//   Number of packets queued
+// Notes:
+//   When the pool runs dry or a shard is full the receiver thread yields until
+//   workers release packets or make room, so slow workers push back on the
+//   reader instead of packets being dropped. Invalid bytes are skipped.
+size_t pakit_receive_enqueue(PakitReceiver* receiver, const uint8_t* buffer, size_t buffer_length,
+                             PakitShardedQueue* queue, size_t* consumed);
+
+#endif // pakit_queue_H
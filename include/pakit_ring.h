@@ -0,0 +1,87 @@
+#ifndef pakit_ring_H
+#define pakit_ring_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include "pakit.h"
+
+// Lock-free single-producer/single-consumer byte ring.
+// The producer (typically a UART ISR or DMA completion handler) only advances
+// head and the consumer only advances tail, so no lock is needed between them.
+// The capacity must be a power of two; indices run freely and are masked on use.
+// Head and tail sit on their own cache lines, except under PAKIT_MINIMAL where
+// the padding would cost more RAM than the ring's bookkeeping.
+#ifdef PAKIT_MINIMAL
+#define PAKIT_RING_ALIGN
+#else
+#define PAKIT_RING_ALIGN _Alignas(64)
+#endif
+
+typedef struct {
+    PAKIT_RING_ALIGN _Atomic size_t head;   // Next byte to write, owned by the producer
+    PAKIT_RING_ALIGN _Atomic size_t tail;   // Next byte to read, owned by the consumer
+    uint8_t *data;
+    size_t mask;                            // Capacity - 1
+} PakitRing;
+
+// Initializes a ring over caller-owned storage
+// Parameters:
+//   ring - Pointer to the PakitRing to initialize
+//   storage - Byte storage of capacity bytes
+//   capacity - Size of storage, must be a non-zero power of two
+// Returns:
+//   true if the ring was initialized, false if parameters were invalid
+bool pakit_ring_init(PakitRing* ring, uint8_t* storage, size_t capacity);
+
+// Number of bytes waiting to be consumed
+size_t pakit_ring_used(PakitRing* ring);
+
+// Producer side: appends up to length bytes
+// Returns:
+//   Number of bytes written, less than length if the ring is full
+size_t pakit_ring_write(PakitRing* ring, const uint8_t* data, size_t length);
+
+// Producer side: appends a single byte, suitable for a per-byte ISR
+// Returns:
+//   true if the byte was stored, false if the ring is full
+static inline bool pakit_ring_put(PakitRing* ring, uint8_t byte) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail > ring->mask) {
+        return false;
+    }
+
+    ring->data[head & ring->mask] = byte;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+// Consumer side: returns the readable bytes as at most two contiguous spans
+// Parameters:
+//   ring - Pointer to the PakitRing
+//   first, first_length - First span (up to the end of storage)
+//   second, second_length - Wrapped-around span (empty if the data does not wrap)
+// Returns:
+//   Total number of readable bytes
+size_t pakit_ring_peek(PakitRing* ring,
+                       const uint8_t** first, size_t* first_length,
+                       const uint8_t** second, size_t* second_length);
+
+// Consumer side: releases count bytes back to the producer
+void pakit_ring_consume(PakitRing* ring, size_t count);
+
+// Feeds the bytes waiting in the ring to a receiver without linearizing them
+// Bytes are parsed straight out of the ring's spans and released as they are
+// consumed; processing stops when a packet completes or an error occurs, like
+// pakit_receive_buffer.
+// Parameters:
+//   receiver - Pointer to the PakitReceiver
+//   ring - Pointer to the PakitRing to read from
+// Returns:
+//   PAKIT_STATUS_SUCCESS - A complete packet has been received
+//   PAKIT_STATUS_IN_PROGRESS - The ring is drained, more data needed
+//   PAKIT_STATUS_ERROR_* - An error occurred during processing
+PakitStatus pakit_receive_ring(PakitReceiver* receiver, PakitRing* ring);
+
+#endif // pakit_ring_H
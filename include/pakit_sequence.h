@@ -0,0 +1,76 @@
+#ifndef pakit_sequence_H
+#define pakit_sequence_H
+
+#include <stddef.h>
+#include "pakit.h"
+
+// Sequence tracking on the packet count field. Expected counts are kept per
+// packet type (or for the whole stream) in a small open addressing table on
+// caller storage, and every completed packet is classified against them.
+// Counts are 16-bit and wrap: a count up to 0x7FFF ahead of the expected one
+// is a gap, anything behind it is a duplicate or a late packet.
+
+typedef enum {
+    PAKIT_SEQUENCE_FIRST,        // First packet of its type, nothing to compare with
+    PAKIT_SEQUENCE_IN_ORDER,     // Count is the expected one
+    PAKIT_SEQUENCE_GAP,          // Packets were skipped; see last_gap
+    PAKIT_SEQUENCE_DUPLICATE,    // Same count as the previous packet
+    PAKIT_SEQUENCE_REORDERED,    // Older count arriving late
+    PAKIT_SEQUENCE_UNTRACKED     // Type table is full; packet not tracked
+} PakitSequenceEvent;
+
+typedef struct {
+    uint16_t type;
+    uint16_t expected;           // Count expected next
+    bool used;
+} PakitSequenceEntry;
+
+typedef struct {
+    uint64_t packets;            // Packets classified
+    uint64_t lost;               // Packets skipped by gaps, less those arriving late
+    uint64_t gaps;               // Gap events
+    uint64_t duplicates;
+    uint64_t reordered;
+    uint64_t untracked;          // Packets of types that did not fit in the table
+} PakitSequenceStats;
+
+typedef struct PakitSequenceTracker {
+    PakitSequenceEntry *entries; // Caller storage, capacity entries
+    size_t mask;                 // capacity - 1
+    unsigned shift;              // 32 - log2(capacity): the hash keeps the product's top bits
+    bool per_type;               // Separate sequences per packet type
+    PakitSequenceStats stats;
+    PakitSequenceEvent last_event; // Classification of the most recent packet
+    uint16_t last_gap;           // Packets skipped by the most recent gap
+} PakitSequenceTracker;
+
+// Initializes a sequence tracker on caller storage
+// Parameters:
+//   tracker - Pointer to the PakitSequenceTracker to initialize
+//   entries - Storage for capacity entries, one per tracked type
+//   capacity - Number of entries, a power of two (1 is enough when per_type is false)
+//   per_type - true to track each packet type separately, false for one stream-wide sequence
+// Returns:
+//   true on success, false if a parameter is invalid
+bool pakit_sequence_init(PakitSequenceTracker* tracker, PakitSequenceEntry* entries,
+                         size_t capacity, bool per_type);
+
+// Forgets all expected counts and clears the statistics
+void pakit_sequence_reset(PakitSequenceTracker* tracker);
+
+// Classifies a packet and updates the statistics
+// Called by the receiver for every completed packet once attached with
+// pakit_set_sequence; can also be used on its own
+// Parameters:
+//   tracker - Pointer to the PakitSequenceTracker
+//   type - Packet type
+//   count - Packet count field
+// Returns:
+//   The classification of the packet, also stored in last_event
+PakitSequenceEvent pakit_sequence_update(PakitSequenceTracker* tracker, uint16_t type, uint16_t count);
+
+// Attaches a tracker to a receiver, or detaches it when tracker is NULL
+// Packets delivered as zero-copy views are tracked too
+void pakit_set_sequence(PakitReceiver* receiver, PakitSequenceTracker* tracker);
+
+#endif // pakit_sequence_H
@@ -0,0 +1,207 @@
+#ifndef pakit_spec_H
+#define pakit_spec_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "pakit.h"
+
+// Receivers specialized at compile time for one wire format.
+// PAKIT_SPEC_RECEIVER generates a receiver type and static inline functions for
+// a fixed SOP, field layout and byte order. Every offset and field width is a
+// constant, so the compiler reduces the header parse to straight-line loads and
+// compares, and formats that differ from the library's (other SOP bytes, no
+// count field, 1-byte fields, little-endian) need no fork of the library.
+//
+// PAKIT_SPEC_RECEIVER(name, sop0, sop1, type_size, count_size, size_size,
+//                     big_endian, max_payload) defines:
+//   name##_receiver                  Receiver with max_payload bytes of storage
+//   name##_HEADER_SIZE               Header size on the wire
+//   void name##_init(name##_receiver* receiver)
+//   PakitStatus name##_parse(buffer, buffer_length, position, view)
+//       Decodes a packet in place, as pakit_parse_view does, resyncing on the same
+//       SOP candidates
+//   PakitStatus name##_receive_byte(receiver, byte, view)
+//       Per-byte decoding; view is filled on PAKIT_STATUS_SUCCESS
+//   PakitStatus name##_receive_buffer(receiver, buffer, buffer_length, position, view)
+//       Like pakit_next_view: packets inside buffer are returned in place, packets
+//       spanning reads are collected in the receiver
+//
+// type_size and size_size are 1 or 2 bytes, count_size is 0 (no count field, the
+// view's count is 0) or 2. A view's payload stays valid until the next call on
+// the receiver or, for in-place views, while the buffer does.
+
+// Reads a 1 or 2 byte header field; constant arguments fold to a load or two
+static inline uint16_t pakit_spec_field(const uint8_t* data, size_t size, bool big_endian) {
+    if (size == 0) {
+        return 0;
+    }
+    if (size == 1) {
+        return data[0];
+    }
+    return big_endian ? (uint16_t)(((uint16_t)data[0] << 8) | data[1])
+                      : (uint16_t)(((uint16_t)data[1] << 8) | data[0]);
+}
+
+// Offset of the first SOP candidate in data, or length if there is none. As in
+// pakit_find_sop, a candidate is sop0 followed by sop1, or sop0 as the last byte.
+static inline size_t pakit_spec_find_sop(const uint8_t* data, size_t length, uint8_t sop0, uint8_t sop1) {
+    size_t pos = 0;
+    while (pos < length) {
+        const uint8_t* found = memchr(&data[pos], sop0, length - pos);
+        if (found == NULL) {
+            return length;
+        }
+        pos = (size_t)(found - data);
+        if (pos + 1 == length || data[pos + 1] == sop1) {
+            return pos;
+        }
+        pos++;
+    }
+    return length;
+}
+
+#define PAKIT_SPEC_RECEIVER(name, sop0, sop1, type_size, count_size, size_size, big_endian, max_payload) \
+    _Static_assert((type_size) == 1 || (type_size) == 2, #name ": type_size must be 1 or 2");          \
+    _Static_assert((count_size) == 0 || (count_size) == 2, #name ": count_size must be 0 or 2");       \
+    _Static_assert((size_size) == 1 || (size_size) == 2, #name ": size_size must be 1 or 2");          \
+    _Static_assert((max_payload) > 0 && (max_payload) <= PAKIT_MAX_PAYLOAD_LIMIT,                     \
+                   #name ": invalid max_payload");                                                   \
+                                                                                                       \
+    enum {                                                                                             \
+        name##_TYPE_OFFSET = 2,                                                                        \
+        name##_COUNT_OFFSET = 2 + (type_size),                                                         \
+        name##_SIZE_OFFSET = 2 + (type_size) + (count_size),                                           \
+        name##_HEADER_SIZE = 2 + (type_size) + (count_size) + (size_size)                              \
+    };                                                                                                 \
+                                                                                                       \
+    typedef struct {                                                                                   \
+        uint8_t header[name##_HEADER_SIZE];                                                            \
+        size_t received;             /* Header plus payload bytes of the current packet */            \
+        uint16_t size;               /* Payload size once the header is complete */                   \
+        uint8_t payload[max_payload];                                                                  \
+    } name##_receiver;                                                                                 \
+                                                                                                       \
+    static inline void name##_init(name##_receiver* receiver) {                                        \
+        receiver->received = 0;                                                                        \
+        receiver->size = 0;                                                                            \
+    }                                                                                                  \
+                                                                                                       \
+    /* Fills a view from a complete header */                                                          \
+    static inline void name##_view(const uint8_t* header, const uint8_t* payload, PakitView* view) {   \
+        view->type = pakit_spec_field(&header[name##_TYPE_OFFSET], (type_size), (big_endian));         \
+        view->count = pakit_spec_field(&header[name##_COUNT_OFFSET], (count_size), (big_endian));      \
+        view->size = pakit_spec_field(&header[name##_SIZE_OFFSET], (size_size), (big_endian));         \
+        view->payload = payload;                                                                       \
+    }                                                                                                  \
+                                                                                                       \
+    static inline PakitStatus name##_parse(const uint8_t* buffer, size_t buffer_length,                \
+                                           size_t* position, PakitView* view) {                        \
+        size_t pos = *position;                                                                        \
+        if (pos >= buffer_length) {                                                                    \
+            return PAKIT_STATUS_IN_PROGRESS;                                                           \
+        }                                                                                              \
+        const uint8_t* data = &buffer[pos];                                                            \
+        size_t available = buffer_length - pos;                                                        \
+                                                                                                       \
+        if (data[0] != (sop0) || (available > 1 && data[1] != (sop1))) {                               \
+            *position = pos + pakit_spec_find_sop(data, available, (sop0), (sop1));                    \
+            return PAKIT_STATUS_ERROR_INVALID_SOP;                                                     \
+        }                                                                                              \
+        if (available < name##_HEADER_SIZE) {                                                          \
+            return PAKIT_STATUS_IN_PROGRESS;                                                           \
+        }                                                                                              \
+                                                                                                       \
+        uint16_t size = pakit_spec_field(&data[name##_SIZE_OFFSET], (size_size), (big_endian));        \
+        if (size > (max_payload)) {                                                                    \
+            *position = pos + name##_HEADER_SIZE;                                                      \
+            return PAKIT_STATUS_ERROR_SIZE_LARGE;                                                      \
+        }                                                                                              \
+        if (available - name##_HEADER_SIZE < size) {                                                   \
+            return PAKIT_STATUS_IN_PROGRESS;                                                           \
+        }                                                                                              \
+                                                                                                       \
+        name##_view(data, &data[name##_HEADER_SIZE], view);                                            \
+        *position = pos + name##_HEADER_SIZE + size;                                                   \
+        return PAKIT_STATUS_SUCCESS;                                                                   \
+    }                                                                                                  \
+                                                                                                       \
+    /* Completes the buffered packet */                                                                \
+    static inline PakitStatus name##_done(name##_receiver* receiver, PakitView* view) {                \
+        name##_view(receiver->header, receiver->payload, view);                                        \
+        receiver->received = 0;                                                                        \
+        return PAKIT_STATUS_SUCCESS;                                                                   \
+    }                                                                                                  \
+                                                                                                       \
+    static inline PakitStatus name##_receive_byte(name##_receiver* receiver, uint8_t byte,             \
+                                                  PakitView* view) {                                   \
+        size_t received = receiver->received;                                                          \
+                                                                                                       \
+        if (received >= name##_HEADER_SIZE) {                                                          \
+            receiver->payload[received - name##_HEADER_SIZE] = byte;                                   \
+            receiver->received = ++received;                                                           \
+            return (received == name##_HEADER_SIZE + (size_t)receiver->size)                           \
+                       ? name##_done(receiver, view) : PAKIT_STATUS_IN_PROGRESS;                       \
+        }                                                                                              \
+                                                                                                       \
+        if (received == 0 && byte != (sop0)) {                                                         \
+            return PAKIT_STATUS_ERROR_INVALID_SOP;                                                     \
+        }                                                                                              \
+        if (received == 1 && byte != (sop1)) {                                                         \
+            /* A repeated first SOP byte may still start the next packet */                            \
+            receiver->received = (byte == (sop0)) ? 1 : 0;                                             \
+            return PAKIT_STATUS_ERROR_INVALID_SOP;                                                     \
+        }                                                                                              \
+                                                                                                       \
+        receiver->header[received] = byte;                                                             \
+        receiver->received = ++received;                                                               \
+        if (received < name##_HEADER_SIZE) {                                                           \
+            return PAKIT_STATUS_IN_PROGRESS;                                                           \
+        }                                                                                              \
+                                                                                                       \
+        receiver->size = pakit_spec_field(&receiver->header[name##_SIZE_OFFSET], (size_size),          \
+                                          (big_endian));                                               \
+        if (receiver->size > (max_payload)) {                                                          \
+            receiver->received = 0;                                                                    \
+            return PAKIT_STATUS_ERROR_SIZE_LARGE;                                                      \
+        }                                                                                              \
+        return (receiver->size == 0) ? name##_done(receiver, view) : PAKIT_STATUS_IN_PROGRESS;         \
+    }                                                                                                  \
+                                                                                                       \
+    static inline PakitStatus name##_receive_buffer(name##_receiver* receiver, const uint8_t* buffer,  \
+                                                    size_t buffer_length, size_t* position,            \
+                                                    PakitView* view) {                                 \
+        size_t pos = *position;                                                                        \
+        PakitStatus status = PAKIT_STATUS_IN_PROGRESS;                                                 \
+                                                                                                       \
+        /* Nothing buffered: decode in place when the whole packet is here */                          \
+        if (receiver->received == 0) {                                                                 \
+            status = name##_parse(buffer, buffer_length, &pos, view);                                  \
+            if (status != PAKIT_STATUS_IN_PROGRESS) {                                                  \
+                *position = pos;                                                                       \
+                return status;                                                                         \
+            }                                                                                          \
+        }                                                                                              \
+                                                                                                       \
+        while (pos < buffer_length && status == PAKIT_STATUS_IN_PROGRESS) {                            \
+            size_t received = receiver->received;                                                      \
+            if (received >= name##_HEADER_SIZE) {                                                      \
+                /* Copy as much of the payload as is here at once */                                   \
+                size_t remaining = name##_HEADER_SIZE + (size_t)receiver->size - received;             \
+                size_t count = (buffer_length - pos < remaining) ? buffer_length - pos : remaining;    \
+                memcpy(&receiver->payload[received - name##_HEADER_SIZE], &buffer[pos], count);       \
+                receiver->received += count;                                                           \
+                pos += count;                                                                          \
+                if (count == remaining) {                                                              \
+                    status = name##_done(receiver, view);                                              \
+                }                                                                                      \
+            } else {                                                                                   \
+                status = name##_receive_byte(receiver, buffer[pos++], view);                           \
+            }                                                                                          \
+        }                                                                                              \
+                                                                                                       \
+        *position = pos;                                                                               \
+        return status;                                                                                 \
+    }
+
+#endif // pakit_spec_H
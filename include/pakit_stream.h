@@ -0,0 +1,57 @@
+#ifndef pakit_stream_H
+#define pakit_stream_H
+
+#include <stddef.h>
+#include "pakit.h"
+
+// Streaming delivery of large payloads. With a stream attached the receiver
+// announces each packet as soon as its header is complete and then hands the
+// payload over in chunks as the bytes arrive, instead of collecting it in its
+// payload storage: a receiver can take frames up to the 64 KiB the size field
+// allows with no more storage than the header. Chunks of bulk input point
+// straight into the caller's buffer.
+
+// Called once a packet's header has been received
+// Parameters:
+//   context - PakitStream.context
+//   header - Type, count and payload size of the packet; payload is NULL
+typedef void (*PakitStreamHeader)(void* context, const PakitView* header);
+
+// Called with the next part of the payload
+// Parameters:
+//   context - PakitStream.context
+//   offset - Position of data within the payload
+//   data - Payload bytes, valid only during the call
+//   length - Number of bytes at data, never 0
+typedef void (*PakitStreamChunk)(void* context, size_t offset, const uint8_t* data, size_t length);
+
+// Called when the packet ends
+// Parameters:
+//   context - PakitStream.context
+//   status - PAKIT_STATUS_SUCCESS, or PAKIT_STATUS_ERROR_CRC when the trailer
+//            does not match in CRC mode and the chunks must be discarded
+typedef void (*PakitStreamEnd)(void* context, PakitStatus status);
+
+typedef struct PakitStream {
+    PakitStreamHeader on_header;  // Each callback can be NULL
+    PakitStreamChunk on_chunk;
+    PakitStreamEnd on_end;
+    void *context;
+    uint16_t max_payload_size;    // Largest payload accepted while streaming
+} PakitStream;
+
+// Attaches a stream to a receiver, or detaches it when stream is NULL
+// A partially received packet is dropped. While a stream is attached:
+//   - pakit_receive_byte and pakit_receive_buffer still return
+//     PAKIT_STATUS_SUCCESS for each completed packet, but the payload only
+//     reaches the stream; pakit_is_packet_complete reports a NULL payload
+//   - pakit_next_view and pakit_receive_batch never decode in place; their
+//     views carry the header fields with a NULL payload
+//   - payloads are limited by stream->max_payload_size rather than by the
+//     receiver's storage
+// Parameters:
+//   receiver - Pointer to the PakitReceiver
+//   stream - Stream to deliver to; must stay valid while attached
+void pakit_set_stream(PakitReceiver* receiver, PakitStream* stream);
+
+#endif // pakit_stream_H
@@ -0,0 +1,106 @@
+#ifndef pakit_timing_H
+#define pakit_timing_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include "pakit.h"
+
+// Packet latency measurement on caller-supplied timestamps. Each read is handed
+// to the receiver with the time it arrived (pakit_receive_buffer_at and friends);
+// an attached PakitTiming then knows when each packet's first byte came in and
+// when it completed, and keeps three latency histograms:
+//   complete - first SOP byte to PAKIT_STATUS_SUCCESS
+//   stall    - gap between two reads feeding the same packet (inter-byte stalls
+//              when reads are single bytes)
+//   wait     - completion to pickup by the application, see pakit_timing_pickup
+// Timestamps are in nanoseconds from any monotonic clock.
+//
+// The histograms are log-linear (HDR style): exact below 16 ns, and within 1/16
+// of the value above, up to PAKIT_HISTOGRAM_MAX_NS. Buckets are atomics, so any
+// thread can take a snapshot while the receiver records, without a lock.
+
+#define PAKIT_HISTOGRAM_SUB_BITS 4                          // 16 sub-buckets per power of two
+#define PAKIT_HISTOGRAM_SUB_COUNT (1u << PAKIT_HISTOGRAM_SUB_BITS)
+#define PAKIT_HISTOGRAM_MAX_BITS 40                         // Values saturate at 2^40 ns (about 18 minutes)
+#define PAKIT_HISTOGRAM_MAX_NS ((uint64_t)1 << PAKIT_HISTOGRAM_MAX_BITS)
+#define PAKIT_HISTOGRAM_BUCKETS \
+    ((PAKIT_HISTOGRAM_MAX_BITS - PAKIT_HISTOGRAM_SUB_BITS + 1) * PAKIT_HISTOGRAM_SUB_COUNT)
+
+typedef struct {
+    _Atomic uint64_t counts[PAKIT_HISTOGRAM_BUCKETS];
+    _Atomic uint64_t total;
+    _Atomic uint64_t max_ns;
+} PakitHistogram;
+
+// Plain copy of a histogram, see pakit_histogram_snapshot
+typedef struct {
+    uint64_t counts[PAKIT_HISTOGRAM_BUCKETS];
+    uint64_t total;
+    uint64_t max_ns;
+} PakitHistogramSnapshot;
+
+// Arrival times of one packet
+typedef struct {
+    uint64_t first_byte_ns;      // Timestamp of the read holding its first SOP byte
+    uint64_t complete_ns;        // Timestamp of the read that completed it
+} PakitPacketTimes;
+
+typedef struct PakitTiming {
+    uint64_t now_ns;             // Timestamp of the read being processed
+    uint64_t first_byte_ns;      // First byte of the packet being received
+    uint64_t last_read_ns;       // Latest read that fed the packet being received
+    PakitPacketTimes last;       // Most recently completed packet
+    PakitHistogram complete;     // First byte to completion
+    PakitHistogram stall;        // Gap between reads within a packet
+    PakitHistogram wait;         // Completion to pickup
+} PakitTiming;
+
+// Clears a timing block's times and histograms
+void pakit_timing_reset(PakitTiming* timing);
+
+// Attaches a timing block to a receiver, or detaches it when timing is NULL
+// A partially received packet is dropped
+void pakit_set_timing(PakitReceiver* receiver, PakitTiming* timing);
+
+// pakit_receive_byte, pakit_receive_buffer and pakit_next_view for a read that
+// arrived at timestamp_ns. Without a timing block attached they behave exactly
+// like the untimed calls. When it returns PAKIT_STATUS_SUCCESS with a timing
+// block attached, pakit_next_view_at also fills times (can be NULL).
+PakitStatus pakit_receive_byte_at(PakitReceiver* receiver, uint8_t byte, uint64_t timestamp_ns);
+
+PakitStatus pakit_receive_buffer_at(PakitReceiver* receiver, const uint8_t* buffer,
+                                    size_t buffer_length, size_t* position, uint64_t timestamp_ns);
+
+PakitStatus pakit_next_view_at(PakitReceiver* receiver, const uint8_t* buffer, size_t buffer_length,
+                               size_t* position, uint64_t timestamp_ns, PakitView* view,
+                               PakitPacketTimes* times);
+
+// Sets the arrival time of the next read for the other receive calls
+// (pakit_receive_batch, pakit_receive_dispatch, ...). A timestamp equal to the
+// current read's continues that read, so the calls draining one buffer can all
+// pass the same timestamp.
+void pakit_timing_read(PakitReceiver* receiver, uint64_t timestamp_ns);
+
+// Times of the most recently completed packet
+// Returns:
+//   true if a timing block is attached, false otherwise
+bool pakit_packet_times(const PakitReceiver* receiver, PakitPacketTimes* times);
+
+// Records in the wait histogram that a packet completed at complete_ns was
+// picked up at now_ns. Safe from any thread, e.g. the worker that dequeued it.
+void pakit_timing_pickup(PakitTiming* timing, uint64_t complete_ns, uint64_t now_ns);
+
+// Records a value in a histogram from a single writer thread
+void pakit_histogram_record(PakitHistogram* histogram, uint64_t value_ns);
+
+// Copies a histogram; safe while another thread records into it
+void pakit_histogram_snapshot(const PakitHistogram* histogram, PakitHistogramSnapshot* snapshot);
+
+// Lowest value counted in a bucket
+uint64_t pakit_histogram_bucket_value(size_t index);
+
+// Value at or below which percentile percent of the recorded values lie, to
+// the histogram's precision; 0 for an empty snapshot
+uint64_t pakit_histogram_percentile(const PakitHistogramSnapshot* snapshot, double percentile);
+
+#endif // pakit_timing_H
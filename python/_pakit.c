@@ -0,0 +1,396 @@
+// CPython extension over the C library: batch decoding of large captures into
+// packed records with the GIL released, a streaming decoder and an encoder.
+// The records use the PakitIndexEntry layout so they map straight onto a
+// NumPy structured array (see RECORD_DTYPE in pakit.py) without a copy.
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pakit.h"
+#include "pakit_index.h"
+#include "pakit_parallel.h"
+
+#define PAKIT_PY_DEFAULT_PAYLOAD 1024   // Packet.MAX_PAYLOAD_SIZE of pakit.py
+#define PAKIT_PY_BATCH 256              // Views per GIL release in Decoder.feed
+
+// ---------------------------------------------------------------------------
+// decode(data, max_payload_size=1024, threads=0) -> (records, end)
+
+typedef struct {
+    PakitIndexEntry *records;
+    size_t count;
+    size_t capacity;
+    size_t end;                  // Offset just past the last packet
+    bool failed;
+} RecordList;
+
+static bool append_record(void* context, size_t offset, const PakitView* view) {
+    RecordList* list = context;
+
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 4096;
+        PakitIndexEntry* grown = realloc(list->records, capacity * sizeof(PakitIndexEntry));
+        if (grown == NULL) {
+            list->failed = true;
+            return false;
+        }
+        list->records = grown;
+        list->capacity = capacity;
+    }
+
+    PakitIndexEntry* record = &list->records[list->count++];
+    record->offset = offset;
+    record->type = view->type;
+    record->count = view->count;
+    record->size = view->size;
+    record->reserved = 0;
+    list->end = offset + HEADER_SIZE + view->size;
+    return true;
+}
+
+static PyObject* pakit_py_decode(PyObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = {"data", "max_payload_size", "threads", NULL};
+    Py_buffer data;
+    unsigned int max_payload_size = PAKIT_PY_DEFAULT_PAYLOAD;
+    unsigned int threads = 0;
+    (void)self;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|II", keywords, &data, &max_payload_size, &threads)) {
+        return NULL;
+    }
+    if (max_payload_size > PAKIT_MAX_PAYLOAD_LIMIT) {
+        PyBuffer_Release(&data);
+        return PyErr_Format(PyExc_ValueError, "max_payload_size must be at most %d", PAKIT_MAX_PAYLOAD_LIMIT);
+    }
+
+    RecordList list = {NULL, 0, 0, 0, false};
+    PakitParallelOptions options = {threads, 0, (uint16_t)max_payload_size};
+
+    // The buffer stays exported while the GIL is released, so it cannot move
+    Py_BEGIN_ALLOW_THREADS
+    pakit_decode_parallel(data.buf, (size_t)data.len, &options, append_record, &list);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&data);
+
+    if (list.failed) {
+        free(list.records);
+        return PyErr_NoMemory();
+    }
+
+    PyObject* records = PyByteArray_FromStringAndSize((const char*)list.records,
+                                                      (Py_ssize_t)(list.count * sizeof(PakitIndexEntry)));
+    free(list.records);
+    if (records == NULL) {
+        return NULL;
+    }
+    return Py_BuildValue("(Nn)", records, (Py_ssize_t)list.end);
+}
+
+// ---------------------------------------------------------------------------
+// encode(packet_type, count, payload=b"") -> bytes
+
+static PyObject* pakit_py_encode(PyObject* self, PyObject* args) {
+    unsigned int type;
+    unsigned int count;
+    Py_buffer payload = {0};
+    (void)self;
+
+    if (!PyArg_ParseTuple(args, "II|y*", &type, &count, &payload)) {
+        return NULL;
+    }
+    if (payload.len > PAKIT_MAX_PAYLOAD_LIMIT) {
+        PyBuffer_Release(&payload);
+        return PyErr_Format(PyExc_ValueError, "payload exceeds %d bytes", PAKIT_MAX_PAYLOAD_LIMIT);
+    }
+
+    Packet packet;
+    uint16_t size = (uint16_t)payload.len;
+    pakit_packet_create(&packet, (uint16_t)type, (uint16_t)count, size ? payload.buf : NULL, size);
+
+    PyObject* encoded = PyBytes_FromStringAndSize(NULL, HEADER_SIZE + size);
+    if (encoded != NULL) {
+        size_t written = 0;
+        pakit_encode_batch(&packet, 1, (uint8_t*)PyBytes_AS_STRING(encoded), HEADER_SIZE + size, &written, NULL);
+    }
+    if (payload.obj != NULL) {
+        PyBuffer_Release(&payload);
+    }
+    return encoded;
+}
+
+// ---------------------------------------------------------------------------
+// Decoder: a PakitReceiver for streams that arrive in pieces
+
+typedef struct {
+    PyObject_HEAD
+    PakitReceiver receiver;
+    bool created;
+    PyThread_type_lock lock;     // Held by every method using the receiver
+} DecoderObject;
+
+// feed runs the receiver without the GIL, so the methods of one Decoder are
+// serialized by its own lock; waiting for it also drops the GIL
+static void decoder_lock(DecoderObject* self) {
+    if (!PyThread_acquire_lock(self->lock, NOWAIT_LOCK)) {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(self->lock, WAIT_LOCK);
+        Py_END_ALLOW_THREADS
+    }
+}
+
+static void decoder_unlock(DecoderObject* self) {
+    PyThread_release_lock(self->lock);
+}
+
+static PyObject* decoder_new(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+    DecoderObject* self = (DecoderObject*)PyType_GenericNew(type, args, kwargs);
+    if (self == NULL) {
+        return NULL;
+    }
+
+    self->lock = PyThread_allocate_lock();
+    if (self->lock == NULL) {
+        Py_DECREF(self);
+        return PyErr_NoMemory();
+    }
+    return (PyObject*)self;
+}
+
+static int decoder_init(DecoderObject* self, PyObject* args, PyObject* kwargs) {
+    static char* keywords[] = {"max_payload_size", NULL};
+    unsigned int max_payload_size = PAKIT_PY_DEFAULT_PAYLOAD;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|I", keywords, &max_payload_size)) {
+        return -1;
+    }
+    if (max_payload_size == 0 || max_payload_size > PAKIT_MAX_PAYLOAD_LIMIT) {
+        PyErr_Format(PyExc_ValueError, "max_payload_size must be 1 to %d", PAKIT_MAX_PAYLOAD_LIMIT);
+        return -1;
+    }
+
+    decoder_lock(self);
+    if (self->created) {
+        pakit_destroy(&self->receiver);
+        self->created = false;
+    }
+    PakitStatus status = pakit_create(&self->receiver, NULL, max_payload_size);
+    self->created = (status == PAKIT_STATUS_SUCCESS);
+    decoder_unlock(self);
+
+    if (!self->created) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
+
+static void decoder_dealloc(DecoderObject* self) {
+    if (self->created) {
+        pakit_destroy(&self->receiver);
+    }
+    if (self->lock != NULL) {
+        PyThread_free_lock(self->lock);
+    }
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// Methods need a receiver; __init__ may have been skipped or have failed
+static bool decoder_ready(DecoderObject* self) {
+    if (!self->created) {
+        PyErr_SetString(PyExc_RuntimeError, "Decoder is not initialized");
+        return false;
+    }
+    return true;
+}
+
+static PyObject* view_tuple(const PakitView* view) {
+    PyObject* payload = PyBytes_FromStringAndSize((const char*)view->payload, (Py_ssize_t)view->size);
+    return (payload != NULL) ? Py_BuildValue("(HHN)", view->type, view->count, payload) : NULL;
+}
+
+static PyObject* decoder_receive_byte(DecoderObject* self, PyObject* arg) {
+    long byte = PyLong_AsLong(arg);
+    if (byte == -1 && PyErr_Occurred()) {
+        return NULL;
+    }
+    if (byte < 0 || byte > 255) {
+        return PyErr_Format(PyExc_ValueError, "byte must be 0 to 255");
+    }
+
+    decoder_lock(self);
+    PyObject* status = decoder_ready(self) ? PyLong_FromLong(pakit_receive_byte(&self->receiver, (uint8_t)byte))
+                                           : NULL;
+    decoder_unlock(self);
+    return status;
+}
+
+static PyObject* decoder_receive_buffer(DecoderObject* self, PyObject* args) {
+    Py_buffer data;
+    Py_ssize_t start = 0;
+
+    if (!PyArg_ParseTuple(args, "y*|n", &data, &start)) {
+        return NULL;
+    }
+    if (start < 0 || start > data.len) {
+        PyBuffer_Release(&data);
+        return PyErr_Format(PyExc_IndexError, "start position out of range");
+    }
+
+    size_t position = (size_t)start;
+    PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
+    decoder_lock(self);
+    bool ready = decoder_ready(self);
+    if (ready && position < (size_t)data.len) {
+        status = pakit_receive_buffer(&self->receiver, data.buf, (size_t)data.len, &position);
+    }
+    decoder_unlock(self);
+    PyBuffer_Release(&data);
+    return ready ? Py_BuildValue("(in)", status, (Py_ssize_t)position) : NULL;
+}
+
+static PyObject* decoder_packet(DecoderObject* self, PyObject* unused) {
+    Packet packet;
+    PyObject* result = NULL;
+    (void)unused;
+
+    decoder_lock(self);
+    if (decoder_ready(self)) {
+        if (self->receiver.state != STATE_COMPLETE || !pakit_is_packet_complete(&self->receiver, &packet)) {
+            Py_INCREF(Py_None);
+            result = Py_None;
+        } else {
+            PakitView view = {((uint16_t)packet.type[0] << 8) | packet.type[1], packet.count, packet.size,
+                              packet.payload};
+            result = view_tuple(&view);
+        }
+    }
+    decoder_unlock(self);
+    return result;
+}
+
+static PyObject* decoder_reset(DecoderObject* self, PyObject* unused) {
+    (void)unused;
+
+    decoder_lock(self);
+    bool ready = decoder_ready(self);
+    if (ready) {
+        pakit_init(&self->receiver);
+    }
+    decoder_unlock(self);
+
+    if (!ready) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* decoder_feed(DecoderObject* self, PyObject* arg) {
+    Py_buffer data;
+    if (PyObject_GetBuffer(arg, &data, PyBUF_SIMPLE) != 0) {
+        return NULL;
+    }
+
+    decoder_lock(self);
+    PyObject* packets = decoder_ready(self) ? PyList_New(0) : NULL;
+    PakitView views[PAKIT_PY_BATCH];
+    size_t position = 0;
+
+    // The lock stays held until the views, which may point into the
+    // receiver's storage, have been copied
+    while (packets != NULL && position < (size_t)data.len) {
+        size_t consumed = 0;
+        size_t count;
+
+        // Decode without the GIL; views are only read once it is held again
+        Py_BEGIN_ALLOW_THREADS
+        count = pakit_receive_batch(&self->receiver, (const uint8_t*)data.buf + position,
+                                    (size_t)data.len - position, views, PAKIT_PY_BATCH, &consumed);
+        Py_END_ALLOW_THREADS
+        position += consumed;
+
+        for (size_t i = 0; i < count; i++) {
+            PyObject* packet = view_tuple(&views[i]);
+            if (packet == NULL || PyList_Append(packets, packet) != 0) {
+                Py_XDECREF(packet);
+                Py_CLEAR(packets);
+                break;
+            }
+            Py_DECREF(packet);
+        }
+    }
+
+    decoder_unlock(self);
+    PyBuffer_Release(&data);
+    return packets;
+}
+
+static PyMethodDef decoder_methods[] = {
+    {"receive_byte", (PyCFunction)decoder_receive_byte, METH_O,
+     "receive_byte(byte) -> status\n\nRuns one byte through the receiver."},
+    {"receive_buffer", (PyCFunction)decoder_receive_buffer, METH_VARARGS,
+     "receive_buffer(data, start=0) -> (status, position)\n\n"
+     "Processes bytes until a packet completes, an error occurs or data ends."},
+    {"packet", (PyCFunction)decoder_packet, METH_NOARGS,
+     "packet() -> (type, count, payload) or None\n\nThe packet just completed."},
+    {"reset", (PyCFunction)decoder_reset, METH_NOARGS,
+     "reset()\n\nDrops any partially received packet."},
+    {"feed", (PyCFunction)decoder_feed, METH_O,
+     "feed(data) -> [(type, count, payload), ...]\n\n"
+     "Decodes every packet completed by data; packets may span calls."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyTypeObject DecoderType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "_pakit.Decoder",
+    .tp_doc = "Decoder(max_payload_size=1024)\n\nStreaming packet decoder backed by a PakitReceiver.",
+    .tp_basicsize = sizeof(DecoderObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = decoder_new,
+    .tp_init = (initproc)decoder_init,
+    .tp_dealloc = (destructor)decoder_dealloc,
+    .tp_methods = decoder_methods,
+};
+
+// ---------------------------------------------------------------------------
+
+static PyMethodDef module_methods[] = {
+    {"decode", (PyCFunction)(void (*)(void))pakit_py_decode, METH_VARARGS | METH_KEYWORDS,
+     "decode(data, max_payload_size=1024, threads=0) -> (records, end)\n\n"
+     "Decodes every packet in data on several threads without holding the GIL.\n"
+     "records is a bytearray of RECORD_SIZE-byte (offset, type, count, size, reserved)\n"
+     "records in native byte order; end is the offset just past the last packet."},
+    {"encode", (PyCFunction)pakit_py_encode, METH_VARARGS,
+     "encode(packet_type, count, payload=b'') -> bytes\n\nEncodes one packet."},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef pakit_module = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "_pakit",
+    .m_doc = "C core of the pakit packet codec.",
+    .m_size = -1,
+    .m_methods = module_methods,
+};
+
+PyMODINIT_FUNC PyInit__pakit(void) {
+    if (PyType_Ready(&DecoderType) < 0) {
+        return NULL;
+    }
+
+    PyObject* module = PyModule_Create(&pakit_module);
+    if (module == NULL) {
+        return NULL;
+    }
+
+    Py_INCREF(&DecoderType);
+    if (PyModule_AddObject(module, "Decoder", (PyObject*)&DecoderType) < 0 ||
+        PyModule_AddIntConstant(module, "HEADER_SIZE", HEADER_SIZE) < 0 ||
+        PyModule_AddIntConstant(module, "RECORD_SIZE", sizeof(PakitIndexEntry)) < 0 ||
+        PyModule_AddIntConstant(module, "MAX_PAYLOAD_LIMIT", PAKIT_MAX_PAYLOAD_LIMIT) < 0) {
+        Py_DECREF(&DecoderType);
+        Py_DECREF(module);
+        return NULL;
+    }
+    return module;
+}
@@ -1,6 +1,18 @@
 import enum
 import struct
-from typing import Optional, Tuple, List, Union, BinaryIO
+from typing import Optional, Tuple, List, Union, BinaryIO, Iterator
+
+# C core (python/_pakit.c); the pure Python implementation below is used when
+# the extension has not been built
+try:
+    import _pakit
+except ImportError:
+    _pakit = None
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
 
 
 class PacketStatus(enum.Enum):
@@ -11,6 +23,9 @@ class PacketStatus(enum.Enum):
     ERROR_SIZE_LARGE = 3  # Error: Payload size too large
     ERROR_OVERFLOW = 4   # Error: Buffer overflow
     ERROR_NULL_PARAM = 5  # Error: NULL parameter provided
+    ERROR_NO_MEMORY = 6  # Error: Payload storage could not be allocated
+    ERROR_IO = 7         # Error: File or device I/O failed
+    ERROR_CRC = 8        # Error: CRC trailer does not match the packet
 
 
 class Packet:
@@ -120,7 +135,7 @@ class Packet:
 
 
 class PacketDecoder:
-    """Class for decoding packets from byte streams"""
+    """Class for decoding packets from byte streams (pure Python)"""
 
     class State(enum.Enum):
         """Internal state machine states"""
@@ -167,17 +182,24 @@ class PacketDecoder:
         # Process according to current state using match statement
         match self.state:
             case self.State.SOP:
-                # Process SOP bytes
-                if len(self.buffer) <= Packet.SOP_SIZE:
-                    self.sop[len(self.buffer) - 1] = byte
-
-                    if len(self.buffer) == Packet.SOP_SIZE:
-                        # Validate SOP
-                        if bytes(self.sop) != Packet.EXPECTED_SOP:
-                            self.reset()
-                            return PacketStatus.ERROR_INVALID_ID
-                        # Transition to next state
-                        self.state = self.State.PACKET_TYPE
+                # Process SOP bytes, each checked as it arrives like the C receiver
+                self.sop[len(self.buffer) - 1] = byte
+
+                if len(self.buffer) == 1:
+                    if byte != Packet.EXPECTED_SOP[0]:
+                        self.reset()
+                        return PacketStatus.ERROR_INVALID_ID
+                else:
+                    if byte != Packet.EXPECTED_SOP[1]:
+                        self.reset()
+
+                        # A repeated first SOP byte may still start the next packet
+                        if byte == Packet.EXPECTED_SOP[0]:
+                            self.buffer.append(byte)
+                            self.sop[0] = byte
+                        return PacketStatus.ERROR_INVALID_ID
+                    # Transition to next state
+                    self.state = self.State.PACKET_TYPE
 
             case self.State.PACKET_TYPE:
                 # Process packet type bytes
@@ -265,6 +287,17 @@ class PacketDecoder:
 
         # Process bytes until end, error, or complete packet
         while pos < len(buffer):
+            if self.state == self.State.COMPLETE:
+                # This byte is part of a new packet
+                self.reset()
+
+            # Skip a run of bytes that cannot start a packet in one step, as
+            # the C receiver does
+            if self.state == self.State.SOP and not self.buffer and not self._sop_at(buffer, pos):
+                pos = self._find_sop(buffer, pos + 1)
+                status = PacketStatus.ERROR_INVALID_ID
+                break
+
             status = self.receive_byte(buffer[pos])
             pos += 1
 
@@ -274,6 +307,25 @@ class PacketDecoder:
 
         return status, pos
 
+    @staticmethod
+    def _sop_at(buffer: bytes, pos: int) -> bool:
+        """True when buffer holds a SOP at pos, or its first byte at the very end"""
+        return (buffer[pos] == Packet.EXPECTED_SOP[0] and
+                (pos + 1 == len(buffer) or buffer[pos + 1] == Packet.EXPECTED_SOP[1]))
+
+    @staticmethod
+    def _find_sop(buffer: bytes, pos: int) -> int:
+        """Position of the next SOP candidate from pos, or len(buffer)"""
+        if not isinstance(buffer, (bytes, bytearray)):
+            buffer = bytes(buffer)
+        found = buffer.find(Packet.EXPECTED_SOP, pos)
+        if found >= 0:
+            return found
+        last = len(buffer) - 1
+        if last >= pos and buffer[last] == Packet.EXPECTED_SOP[0]:
+            return last
+        return len(buffer)
+
     def get_packet(self) -> Optional[Packet]:
         """
         Get the completed packet if available
@@ -287,13 +339,138 @@ class PacketDecoder:
         # Create and populate a new packet
         packet = Packet()
         packet.sop = bytes(self.sop)
-        packet.packet_type = self.packet_type.to_bytes(2, 'big')
+        packet.packet_type = (self.packet_type[0] << 8) | self.packet_type[1]
         packet.count = (self.count_bytes[0] << 8) | self.count_bytes[1]
         packet.payload = bytes(self.payload)
 
         return packet
 
 
+class _CPacketDecoder:
+    """PacketDecoder with the same interface, backed by the C receiver"""
+
+    def __init__(self):
+        """Initialize the packet decoder"""
+        self._decoder = _pakit.Decoder(Packet.MAX_PAYLOAD_SIZE)
+
+    def reset(self):
+        """Reset the decoder state to initial values"""
+        self._decoder.reset()
+
+    def receive_byte(self, byte: int) -> PacketStatus:
+        """
+        Process a single byte of incoming data
+
+        Args:
+            byte: The byte to process (0-255)
+
+        Returns:
+            PacketStatus indicating processing result
+        """
+        if not isinstance(byte, int) or byte < 0 or byte > 255:
+            return PacketStatus.ERROR_NULL_PARAM
+        return PacketStatus(self._decoder.receive_byte(byte))
+
+    def receive_buffer(self,
+                      buffer: bytes,
+                      start_pos: int = 0) -> Tuple[PacketStatus, int]:
+        """
+        Process a buffer of incoming data
+
+        Args:
+            buffer: Bytes to process
+            start_pos: Starting position in buffer
+
+        Returns:
+            Tuple of (status, end_position)
+        """
+        if not buffer:
+            return PacketStatus.ERROR_NULL_PARAM, start_pos
+
+        status, pos = self._decoder.receive_buffer(buffer, start_pos)
+        return PacketStatus(status), pos
+
+    def get_packet(self) -> Optional[Packet]:
+        """
+        Get the completed packet if available
+
+        Returns:
+            Packet object or None if no complete packet
+        """
+        fields = self._decoder.packet()
+        if fields is None:
+            return None
+        return Packet(*fields)
+
+    def feed(self, buffer: bytes) -> List[Packet]:
+        """
+        Decode every packet completed by buffer; packets may span calls
+
+        Args:
+            buffer: Bytes to process
+
+        Returns:
+            List of completed packets
+        """
+        return [Packet(*fields) for fields in self._decoder.feed(buffer)]
+
+
+# Prefer the C core; the pure Python decoder stays available as _PyPacketDecoder
+_PyPacketDecoder = PacketDecoder
+if _pakit is not None:
+    PacketDecoder = _CPacketDecoder
+
+
+# Layout of the records returned by decode_records (the C PakitIndexEntry)
+RECORD_FORMAT = "=QHHHH"
+RECORD_DTYPE = None
+if numpy is not None:
+    RECORD_DTYPE = numpy.dtype([("offset", "=u8"), ("type", "=u2"), ("count", "=u2"),
+                                ("size", "=u2"), ("reserved", "=u2")])
+
+
+def decode_records(data, max_payload_size: int = Packet.MAX_PAYLOAD_SIZE,
+                   threads: int = 0):
+    """
+    Decode every packet of an in-memory capture in one call
+
+    Parsing runs in C on several threads with the GIL released. Pass a bytes,
+    bytearray, memoryview or mmap object; nothing is copied.
+
+    Args:
+        data: Buffer holding the capture
+        max_payload_size: Largest payload accepted
+        threads: Worker threads, 0 for the number of CPUs
+
+    Returns:
+        Tuple of (records, end). records is a NumPy structured array with
+        RECORD_DTYPE fields (offset, type, count, size) when NumPy is installed,
+        otherwise a list of (offset, type, count, size, reserved) tuples; end is
+        the offset just past the last packet.
+    """
+    if _pakit is None:
+        raise RuntimeError("decode_records needs the _pakit extension (python setup.py build_ext)")
+
+    raw, end = _pakit.decode(data, max_payload_size, threads)
+    if numpy is not None:
+        return numpy.frombuffer(raw, dtype=RECORD_DTYPE), end
+    return list(struct.iter_unpack(RECORD_FORMAT, raw)), end
+
+
+def iter_payloads(data, records) -> Iterator[memoryview]:
+    """
+    Yield each record's payload as a memoryview into data, without copying
+
+    Args:
+        data: The buffer given to decode_records
+        records: Records returned by decode_records
+    """
+    view = memoryview(data)
+    for record in records:
+        start = int(record[0]) + Packet.HEADER_SIZE
+        yield view[start:start + int(record[3])]
+
+
 class PacketEncoder:
     """Class for encoding packets to bytes"""
 
@@ -315,6 +492,11 @@ class PacketEncoder:
         if not packet:
             return bytes()
 
+        if _pakit is not None:
+            if packet.size > Packet.MAX_PAYLOAD_SIZE:
+                raise ValueError(f"Payload size {packet.size} exceeds maximum {Packet.MAX_PAYLOAD_SIZE}")
+            return _pakit.encode(packet.packet_type, packet.count, packet.payload)
+
         # Prepare payload
         payload = packet.payload  # Now using the payload property getter
         payload_size = len(payload)
@@ -328,8 +510,8 @@ class PacketEncoder:
         # SOP (Start of Packet)
         result.extend(Packet.EXPECTED_SOP)
 
-        # Packet type
-        result.extend(packet.packet_type)
+        # Packet type (big endian)
+        result.extend(packet.packet_type.to_bytes(2, 'big'))
 
         # Count (16-bit, big endian)
         result.append((packet.count >> 8) & 0xFF)  # MSB
@@ -0,0 +1,26 @@
+# Builds the _pakit extension from the library sources:
+#   python setup.py build_ext --inplace
+import glob
+import os
+
+from setuptools import Extension, setup
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.relpath(os.path.join(HERE, ".."), HERE)
+
+sources = ["_pakit.c"] + sorted(glob.glob(os.path.join(ROOT, "src", "*.c")))
+
+setup(
+    name="pakit",
+    version="0.0.1",
+    py_modules=["pakit"],
+    ext_modules=[
+        Extension(
+            "_pakit",
+            sources=sources,
+            include_dirs=[os.path.join(ROOT, "include"), os.path.join(ROOT, "src")],
+            extra_compile_args=["-std=c11", "-O2", "-pthread"],
+            extra_link_args=["-pthread"],
+        )
+    ],
+)
@@ -0,0 +1,139 @@
+# Tests of the Python bindings:
+#   python setup.py build_ext --inplace && python -m unittest test_pakit
+# The _pakit tests are skipped when the extension has not been built.
+import os
+import random
+import sys
+import threading
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+import pakit  # noqa: E402
+from pakit import Packet, PacketEncoder, PacketStatus  # noqa: E402
+
+
+def encode(packet_type: int, count: int, payload: bytes) -> bytes:
+    """Wire bytes of one packet, built without the encoder under test"""
+    size = len(payload)
+    return (Packet.EXPECTED_SOP + bytes([packet_type >> 8, packet_type & 0xFF, count >> 8, count & 0xFF,
+                                         size >> 8, size & 0xFF]) + payload)
+
+
+def noisy_stream(rng: random.Random, packets: int) -> bytes:
+    """Packets separated by junk, with stray and repeated SOP bytes and truncated headers"""
+    out = bytearray()
+    for count in range(packets):
+        choice = rng.randrange(6)
+        if choice == 0:
+            out += bytes(rng.randrange(256) for _ in range(rng.randrange(1, 12)))
+        elif choice == 1:
+            out += bytes([0xB0, 0xB0])
+        elif choice == 2:
+            out += encode(rng.randrange(0x10000), count, b"")[:rng.randrange(1, Packet.HEADER_SIZE)]
+        elif choice == 3:
+            # Oversized payload
+            out += Packet.EXPECTED_SOP + bytes([0, 1, 0, 0, 0xFF, 0xFF])
+        size = rng.choice([0, 1, 7, 64, 300])
+        out += encode(rng.randrange(0x10000), count, bytes(rng.randrange(256) for _ in range(size)))
+    return bytes(out)
+
+
+def run_buffer(decoder, stream: bytes, chunk: int):
+    """(status, position, packet) after every receive_buffer call over chunks of stream"""
+    results = []
+    for start in range(0, len(stream), chunk):
+        piece = stream[start:start + chunk]
+        pos = 0
+        while pos < len(piece):
+            status, pos = decoder.receive_buffer(piece, pos)
+            packet = decoder.get_packet() if status == PacketStatus.SUCCESS else None
+            results.append((status, start + pos, packet and (packet.packet_type, packet.count, packet.payload)))
+    return results
+
+
+def run_bytes(decoder, stream: bytes):
+    results = []
+    for byte in stream:
+        status = decoder.receive_byte(byte)
+        packet = decoder.get_packet() if status == PacketStatus.SUCCESS else None
+        results.append((status, packet and (packet.packet_type, packet.count, packet.payload)))
+    return results
+
+
+class PurePythonTest(unittest.TestCase):
+    def test_round_trip(self):
+        stream = b"\x00\x01" + encode(0x0102, 7, b"hello") + b"\xB0"
+        decoder = pakit._PyPacketDecoder()
+        results = run_buffer(decoder, stream, len(stream))
+        self.assertEqual(results[0][:2], (PacketStatus.ERROR_INVALID_ID, 2))
+        self.assertEqual(results[1], (PacketStatus.SUCCESS, 15, (0x0102, 7, b"hello")))
+        self.assertEqual(results[2][:2], (PacketStatus.IN_PROGRESS, 16))
+
+
+@unittest.skipIf(pakit._pakit is None, "_pakit extension not built")
+class ExtensionTest(unittest.TestCase):
+    def test_decode_records(self):
+        payloads = [b"", b"a", bytes(range(200))]
+        stream = b"junk" + b"".join(encode(0x0300 + i, 10 + i, p) for i, p in enumerate(payloads)) + b"\xB0\xB2\x00"
+        records, end = pakit.decode_records(stream, threads=2)
+        rows = [(int(r[0]), int(r[1]), int(r[2]), int(r[3])) for r in records]
+        self.assertEqual(rows, [(4, 0x0300, 10, 0), (12, 0x0301, 11, 1), (21, 0x0302, 12, 200)])
+        self.assertEqual(end, 21 + Packet.HEADER_SIZE + 200)
+
+        # Threads do not change the result on a large noisy capture
+        stream = noisy_stream(random.Random(5), 2000)
+        single, single_end = pakit.decode_records(stream, threads=1)
+        multi, multi_end = pakit.decode_records(stream, threads=4)
+        self.assertEqual([tuple(r) for r in single], [tuple(r) for r in multi])
+        self.assertEqual(single_end, multi_end)
+
+    def test_feed_across_calls(self):
+        stream = b"".join(encode(1, i, bytes([i]) * (i * 5)) for i in range(20))
+        expected = [(1, i, bytes([i]) * (i * 5)) for i in range(20)]
+        for split in range(1, len(stream), 37):
+            decoder = pakit._CPacketDecoder()
+            packets = decoder.feed(stream[:split]) + decoder.feed(stream[split:])
+            self.assertEqual([(p.packet_type, p.count, p.payload) for p in packets], expected)
+
+        # One byte at a time
+        decoder = pakit._CPacketDecoder()
+        packets = []
+        for i in range(len(stream)):
+            packets += decoder.feed(stream[i:i + 1])
+        self.assertEqual([(p.packet_type, p.count, p.payload) for p in packets], expected)
+
+    def test_feed_from_threads(self):
+        # Whole packets per call, so any interleaving delivers all of them
+        chunk = b"".join(encode(2, i, bytes(100)) for i in range(50))
+        decoder = pakit._CPacketDecoder()
+        delivered = []
+
+        def worker():
+            for _ in range(40):
+                delivered.append(len(decoder.feed(chunk)))
+
+        threads = [threading.Thread(target=worker) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(sum(delivered), 4 * 40 * 50)
+
+    def test_matches_pure_python(self):
+        rng = random.Random(1)
+        for _ in range(20):
+            stream = noisy_stream(rng, 40)
+            for chunk in (1, 3, 8, 64, len(stream)):
+                self.assertEqual(run_buffer(pakit._CPacketDecoder(), stream, chunk),
+                                 run_buffer(pakit._PyPacketDecoder(), stream, chunk))
+            self.assertEqual(run_bytes(pakit._CPacketDecoder(), stream),
+                             run_bytes(pakit._PyPacketDecoder(), stream))
+
+    def test_encoder_matches(self):
+        packet = Packet(0xBEEF, 3, b"payload")
+        self.assertEqual(PacketEncoder().encode(packet), encode(0xBEEF, 3, b"payload"))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <string.h>
 #include "pakit.h"
+#include "pakit_sequence.h"
 
 
 // Helper function to print a packet's contents
@@ -43,7 +44,7 @@ void process_byte_stream() {
     // Create and initialize the packet receiver
     PakitReceiver receiver;
 
-    pakit_create(&receiver);
+    pakit_create(&receiver, NULL, 0);
 
     // Example packet: 0xB0B2 + type 0x0103 + count 0x0001 + size 0x0005 + payload "Hello"
     uint8_t packet_bytes[] = {
@@ -120,7 +121,7 @@ void process_buffer() {
     PakitReceiver receiver_inst;
     PakitReceiver *receiver = &receiver_inst;
 
-    pakit_create(receiver);
+    pakit_create(receiver, NULL, 0);
 
     // Example packet with binary payload and count field
     uint8_t binary_packet[] = {
@@ -171,7 +172,13 @@ void process_multiple_packets_in_buffer() {
     PakitReceiver receiver_inst;
     PakitReceiver *receiver = &receiver_inst;
 
-    pakit_create(receiver);
+    pakit_create(receiver, NULL, 0);
+
+    // Track one sequence across all packet types
+    PakitSequenceEntry sequence_entry;
+    PakitSequenceTracker sequence;
+    pakit_sequence_init(&sequence, &sequence_entry, 1, false);
+    pakit_set_sequence(receiver, &sequence);
 
     // Create packets using pakit_packet_create
     Packet packet1, packet2, packet3;
@@ -195,8 +202,6 @@ void process_multiple_packets_in_buffer() {
 
     size_t position = 0;
     int packet_count = 0;
-    uint16_t last_count = 0;
-    bool first_packet = true;
 
     printf("Processing buffer with multiple packets...\n");
 
@@ -215,14 +220,12 @@ void process_multiple_packets_in_buffer() {
                 printf("\nPacket #%d at position %zu:\n", packet_count, position);
                 print_packet(&packet);
 
-                // Check for dropped packets using the count field
-                if (!first_packet && packet.count > last_count + 1) {
+                // The receiver checked the count field against the previous packet
+                if (sequence.last_event == PAKIT_SEQUENCE_GAP) {
                     printf("  WARNING: Possible dropped packet(s) detected!\n");
-                    printf("  Expected count %d but received %d\n", last_count + 1, packet.count);
+                    printf("  Expected count %d but received %d\n",
+                           (uint16_t)(packet.count - sequence.last_gap), packet.count);
                 }
-
-                last_count = packet.count;
-                first_packet = false;
             }
 
             // Reset for next packet
@@ -240,7 +243,8 @@ void process_multiple_packets_in_buffer() {
         }
     }
 
-    printf("\nFound %d packets in the buffer\n", packet_count);
+    printf("\nFound %d packets in the buffer, %llu lost\n", packet_count,
+           (unsigned long long)sequence.stats.lost);
 
     // Cleanup
     pakit_destroy(receiver);
@@ -254,7 +258,7 @@ void process_invalid_data() {
     PakitReceiver receiver_inst;
     PakitReceiver *receiver = &receiver_inst;
 
-    pakit_create(receiver);
+    pakit_create(receiver, NULL, 0);
 
     // Invalid packet (wrong SOP)
     uint8_t invalid_packet[] = {
@@ -2,39 +2,342 @@
 #include <stdlib.h>
 #include <string.h>
 #include "pakit.h"
+#include "pakit_internal.h"
+#ifndef PAKIT_MINIMAL
+#include "pakit_filter.h"
+#include "pakit_sequence.h"
+#include "pakit_stream.h"
+#include "pakit_timing.h"
+#endif
 
 
-void pakit_create(PakitReceiver* receiver) {
-    if (receiver != NULL) {
-        pakit_init(receiver);
+PakitStatus pakit_create(PakitReceiver* receiver, uint8_t* storage, size_t storage_size) {
+    if (receiver == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
     }
+
+    // The size field cannot describe anything larger
+    if (storage_size > PAKIT_MAX_PAYLOAD_LIMIT) {
+        storage_size = PAKIT_MAX_PAYLOAD_LIMIT;
+    }
+
+    receiver->owns_storage = false;
+    receiver->crc_enabled = false;
+#ifndef PAKIT_MINIMAL
+    receiver->sequence = NULL;
+    receiver->handlers = NULL;
+    receiver->stream = NULL;
+    receiver->pooled = NULL;
+    receiver->timing = NULL;
+    receiver->filter = NULL;
+#endif
+    if (storage == NULL) {
+        if (storage_size == 0) {
+            storage_size = MAX_PACKET_SIZE;
+        }
+        storage = malloc(storage_size);
+        if (storage == NULL) {
+            receiver->payload = NULL;
+            receiver->max_payload_size = 0;
+            pakit_init(receiver);
+            return PAKIT_STATUS_ERROR_NO_MEMORY;
+        }
+        receiver->owns_storage = true;
+    }
+
+    receiver->payload = storage;
+    receiver->max_payload_size = (uint16_t)storage_size;
+    pakit_clear(receiver);
+    pakit_reset_stats(receiver);
+
+    return PAKIT_STATUS_SUCCESS;
 }
 
 void pakit_destroy(PakitReceiver* receiver) {
-    (void)receiver;  // Suppress unused parameter warning
+    if (receiver == NULL) {
+        return;
+    }
+
+#ifndef PAKIT_MINIMAL
+    pakit_dispatch_release(receiver);
+    pakit_packet_pool_release(receiver);
+#endif
+    if (receiver->owns_storage) {
+        free(receiver->payload);
+        receiver->payload = NULL;
+        receiver->max_payload_size = 0;
+        receiver->owns_storage = false;
+    }
 }
 
 void pakit_init(PakitReceiver* receiver) {
-    memset(receiver, 0, sizeof(PakitReceiver));
+    // Only the parse state is reset; stale packet bytes are overwritten as new ones arrive
     receiver->received_bytes = 0;
-    receiver->header_complete = false;
     receiver->state = STATE_UNIQUE_SOP;
     receiver->expected_payload_size = 0;
+    receiver->crc = 0;
+    receiver->crc_trailer = 0;
 }
 
-PakitStatus pakit_receive_byte(PakitReceiver* receiver, uint8_t byte) {
-    // Check for null parameter
-    if (receiver == NULL) {
-        return PAKIT_STATUS_ERROR_NULL_PARAM;
+void pakit_clear(PakitReceiver* receiver) {
+    memset(&receiver->header, 0, sizeof(receiver->header));
+    if (receiver->payload != NULL) {
+        memset(receiver->payload, 0, receiver->max_payload_size);
+    }
+    pakit_init(receiver);
+}
+
+void pakit_set_crc(PakitReceiver* receiver, bool enabled) {
+    if (receiver != NULL) {
+        receiver->crc_enabled = enabled;
+        pakit_init(receiver);
+    }
+}
+
+// Size of the trailer the receiver expects after each payload
+static size_t pakit_trailer_size(const PakitReceiver* receiver) {
+    return receiver->crc_enabled ? PAKIT_CRC_SIZE : 0;
+}
+
+// True when payloads go to an attached stream instead of the storage
+static inline bool pakit_streaming(const PakitReceiver* receiver) {
+#ifndef PAKIT_MINIMAL
+    return receiver->stream != NULL;
+#else
+    (void)receiver;
+    return false;
+#endif
+}
+
+// Largest payload the receiver accepts; a stream needs no payload storage
+static uint16_t pakit_payload_limit(const PakitReceiver* receiver) {
+#ifndef PAKIT_MINIMAL
+    if (receiver->stream != NULL) {
+        return receiver->stream->max_payload_size;
+    }
+#endif
+    return receiver->max_payload_size;
+}
+
+#ifndef PAKIT_MINIMAL
+// Hands the received header to the attached stream
+static void pakit_stream_header(const PakitReceiver* receiver) {
+    const PakitStream* stream = receiver->stream;
+    if (stream->on_header != NULL) {
+        uint64_t word = pakit_header_word((const uint8_t*)&receiver->header);
+        PakitView header;
+        header.type = (uint16_t)(word >> 32);
+        header.count = (uint16_t)(word >> 16);
+        header.size = receiver->expected_payload_size;
+        header.payload = NULL;
+        stream->on_header(stream->context, &header);
+    }
+}
+
+// Hands payload bytes to the attached stream; received_bytes is still their start
+static void pakit_stream_chunk(const PakitReceiver* receiver, const uint8_t* data, size_t length) {
+    const PakitStream* stream = receiver->stream;
+    if (stream->on_chunk != NULL) {
+        stream->on_chunk(stream->context, receiver->received_bytes - HEADER_SIZE, data, length);
+    }
+}
+
+static void pakit_stream_end(const PakitReceiver* receiver, PakitStatus status) {
+    const PakitStream* stream = receiver->stream;
+    if (stream != NULL && stream->on_end != NULL) {
+        stream->on_end(stream->context, status);
+    }
+}
+#else
+// Never called without streams; pakit_streaming is constant false
+#define pakit_stream_header(receiver) ((void)(receiver))
+#define pakit_stream_chunk(receiver, data, length) ((void)(receiver))
+#define pakit_stream_end(receiver, status) ((void)(receiver))
+#endif
+
+// Instrumentation hooks of the receive paths. Apart from the timing block check
+// they compile to nothing unless PAKIT_ENABLE_STATS or PAKIT_ENABLE_PROBES is defined.
+#ifdef PAKIT_ENABLE_STATS
+static inline void pakit_stat_add(_Atomic uint64_t* counter, uint64_t amount) {
+    // Only the receiving thread writes, so a relaxed load and store is enough
+    // and avoids a locked read-modify-write
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + amount,
+                          memory_order_relaxed);
+}
+#endif
+
+static inline void pakit_note_input(PakitReceiver* receiver, size_t bytes) {
+#ifdef PAKIT_ENABLE_STATS
+    pakit_stat_add(&receiver->stats.bytes_in, bytes);
+#endif
+    (void)receiver;
+    (void)bytes;
+}
+
+// The first byte of a packet that may span reads has been taken
+static inline void pakit_note_start(PakitReceiver* receiver) {
+#ifdef PAKIT_ENABLE_STATS
+    receiver->stats.packet_start_ns = pakit_stats_now_ns();
+#endif
+#ifndef PAKIT_MINIMAL
+    if (receiver->timing != NULL) {
+        receiver->timing->first_byte_ns = receiver->timing->now_ns;
+    }
+#endif
+    (void)receiver;
+}
+
+static inline void pakit_note_complete(PakitReceiver* receiver, uint16_t type, uint16_t size,
+                                       bool buffered) {
+#ifdef PAKIT_ENABLE_STATS
+    pakit_stat_add(&receiver->stats.packets_out, 1);
+
+    // Packets decoded in place complete within a single call
+    if (buffered) {
+        uint64_t elapsed = pakit_stats_now_ns() - receiver->stats.packet_start_ns;
+        if (elapsed > atomic_load_explicit(&receiver->stats.max_complete_ns, memory_order_relaxed)) {
+            atomic_store_explicit(&receiver->stats.max_complete_ns, elapsed, memory_order_relaxed);
+        }
+    }
+#endif
+#ifndef PAKIT_MINIMAL
+    if (receiver->timing != NULL) {
+        pakit_timing_complete(receiver->timing, buffered);
+    }
+#endif
+    PAKIT_PROBE_COMPLETE(receiver, type, size);
+    (void)receiver;
+    (void)type;
+    (void)size;
+    (void)buffered;
+}
+
+static inline void pakit_note_error(PakitReceiver* receiver, PakitStatus status, size_t dropped) {
+#ifdef PAKIT_ENABLE_STATS
+    PakitStatsCounters* stats = &receiver->stats;
+    switch (status) {
+        case PAKIT_STATUS_ERROR_INVALID_SOP:
+            pakit_stat_add(&stats->dropped_invalid_sop, dropped);
+            break;
+        case PAKIT_STATUS_ERROR_SIZE_LARGE:
+            pakit_stat_add(&stats->dropped_size_large, dropped);
+            break;
+        case PAKIT_STATUS_ERROR_OVERFLOW:
+            pakit_stat_add(&stats->dropped_overflow, dropped);
+            break;
+        case PAKIT_STATUS_ERROR_CRC:
+            pakit_stat_add(&stats->dropped_crc, dropped);
+            break;
+        default:
+            return;
+    }
+    pakit_stat_add(&stats->resyncs, 1);
+#endif
+    PAKIT_PROBE_ERROR(receiver, status, dropped);
+    (void)receiver;
+    (void)status;
+    (void)dropped;
+}
+
+static inline void pakit_note_filtered(PakitReceiver* receiver, size_t bytes) {
+#ifdef PAKIT_ENABLE_STATS
+    pakit_stat_add(&receiver->stats.filtered, bytes);
+#endif
+    (void)receiver;
+    (void)bytes;
+}
+
+// True when packets of type are delivered; everything is without a filter
+static inline bool pakit_type_wanted(const PakitReceiver* receiver, uint16_t type) {
+#ifndef PAKIT_MINIMAL
+    return receiver->filter == NULL || pakit_filter_accepts(receiver->filter, type);
+#else
+    (void)receiver;
+    (void)type;
+    return true;
+#endif
+}
+
+// Bytes of the packet being received, header and trailer included
+static size_t pakit_frame_size(const PakitReceiver* receiver) {
+    return HEADER_SIZE + (size_t)receiver->expected_payload_size + pakit_trailer_size(receiver);
+}
+
+// Goes back to hunting for a SOP once a filtered packet has been stepped over
+static void pakit_skip_check(PakitReceiver* receiver) {
+    if (receiver->received_bytes == pakit_frame_size(receiver)) {
+        pakit_note_filtered(receiver, receiver->received_bytes);
+        pakit_init(receiver);
+    }
+}
+
+// Feeds a completed packet to the receiver's sequence tracker, if any
+static void pakit_track_sequence(const PakitReceiver* receiver, uint16_t type, uint16_t count) {
+#ifndef PAKIT_MINIMAL
+    if (receiver->sequence != NULL) {
+        pakit_sequence_update(receiver->sequence, type, count);
+    }
+#endif
+    (void)receiver;
+    (void)type;
+    (void)count;
+}
+
+// Marks the packet in the receiver as complete
+static PakitStatus pakit_packet_done(PakitReceiver* receiver) {
+    uint64_t word = pakit_header_word((const uint8_t*)&receiver->header);
+    uint16_t type = (uint16_t)(word >> 32);
+
+    receiver->state = STATE_COMPLETE;
+    pakit_stream_end(receiver, PAKIT_STATUS_SUCCESS);
+    pakit_track_sequence(receiver, type, (uint16_t)(word >> 16));
+    pakit_note_complete(receiver, type, receiver->expected_payload_size, true);
+    return PAKIT_STATUS_SUCCESS;
+}
+
+// Moves on from a fully received payload: to the trailer in CRC mode,
+// otherwise straight to a complete packet
+static PakitStatus pakit_payload_done(PakitReceiver* receiver) {
+    if (receiver->crc_enabled) {
+        receiver->state = STATE_CRC;
+        return PAKIT_STATUS_IN_PROGRESS;
+    }
+
+    return pakit_packet_done(receiver);
+}
+
+// Runs one byte through the state machine (pakit_receive_byte without the
+// NULL check and instrumentation)
+static PakitStatus pakit_process_byte(PakitReceiver* receiver, uint8_t byte) {
+    // This byte is part of a new packet
+    if (receiver->state == STATE_COMPLETE) {
+        pakit_init(receiver);
     }
 
     // Check for buffer overflow
-    if (receiver->received_bytes >= HEADER_SIZE + MAX_PACKET_SIZE) {
+    if (receiver->received_bytes >=
+        HEADER_SIZE + (size_t)pakit_payload_limit(receiver) + pakit_trailer_size(receiver)) {
         return PAKIT_STATUS_ERROR_OVERFLOW;
     }
 
-    // Store the byte in the buffer
-    receiver->packet.buffer[receiver->received_bytes++] = byte;
+    // Store the byte in the header, the payload storage or the CRC trailer
+    if (receiver->received_bytes < HEADER_SIZE) {
+        ((uint8_t*)&receiver->header)[receiver->received_bytes] = byte;
+    } else if (receiver->state == STATE_SKIP) {
+        // Filtered packet: nothing is kept
+    } else if (receiver->state == STATE_CRC) {
+        receiver->crc_trailer = (receiver->crc_trailer << 8) | byte;
+    } else {
+        if (pakit_streaming(receiver)) {
+            pakit_stream_chunk(receiver, &byte, 1);
+        } else {
+            receiver->payload[receiver->received_bytes - HEADER_SIZE] = byte;
+        }
+        if (receiver->crc_enabled) {
+            receiver->crc = pakit_crc32c(receiver->crc, &byte, 1);
+        }
+    }
+    receiver->received_bytes++;
 
     // Process the byte based on current state
     switch (receiver->state) {
@@ -42,16 +345,23 @@ PakitStatus pakit_receive_byte(PakitReceiver* receiver, uint8_t byte) {
             // Process bytes for the unique SOP
             if (receiver->received_bytes == 1) {
                 // Validate unique SOP
-                if (receiver->packet.fields.header.sop[0] != EXPECTED_SOP_0) {
+                if (receiver->header.sop[0] != EXPECTED_SOP_0) {
                     pakit_init(receiver);
                     return PAKIT_STATUS_ERROR_INVALID_SOP;
                 }
+                pakit_note_start(receiver);
             }
             if (receiver->received_bytes == 2) {
                 // Validate unique SOP
-                if (receiver->packet.fields.header.sop[0] != EXPECTED_SOP_0 ||
-                    receiver->packet.fields.header.sop[1] != EXPECTED_SOP_1) {
+                if (receiver->header.sop[1] != EXPECTED_SOP_1) {
                     pakit_init(receiver);
+
+                    // A repeated first SOP byte may still start the next packet
+                    if (byte == EXPECTED_SOP_0) {
+                        receiver->header.sop[0] = byte;
+                        receiver->received_bytes = 1;
+                        pakit_note_start(receiver);
+                    }
                     return PAKIT_STATUS_ERROR_INVALID_SOP;
                 }
                 // Transition to next state
@@ -78,26 +388,37 @@ PakitStatus pakit_receive_byte(PakitReceiver* receiver, uint8_t byte) {
         case STATE_SIZE:
             // Process bytes for the size field
             if (receiver->received_bytes == HEADER_SIZE) {  // HEADER_SIZE includes SOP, type, count, and size fields
-                // Calculate payload size (MSB first)
-                receiver->expected_payload_size = ((uint16_t)receiver->packet.fields.header.size_bytes[0] << 8) |
-                                                 receiver->packet.fields.header.size_bytes[1];
+                // Decode type and payload size from the whole header at once
+                uint64_t word = pakit_header_word((const uint8_t*)&receiver->header);
+                receiver->expected_payload_size = (uint16_t)word;
 
                 // Validate payload size
-                if (receiver->expected_payload_size > MAX_PACKET_SIZE) {
+                if (receiver->expected_payload_size > pakit_payload_limit(receiver)) {
                     pakit_init(receiver);
                     return PAKIT_STATUS_ERROR_SIZE_LARGE;
                 }
 
+                // Step over packets of unwanted types without storing them
+                if (!pakit_type_wanted(receiver, (uint16_t)(word >> 32))) {
+                    receiver->state = STATE_SKIP;
+                    pakit_skip_check(receiver);
+                    break;
+                }
+
                 // Header is now complete
-                receiver->header_complete = true;
+                if (receiver->crc_enabled) {
+                    receiver->crc = pakit_crc32c(0, (const uint8_t*)&receiver->header, HEADER_SIZE);
+                }
+                if (pakit_streaming(receiver)) {
+                    pakit_stream_header(receiver);
+                }
 
                 // Transition to payload state
                 receiver->state = STATE_PAYLOAD;
 
                 // Special case: zero-length payload
                 if (receiver->expected_payload_size == 0) {
-                    receiver->state = STATE_COMPLETE;
-                    return PAKIT_STATUS_SUCCESS;
+                    return pakit_payload_done(receiver);
                 }
             }
             break;
@@ -105,53 +426,148 @@ PakitStatus pakit_receive_byte(PakitReceiver* receiver, uint8_t byte) {
         case STATE_PAYLOAD:
             // Process payload bytes
             // Check if we have received all expected payload bytes
-            if (receiver->received_bytes >= HEADER_SIZE + receiver->expected_payload_size) {
-                receiver->state = STATE_COMPLETE;
-                return PAKIT_STATUS_SUCCESS;
+            if (receiver->received_bytes >= HEADER_SIZE + (size_t)receiver->expected_payload_size) {
+                return pakit_payload_done(receiver);
             }
             break;
 
-        case STATE_COMPLETE:
-            // This byte is part of a new packet
-            // Reset the receiver and process this byte as the start of a new packet
-            {
-                uint8_t saved_byte = byte;
-                pakit_init(receiver);
-                return pakit_receive_byte(receiver, saved_byte);
+        case STATE_CRC:
+            // Check the trailer once all of it has arrived
+            if (receiver->received_bytes ==
+                HEADER_SIZE + (size_t)receiver->expected_payload_size + PAKIT_CRC_SIZE) {
+                if (receiver->crc_trailer != receiver->crc) {
+                    pakit_stream_end(receiver, PAKIT_STATUS_ERROR_CRC);
+                    pakit_init(receiver);
+                    return PAKIT_STATUS_ERROR_CRC;
+                }
+                return pakit_packet_done(receiver);
             }
             break;
+
+        case STATE_SKIP:
+            pakit_skip_check(receiver);
+            break;
+
+        case STATE_COMPLETE:
+            // Handled before the byte is stored
+            break;
     }
 
     return PAKIT_STATUS_IN_PROGRESS;
 }
 
-bool pakit_is_packet_complete(PakitReceiver* receiver, Packet* packet) {
-    if (!receiver->header_complete) {
-        return false;
+PakitStatus pakit_receive_byte(PakitReceiver* receiver, uint8_t byte) {
+    // Check for null parameter
+    if (receiver == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    size_t held = (receiver->state == STATE_COMPLETE) ? 0 : receiver->received_bytes;
+    PakitStatus status = pakit_process_byte(receiver, byte);
+
+    pakit_note_input(receiver, 1);
+    if (status > PAKIT_STATUS_IN_PROGRESS) {
+        pakit_note_error(receiver, status, held + 1 - receiver->received_bytes);
     }
 
-    // Calculate payload size
-    uint16_t size = ((uint16_t)receiver->packet.fields.header.size_bytes[0] << 8) |
-                    receiver->packet.fields.header.size_bytes[1];
+    return status;
+}
 
-    if (receiver->received_bytes < HEADER_SIZE + size) {
+bool pakit_is_packet_complete(PakitReceiver* receiver, Packet* packet) {
+    // Payload and, in CRC mode, a checked trailer are in; the size was decoded
+    // with the header
+    if (receiver->state != STATE_COMPLETE) {
         return false;
     }
 
     if (packet != NULL) {
         // Copy data to output packet
-        memcpy(packet->sop, receiver->packet.fields.header.sop, PACKET_SOP_SIZE);
-        memcpy(packet->type, receiver->packet.fields.header.type, PACKET_TYPE_SIZE);
+        memcpy(packet->sop, receiver->header.sop, PACKET_SOP_SIZE);
+        memcpy(packet->type, receiver->header.type, PACKET_TYPE_SIZE);
+        packet->count = (uint16_t)(pakit_header_word((const uint8_t*)&receiver->header) >> 16);
+        packet->size = receiver->expected_payload_size;
+        packet->payload = pakit_streaming(receiver) ? NULL : receiver->payload;
+    }
 
-        // Extract the count field
-        packet->count = ((uint16_t)receiver->packet.fields.header.count_bytes[0] << 8) |
-                        receiver->packet.fields.header.count_bytes[1];
+    return true;
+}
+
+// True when data starts with a SOP, or with its first byte if that is all there is
+static bool pakit_sop_at(const uint8_t* data, size_t available) {
+    return data[0] == EXPECTED_SOP_0 && (available == 1 || data[1] == EXPECTED_SOP_1);
+}
 
-        packet->size = size;
-        packet->payload = receiver->packet.fields.payload;
+// Parses a complete header in one step when the receiver is idle, a SOP is at
+// data and at least HEADER_SIZE bytes are available. Mirrors the per-byte size
+// validation so the result and the number of consumed bytes match pakit_receive_byte.
+static PakitStatus pakit_receive_header_bulk(PakitReceiver* receiver,
+                                             const uint8_t* data,
+                                             size_t* consumed) {
+    *consumed = HEADER_SIZE;
+
+    // Calculate payload size (MSB first)
+    uint64_t word = pakit_header_word(data);
+    uint16_t payload_size = (uint16_t)word;
+
+    // Validate payload size
+    if (payload_size > pakit_payload_limit(receiver)) {
+        pakit_init(receiver);
+        return PAKIT_STATUS_ERROR_SIZE_LARGE;
     }
 
-    return true;
+    memcpy(&receiver->header, data, HEADER_SIZE);
+    receiver->received_bytes = HEADER_SIZE;
+    receiver->expected_payload_size = payload_size;
+
+    // Step over packets of unwanted types without storing them
+    if (!pakit_type_wanted(receiver, (uint16_t)(word >> 32))) {
+        receiver->state = STATE_SKIP;
+        pakit_skip_check(receiver);
+        return PAKIT_STATUS_IN_PROGRESS;
+    }
+
+    pakit_note_start(receiver);
+    if (receiver->crc_enabled) {
+        receiver->crc = pakit_crc32c(0, data, HEADER_SIZE);
+    }
+    if (pakit_streaming(receiver)) {
+        pakit_stream_header(receiver);
+    }
+
+    // Special case: zero-length payload
+    if (payload_size == 0) {
+        return pakit_payload_done(receiver);
+    }
+
+    receiver->state = STATE_PAYLOAD;
+    return PAKIT_STATUS_IN_PROGRESS;
+}
+
+// Copies as much of the outstanding payload as is available with one memcpy,
+// or passes it to the stream without copying
+static PakitStatus pakit_receive_payload_bulk(PakitReceiver* receiver,
+                                              const uint8_t* data,
+                                              size_t available,
+                                              size_t* consumed) {
+    size_t remaining = HEADER_SIZE + receiver->expected_payload_size - receiver->received_bytes;
+    size_t count = (available < remaining) ? available : remaining;
+
+    if (pakit_streaming(receiver)) {
+        pakit_stream_chunk(receiver, data, count);
+    } else {
+        memcpy(&receiver->payload[receiver->received_bytes - HEADER_SIZE], data, count);
+    }
+    if (receiver->crc_enabled) {
+        receiver->crc = pakit_crc32c(receiver->crc, data, count);
+    }
+    receiver->received_bytes += count;
+    *consumed = count;
+
+    if (count == remaining) {
+        return pakit_payload_done(receiver);
+    }
+
+    return PAKIT_STATUS_IN_PROGRESS;
 }
 
 PakitStatus pakit_receive_buffer(PakitReceiver* receiver, const uint8_t* buffer, size_t buffer_length, size_t* position) {
@@ -163,18 +579,53 @@ PakitStatus pakit_receive_buffer(PakitReceiver* receiver, const uint8_t* buffer,
     // Start from the current position in the buffer
     // If position is NULL, start from beginning (position 0)
     size_t current_pos = (position != NULL) ? *position : 0;
+    size_t start_pos = current_pos;
     PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
 
-    // Process bytes until we reach the end, get an error, or complete a packet
+    // Process bytes until we reach the end, get an error, or complete a packet.
+    // Whole headers and payload runs are taken in bulk; anything fragmented
+    // falls back to the per-byte state machine.
     while (current_pos < buffer_length) {
-        status = pakit_receive_byte(receiver, buffer[current_pos]);
-        current_pos++;
+        size_t available = buffer_length - current_pos;
+        size_t consumed = 1;
+
+        if (receiver->state == STATE_COMPLETE) {
+            // This byte is part of a new packet
+            pakit_init(receiver);
+        }
+        size_t held = receiver->received_bytes;
+
+        if (receiver->state == STATE_PAYLOAD) {
+            status = pakit_receive_payload_bulk(receiver, &buffer[current_pos], available, &consumed);
+        } else if (receiver->state == STATE_SKIP) {
+            // Advance over the rest of a filtered packet without reading it
+            size_t remaining = pakit_frame_size(receiver) - receiver->received_bytes;
+            consumed = (available < remaining) ? available : remaining;
+            receiver->received_bytes += consumed;
+            pakit_skip_check(receiver);
+            status = PAKIT_STATUS_IN_PROGRESS;
+        } else if (receiver->state == STATE_UNIQUE_SOP && receiver->received_bytes == 0 &&
+                   !pakit_sop_at(&buffer[current_pos], available)) {
+            // Jump straight to the next candidate SOP instead of failing byte by byte
+            consumed = pakit_find_sop(&buffer[current_pos], available);
+            status = PAKIT_STATUS_ERROR_INVALID_SOP;
+        } else if (receiver->state == STATE_UNIQUE_SOP && receiver->received_bytes == 0 &&
+                   available >= HEADER_SIZE) {
+            status = pakit_receive_header_bulk(receiver, &buffer[current_pos], &consumed);
+        } else {
+            status = pakit_process_byte(receiver, buffer[current_pos]);
+        }
+        current_pos += consumed;
 
         // Stop processing if we get an error or complete packet
         if (status != PAKIT_STATUS_IN_PROGRESS) {
+            if (status != PAKIT_STATUS_SUCCESS) {
+                pakit_note_error(receiver, status, held + consumed - receiver->received_bytes);
+            }
             break;
         }
     }
+    pakit_note_input(receiver, current_pos - start_pos);
 
     // Update the caller's position if pointer was provided
     if (position != NULL) {
@@ -184,6 +635,202 @@ PakitStatus pakit_receive_buffer(PakitReceiver* receiver, const uint8_t* buffer,
     return status;
 }
 
+PakitStatus pakit_parse_view(const uint8_t* buffer, size_t buffer_length,
+                             size_t* position, uint16_t max_payload_size,
+                             PakitView* view) {
+    size_t pos = *position;
+    if (pos >= buffer_length) {
+        return PAKIT_STATUS_IN_PROGRESS;
+    }
+
+    const uint8_t* data = &buffer[pos];
+    size_t available = buffer_length - pos;
+
+    // A truncated header can only be checked for its SOP
+    if (available < HEADER_SIZE) {
+        if (!pakit_sop_at(data, available)) {
+            *position = pos + pakit_find_sop(data, available);
+            return PAKIT_STATUS_ERROR_INVALID_SOP;
+        }
+        return PAKIT_STATUS_IN_PROGRESS;
+    }
+
+    // SOP, type, count and size from a single 64-bit load
+    uint64_t word = pakit_header_word(data);
+
+    // Validate unique SOP, skipping to the next candidate on a mismatch
+    if ((uint16_t)(word >> 48) != PAKIT_SOP_WORD) {
+        *position = pos + pakit_find_sop(data, available);
+        return PAKIT_STATUS_ERROR_INVALID_SOP;
+    }
+
+    // Validate payload size
+    uint16_t size = (uint16_t)word;
+    if (size > max_payload_size) {
+        *position = pos + HEADER_SIZE;
+        return PAKIT_STATUS_ERROR_SIZE_LARGE;
+    }
+    if (available - HEADER_SIZE < size) {
+        return PAKIT_STATUS_IN_PROGRESS;
+    }
+
+    view->type = (uint16_t)(word >> 32);
+    view->count = (uint16_t)(word >> 16);
+    view->size = size;
+    view->payload = &data[HEADER_SIZE];
+
+    *position = pos + HEADER_SIZE + size;
+    return PAKIT_STATUS_SUCCESS;
+}
+
+// Fills a view from the packet held in the receiver's buffer
+static void pakit_receiver_view(const PakitReceiver* receiver, PakitView* view) {
+    uint64_t word = pakit_header_word((const uint8_t*)&receiver->header);
+    view->type = (uint16_t)(word >> 32);
+    view->count = (uint16_t)(word >> 16);
+    view->size = receiver->expected_payload_size;
+    view->payload = pakit_streaming(receiver) ? NULL : receiver->payload;
+}
+
+// Decodes a packet in place for a receiver, checking its CRC trailer in CRC mode.
+// A mismatch consumes the whole packet, like the per-byte path does. Packets
+// rejected by the type filter are stepped over, unchecked, until one passes.
+static PakitStatus pakit_parse_receiver_view(PakitReceiver* receiver, const uint8_t* buffer,
+                                             size_t buffer_length, size_t* position,
+                                             PakitView* view) {
+    while (true) {
+        size_t start = *position;
+        PakitStatus status = pakit_parse_view(buffer, buffer_length, position,
+                                              receiver->max_payload_size, view);
+        if (status == PAKIT_STATUS_IN_PROGRESS) {
+            return status;
+        }
+
+        if (status != PAKIT_STATUS_SUCCESS) {
+            pakit_note_input(receiver, *position - start);
+            pakit_note_error(receiver, status, *position - start);
+            return status;
+        }
+
+        size_t end = *position;
+        if (receiver->crc_enabled && buffer_length - end < PAKIT_CRC_SIZE) {
+            // Trailer is in the next read; leave the packet to the receiver
+            *position = start;
+            return PAKIT_STATUS_IN_PROGRESS;
+        }
+        *position = end + pakit_trailer_size(receiver);
+
+        if (!pakit_type_wanted(receiver, view->type)) {
+            pakit_note_input(receiver, *position - start);
+            pakit_note_filtered(receiver, *position - start);
+            continue;
+        }
+
+        if (receiver->crc_enabled) {
+            const uint8_t* trailer = &buffer[end];
+            uint32_t expected = ((uint32_t)trailer[0] << 24) | ((uint32_t)trailer[1] << 16) |
+                                ((uint32_t)trailer[2] << 8) | trailer[3];
+
+            if (pakit_crc32c(0, &buffer[start], end - start) != expected) {
+                pakit_note_input(receiver, *position - start);
+                pakit_note_error(receiver, PAKIT_STATUS_ERROR_CRC, *position - start);
+                return PAKIT_STATUS_ERROR_CRC;
+            }
+        }
+
+        pakit_note_input(receiver, *position - start);
+        pakit_track_sequence(receiver, view->type, view->count);
+        pakit_note_complete(receiver, view->type, view->size, false);
+        return PAKIT_STATUS_SUCCESS;
+    }
+}
+
+// True when the receiver holds no partial packet and may decode the next one in
+// place; with a stream attached every packet has to go through the stream
+static bool pakit_receiver_idle(const PakitReceiver* receiver) {
+    return ((receiver->state == STATE_UNIQUE_SOP && receiver->received_bytes == 0) ||
+            receiver->state == STATE_COMPLETE) && !pakit_streaming(receiver);
+}
+
+PakitStatus pakit_next_view(PakitReceiver* receiver, const uint8_t* buffer, size_t buffer_length,
+                            size_t* position, PakitView* view) {
+    // Check for null parameters (but position can be NULL)
+    if (receiver == NULL || buffer == NULL || view == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    size_t current_pos = (position != NULL) ? *position : 0;
+    PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
+
+    // Zero-copy path: nothing is buffered, so the packet can be decoded in place
+    if (pakit_receiver_idle(receiver)) {
+        status = pakit_parse_receiver_view(receiver, buffer, buffer_length, &current_pos, view);
+    }
+
+    // Packet spans the end of the buffer (or a partial one is pending): copy it
+    if (status == PAKIT_STATUS_IN_PROGRESS) {
+        status = pakit_receive_buffer(receiver, buffer, buffer_length, &current_pos);
+
+        if (status == PAKIT_STATUS_SUCCESS) {
+            pakit_receiver_view(receiver, view);
+        }
+    }
+
+    if (position != NULL) {
+        *position = current_pos;
+    }
+
+    return status;
+}
+
+size_t pakit_receive_batch(PakitReceiver* receiver, const uint8_t* buffer, size_t buffer_length,
+                           PakitView* views, size_t max_views, size_t* consumed) {
+    size_t count = 0;
+    size_t current_pos = 0;
+    bool receiver_view = false;
+
+    if (receiver == NULL || buffer == NULL || views == NULL) {
+        if (consumed != NULL) {
+            *consumed = 0;
+        }
+        return 0;
+    }
+
+    while (current_pos < buffer_length && count < max_views) {
+        PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
+
+        if (pakit_receiver_idle(receiver)) {
+            status = pakit_parse_receiver_view(receiver, buffer, buffer_length, &current_pos,
+                                               &views[count]);
+
+            if (status == PAKIT_STATUS_IN_PROGRESS) {
+                // Buffering the tail would overwrite the packet views[0] points to
+                if (receiver_view) {
+                    break;
+                }
+                status = pakit_receive_buffer(receiver, buffer, buffer_length, &current_pos);
+            }
+        } else {
+            // Finish the packet started by an earlier read
+            status = pakit_receive_buffer(receiver, buffer, buffer_length, &current_pos);
+            if (status == PAKIT_STATUS_SUCCESS) {
+                pakit_receiver_view(receiver, &views[count]);
+                receiver_view = true;
+            }
+        }
+
+        if (status == PAKIT_STATUS_SUCCESS) {
+            count++;
+        }
+    }
+
+    if (consumed != NULL) {
+        *consumed = current_pos;
+    }
+
+    return count;
+}
+
 bool pakit_packet_create(Packet* packet, uint16_t packet_type,
                        uint16_t count, const uint8_t* payload, uint16_t payload_size) {
     // Validate input parameters
@@ -214,4 +861,116 @@ bool pakit_packet_create(Packet* packet, uint16_t packet_type,
                                          // just stores the pointer to it
 
     return true;
-}
\ No newline at end of file
+}
+
+// Writes a wire header; count and size are sent MSB first
+static void pakit_write_header(uint8_t* header, const uint8_t type[PACKET_TYPE_SIZE],
+                               uint16_t count, uint16_t size) {
+    PacketHeader* out = (PacketHeader*)header;
+
+    out->sop[0] = EXPECTED_SOP_0;
+    out->sop[1] = EXPECTED_SOP_1;
+    memcpy(out->type, type, PACKET_TYPE_SIZE);
+    out->count_bytes[0] = (uint8_t)(count >> 8);
+    out->count_bytes[1] = (uint8_t)(count & 0xFF);
+    out->size_bytes[0] = (uint8_t)(size >> 8);
+    out->size_bytes[1] = (uint8_t)(size & 0xFF);
+}
+
+// True if the packet can be put on the wire
+static bool pakit_packet_encodable(const Packet* packet) {
+    return !(packet->payload == NULL && packet->size > 0);
+}
+
+bool pakit_encode_header(uint8_t header[HEADER_SIZE], const Packet* packet) {
+    // Validate input parameters
+    if (header == NULL || packet == NULL || !pakit_packet_encodable(packet)) {
+        return false;
+    }
+
+    pakit_write_header(header, packet->type, packet->count, packet->size);
+    return true;
+}
+
+size_t pakit_encode_batch(const Packet* packets, size_t packet_count,
+                          uint8_t* buffer, size_t buffer_size,
+                          size_t* written, uint16_t* sequence) {
+    size_t encoded = 0;
+    size_t offset = 0;
+
+    if (packets != NULL && buffer != NULL) {
+        for (; encoded < packet_count; encoded++) {
+            const Packet* packet = &packets[encoded];
+
+            // Stop at the first packet that is invalid or does not fit
+            if (!pakit_packet_encodable(packet) ||
+                buffer_size - offset < (size_t)HEADER_SIZE + packet->size) {
+                break;
+            }
+
+            uint16_t count = packet->count;
+            if (sequence != NULL) {
+                count = (*sequence)++;
+            }
+
+            pakit_write_header(&buffer[offset], packet->type, count, packet->size);
+            offset += HEADER_SIZE;
+
+            if (packet->size > 0) {
+                memcpy(&buffer[offset], packet->payload, packet->size);
+                offset += packet->size;
+            }
+        }
+    }
+
+    if (written != NULL) {
+        *written = offset;
+    }
+
+    return encoded;
+}
+
+size_t pakit_encode_crc(const Packet* packet, uint8_t* buffer, size_t buffer_size) {
+    // Validate input parameters
+    if (packet == NULL || buffer == NULL || !pakit_packet_encodable(packet)) {
+        return 0;
+    }
+
+    size_t frame_size = (size_t)HEADER_SIZE + packet->size;
+    if (buffer_size < frame_size + PAKIT_CRC_SIZE) {
+        return 0;
+    }
+
+    pakit_write_header(buffer, packet->type, packet->count, packet->size);
+    if (packet->size > 0) {
+        memcpy(&buffer[HEADER_SIZE], packet->payload, packet->size);
+    }
+
+    // Trailer covers header and payload, MSB first
+    uint32_t crc = pakit_crc32c(0, buffer, frame_size);
+    buffer[frame_size] = (uint8_t)(crc >> 24);
+    buffer[frame_size + 1] = (uint8_t)(crc >> 16);
+    buffer[frame_size + 2] = (uint8_t)(crc >> 8);
+    buffer[frame_size + 3] = (uint8_t)(crc & 0xFF);
+
+    return frame_size + PAKIT_CRC_SIZE;
+}
+
+#ifdef PAKIT_HAVE_IOVEC
+int pakit_encode_iov(const Packet* packet, uint8_t header[HEADER_SIZE], struct iovec iov[2]) {
+    if (iov == NULL || !pakit_encode_header(header, packet)) {
+        return 0;
+    }
+
+    iov[0].iov_base = header;
+    iov[0].iov_len = HEADER_SIZE;
+
+    if (packet->size == 0) {
+        return 1;
+    }
+
+    iov[1].iov_base = packet->payload;
+    iov[1].iov_len = packet->size;
+    return 2;
+}
+#endif
@@ -0,0 +1,158 @@
+#include <string.h>
+#include "pakit.h"
+
+// CRC32C (Castagnoli, reflected polynomial 0x82F63B78). The SSE4.2 crc32
+// instruction is picked at runtime on x86; the ARMv8 CRC extension is used
+// when the compiler targets it. Everything else runs slice-by-8 tables, or a
+// bitwise loop without any table under PAKIT_MINIMAL, which also skips the
+// runtime x86 check (microcontrollers have no use for it, and host builds of
+// the profile then test the loop). Define PAKIT_NO_SIMD to force the
+// portable version.
+#if !defined(PAKIT_NO_SIMD) && defined(__GNUC__)
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(PAKIT_MINIMAL)
+#define PAKIT_CRC_SSE42 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_FEATURE_CRC32) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define PAKIT_CRC_ARM 1
+#include <arm_acle.h>
+#endif
+#endif
+
+#define PAKIT_CRC32C_POLY 0x82F63B78u
+
+#if defined(PAKIT_MINIMAL) && !defined(PAKIT_CRC_ARM)
+// Branchless bit at a time: no 8 KB of tables in RAM and no pthread_once,
+// at 8 shift/mask steps per byte
+static uint32_t pakit_crc32c_bitwise(uint32_t crc, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (PAKIT_CRC32C_POLY & (0u - (crc & 1)));
+        }
+        length--;
+    }
+
+    return crc;
+}
+#endif
+
+#if !defined(PAKIT_CRC_ARM) && !defined(PAKIT_MINIMAL)
+#include <pthread.h>
+
+static uint32_t pakit_crc_table[8][256];
+static pthread_once_t pakit_crc_table_once = PTHREAD_ONCE_INIT;
+
+static void pakit_crc_table_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? PAKIT_CRC32C_POLY : 0);
+        }
+        pakit_crc_table[0][i] = crc;
+    }
+
+    // Table k advances a byte through k further zero bytes
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t previous = pakit_crc_table[k - 1][i];
+            pakit_crc_table[k][i] = (previous >> 8) ^ pakit_crc_table[0][previous & 0xFF];
+        }
+    }
+}
+
+static uint32_t pakit_crc32c_table(uint32_t crc, const uint8_t* data, size_t length) {
+    pthread_once(&pakit_crc_table_once, pakit_crc_table_init);
+
+    while (length >= 8) {
+        uint32_t low = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 |
+                              (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+        uint32_t high = (uint32_t)data[4] | (uint32_t)data[5] << 8 |
+                        (uint32_t)data[6] << 16 | (uint32_t)data[7] << 24;
+
+        crc = pakit_crc_table[7][low & 0xFF] ^ pakit_crc_table[6][(low >> 8) & 0xFF] ^
+              pakit_crc_table[5][(low >> 16) & 0xFF] ^ pakit_crc_table[4][low >> 24] ^
+              pakit_crc_table[3][high & 0xFF] ^ pakit_crc_table[2][(high >> 8) & 0xFF] ^
+              pakit_crc_table[1][(high >> 16) & 0xFF] ^ pakit_crc_table[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+
+    while (length > 0) {
+        crc = (crc >> 8) ^ pakit_crc_table[0][(crc ^ *data++) & 0xFF];
+        length--;
+    }
+
+    return crc;
+}
+#endif
+
+#if defined(PAKIT_CRC_SSE42)
+__attribute__((target("sse4.2")))
+static uint32_t pakit_crc32c_sse42(uint32_t crc, const uint8_t* data, size_t length) {
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        length -= 8;
+    }
+    crc = (uint32_t)crc64;
+#endif
+    while (length >= 4) {
+        uint32_t word;
+        memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        data += 4;
+        length -= 4;
+    }
+    while (length > 0) {
+        crc = _mm_crc32_u8(crc, *data++);
+        length--;
+    }
+
+    return crc;
+}
+#endif
+
+#if defined(PAKIT_CRC_ARM)
+static uint32_t pakit_crc32c_arm(uint32_t crc, const uint8_t* data, size_t length) {
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, sizeof(word));
+        crc = __crc32cd(crc, word);
+        data += 8;
+        length -= 8;
+    }
+    while (length > 0) {
+        crc = __crc32cb(crc, *data++);
+        length--;
+    }
+
+    return crc;
+}
+#endif
+
+uint32_t pakit_crc32c(uint32_t crc, const uint8_t* data, size_t length) {
+    if (data == NULL) {
+        return crc;
+    }
+
+    // The running value is kept inverted between calls so they can be chained
+    crc = ~crc;
+
+#if defined(PAKIT_CRC_SSE42)
+    if (__builtin_cpu_supports("sse4.2")) {
+        return ~pakit_crc32c_sse42(crc, data, length);
+    }
+#endif
+#if defined(PAKIT_CRC_ARM)
+    return ~pakit_crc32c_arm(crc, data, length);
+#elif defined(PAKIT_MINIMAL)
+    return ~pakit_crc32c_bitwise(crc, data, length);
+#else
+    return ~pakit_crc32c_table(crc, data, length);
+#endif
+}
@@ -0,0 +1,178 @@
+#define _POSIX_C_SOURCE 200809L  // sched_yield
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pakit_demux.h"
+
+void pakit_demux_init(PakitDemux* demux, PakitPacketPool* pool) {
+    if (demux != NULL) {
+        memset(demux, 0, sizeof(PakitDemux));
+        demux->pool = pool;
+    }
+}
+
+void pakit_demux_destroy(PakitDemux* demux) {
+    if (demux == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < 256; i++) {
+        free(demux->pages[i]);
+        demux->pages[i] = NULL;
+    }
+}
+
+// Stores a stream in the routing table, allocating its page on first use
+static PakitStatus pakit_demux_register(PakitDemux* demux, PakitDemuxStream* stream, uint16_t type) {
+    PakitDemuxStream*** page = &demux->pages[type >> 8];
+    if (*page == NULL) {
+        *page = calloc(256, sizeof(PakitDemuxStream*));
+        if (*page == NULL) {
+            return PAKIT_STATUS_ERROR_NO_MEMORY;
+        }
+    }
+
+    stream->type = type;
+    pakit_sequence_init(&stream->sequence, &stream->sequence_entry, 1, false);
+    memset(&stream->stats, 0, sizeof(stream->stats));
+
+    (*page)[type & 0xFF] = stream;
+    if (demux->filter != NULL) {
+        pakit_filter_set(demux->filter, type, type, true);
+    }
+    return PAKIT_STATUS_SUCCESS;
+}
+
+PakitStatus pakit_demux_add_queue(PakitDemux* demux, PakitDemuxStream* stream, uint16_t type,
+                                  PakitQueue* queue, PakitDemuxPolicy policy) {
+    if (demux == NULL || stream == NULL || queue == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    stream->queue = queue;
+    stream->handler = NULL;
+    stream->context = NULL;
+    stream->policy = policy;
+    return pakit_demux_register(demux, stream, type);
+}
+
+PakitStatus pakit_demux_add_callback(PakitDemux* demux, PakitDemuxStream* stream, uint16_t type,
+                                     PakitTypeHandler handler, void* context) {
+    if (demux == NULL || stream == NULL || handler == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    stream->queue = NULL;
+    stream->handler = handler;
+    stream->context = context;
+    stream->policy = PAKIT_DEMUX_WAIT;
+    return pakit_demux_register(demux, stream, type);
+}
+
+void pakit_demux_remove(PakitDemux* demux, uint16_t type) {
+    if (demux == NULL || demux->pages[type >> 8] == NULL) {
+        return;
+    }
+
+    demux->pages[type >> 8][type & 0xFF] = NULL;
+    if (demux->filter != NULL) {
+        pakit_filter_set(demux->filter, type, type, false);
+    }
+}
+
+void pakit_demux_set_filter(PakitDemux* demux, PakitTypeFilter* filter) {
+    if (demux == NULL) {
+        return;
+    }
+
+    demux->filter = filter;
+    if (filter == NULL) {
+        return;
+    }
+
+    pakit_filter_init(filter, false);
+    for (size_t high = 0; high < 256; high++) {
+        if (demux->pages[high] == NULL) {
+            continue;
+        }
+        for (size_t low = 0; low < 256; low++) {
+            if (demux->pages[high][low] != NULL) {
+                uint16_t type = (uint16_t)((high << 8) | low);
+                pakit_filter_set(filter, type, type, true);
+            }
+        }
+    }
+}
+
+// Hands a packet to a queue stream, applying its policy when the pool or the
+// queue is exhausted. Returns false if the packet was dropped.
+static bool pakit_demux_enqueue(PakitDemux* demux, PakitReceiver* receiver, PakitDemuxStream* stream,
+                                const PakitView* view) {
+    // A packet buffered in the receiver's pooled slot is taken as it is; one
+    // decoded in place is copied into the demux pool
+    bool buffered = receiver->pooled != NULL && view->payload == pakit_packet_data(receiver->pooled);
+    PakitPacket* packet;
+
+    while ((packet = buffered ? pakit_take_packet(receiver) : pakit_packet_from_view(demux->pool, view)) == NULL) {
+        // Without a pool to copy into, waiting would never end. A buffered
+        // packet always gets a slot eventually: pakit_attach_packet_pool only
+        // accepts pools with a slot to spare beside the receiver's.
+        if (stream->policy == PAKIT_DEMUX_DROP || (!buffered && demux->pool == NULL)) {
+            stream->stats.dropped++;
+            return false;
+        }
+        sched_yield();
+    }
+
+    while (!pakit_queue_push(stream->queue, packet)) {
+        if (stream->policy == PAKIT_DEMUX_DROP) {
+            pakit_packet_release(packet);
+            stream->stats.dropped++;
+            return false;
+        }
+        sched_yield();
+    }
+
+    stream->stats.packets++;
+    return true;
+}
+
+size_t pakit_demux_receive(PakitDemux* demux, PakitReceiver* receiver, const uint8_t* buffer,
+                           size_t buffer_length, size_t* consumed) {
+    size_t delivered = 0;
+    size_t position = 0;
+
+    if (demux != NULL && receiver != NULL && buffer != NULL) {
+        bool keep_going = true;
+
+        while (position < buffer_length && keep_going) {
+            PakitView view;
+            if (pakit_next_view(receiver, buffer, buffer_length, &position, &view) != PAKIT_STATUS_SUCCESS) {
+                continue;
+            }
+
+            PakitDemuxStream* stream = pakit_demux_find(demux, view.type);
+            if (stream == NULL) {
+                demux->unrouted++;
+                continue;
+            }
+
+            // Sequences count what arrived on the link, dropped packets included
+            pakit_sequence_update(&stream->sequence, view.type, view.count);
+
+            if (stream->queue == NULL) {
+                stream->stats.packets++;
+                delivered++;
+                keep_going = stream->handler(stream->context, &view);
+            } else if (pakit_demux_enqueue(demux, receiver, stream, &view)) {
+                delivered++;
+            }
+        }
+    }
+
+    if (consumed != NULL) {
+        *consumed = position;
+    }
+
+    return delivered;
+}
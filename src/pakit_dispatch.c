@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include "pakit_dispatch.h"
+#include "pakit_internal.h"
+
+// Returns the receiver's handler table, allocating it on first use
+static PakitDispatchTable* pakit_dispatch_table(PakitReceiver* receiver) {
+    if (receiver->handlers == NULL) {
+        receiver->handlers = calloc(1, sizeof(PakitDispatchTable));
+    }
+    return receiver->handlers;
+}
+
+PakitStatus pakit_on_type(PakitReceiver* receiver, uint16_t type,
+                          PakitTypeHandler handler, void* context) {
+    if (receiver == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    // Removing a handler that was never registered needs no table
+    if (handler == NULL && (receiver->handlers == NULL || receiver->handlers->pages[type >> 8] == NULL)) {
+        return PAKIT_STATUS_SUCCESS;
+    }
+
+    PakitDispatchTable* table = pakit_dispatch_table(receiver);
+    if (table == NULL) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    PakitHandlerEntry** page = &table->pages[type >> 8];
+    if (*page == NULL) {
+        *page = calloc(256, sizeof(PakitHandlerEntry));
+        if (*page == NULL) {
+            return PAKIT_STATUS_ERROR_NO_MEMORY;
+        }
+    }
+
+    (*page)[type & 0xFF].handler = handler;
+    (*page)[type & 0xFF].context = context;
+    return PAKIT_STATUS_SUCCESS;
+}
+
+PakitStatus pakit_on_unhandled(PakitReceiver* receiver, PakitTypeHandler handler, void* context) {
+    if (receiver == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    PakitDispatchTable* table = pakit_dispatch_table(receiver);
+    if (table == NULL) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    table->unhandled.handler = handler;
+    table->unhandled.context = context;
+    return PAKIT_STATUS_SUCCESS;
+}
+
+void pakit_dispatch_release(PakitReceiver* receiver) {
+    PakitDispatchTable* table = receiver->handlers;
+    if (table == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < 256; i++) {
+        free(table->pages[i]);
+    }
+    free(table);
+    receiver->handlers = NULL;
+}
+
+// Finds the handler for a type, falling back to the unhandled one
+static const PakitHandlerEntry* pakit_dispatch_lookup(const PakitDispatchTable* table, uint16_t type) {
+    const PakitHandlerEntry* page = table->pages[type >> 8];
+    if (page != NULL && page[type & 0xFF].handler != NULL) {
+        return &page[type & 0xFF];
+    }
+    return &table->unhandled;
+}
+
+size_t pakit_receive_dispatch(PakitReceiver* receiver, const uint8_t* buffer,
+                              size_t buffer_length, size_t* consumed) {
+    size_t dispatched = 0;
+    size_t position = 0;
+
+    if (receiver != NULL && buffer != NULL) {
+        const PakitDispatchTable* table = receiver->handlers;
+        bool keep_going = true;
+
+        while (position < buffer_length && keep_going) {
+            PakitView view;
+            if (pakit_next_view(receiver, buffer, buffer_length, &position, &view) != PAKIT_STATUS_SUCCESS ||
+                table == NULL) {
+                continue;
+            }
+
+            const PakitHandlerEntry* entry = pakit_dispatch_lookup(table, view.type);
+            if (entry->handler != NULL) {
+                dispatched++;
+                keep_going = entry->handler(entry->context, &view);
+            }
+        }
+    }
+
+    if (consumed != NULL) {
+        *consumed = position;
+    }
+
+    return dispatched;
+}
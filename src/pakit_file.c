@@ -0,0 +1,263 @@
+#define _GNU_SOURCE  // O_DIRECT
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pakit_file.h"
+#include "pakit_internal.h"
+
+// Room for one block of tail bytes kept back by an O_DIRECT flush plus the largest packet
+#define PAKIT_FILE_MIN_BUFFER \
+    ((PAKIT_FILE_BLOCK_SIZE + HEADER_SIZE + PAKIT_MAX_PAYLOAD_LIMIT + PAKIT_FILE_BLOCK_SIZE - 1) / \
+     PAKIT_FILE_BLOCK_SIZE * PAKIT_FILE_BLOCK_SIZE)
+
+PakitStatus pakit_file_open(PakitFileReader* reader, const char* path, uint16_t max_payload_size) {
+    if (reader == NULL || path == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    memset(reader, 0, sizeof(PakitFileReader));
+    reader->max_payload_size = (max_payload_size != 0) ? max_payload_size : MAX_PACKET_SIZE;
+
+    reader->fd = open(path, O_RDONLY);
+    if (reader->fd < 0) {
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    struct stat info;
+    if (fstat(reader->fd, &info) != 0) {
+        close(reader->fd);
+        reader->fd = -1;
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    reader->length = (size_t)info.st_size;
+    if (reader->length > 0) {
+        void* mapping = mmap(NULL, reader->length, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(reader->fd);
+            reader->fd = -1;
+            reader->length = 0;
+            return PAKIT_STATUS_ERROR_IO;
+        }
+
+        // Captures are mostly read front to back
+        madvise(mapping, reader->length, MADV_SEQUENTIAL);
+        reader->data = mapping;
+    }
+
+    return PAKIT_STATUS_SUCCESS;
+}
+
+void pakit_file_close(PakitFileReader* reader) {
+    if (reader == NULL) {
+        return;
+    }
+
+    if (reader->data != NULL) {
+        munmap((void*)reader->data, reader->length);
+    }
+    if (reader->fd >= 0) {
+        close(reader->fd);
+    }
+
+    reader->data = NULL;
+    reader->length = 0;
+    reader->position = 0;
+    reader->fd = -1;
+}
+
+bool pakit_file_next(PakitFileReader* reader, PakitView* view, size_t* offset) {
+    if (reader == NULL || view == NULL || reader->data == NULL) {
+        return false;
+    }
+
+    while (reader->position < reader->length) {
+        size_t start = reader->position;
+        PakitStatus status = pakit_parse_view(reader->data, reader->length, &reader->position,
+                                              reader->max_payload_size, view);
+
+        if (status == PAKIT_STATUS_SUCCESS) {
+            if (offset != NULL) {
+                *offset = start;
+            }
+            return true;
+        }
+        if (status == PAKIT_STATUS_IN_PROGRESS) {
+            // Truncated packet at the end of the file
+            reader->position = reader->length;
+        }
+    }
+
+    return false;
+}
+
+size_t pakit_file_decode_parallel(const PakitFileReader* reader,
+                                  const PakitParallelOptions* options,
+                                  PakitPacketCallback callback, void* context) {
+    if (reader == NULL || reader->data == NULL) {
+        return 0;
+    }
+
+    PakitParallelOptions file_options = {0, 0, reader->max_payload_size};
+    if (options != NULL) {
+        file_options = *options;
+        if (file_options.max_payload_size == 0) {
+            file_options.max_payload_size = reader->max_payload_size;
+        }
+    }
+
+    return pakit_decode_parallel(reader->data, reader->length, &file_options, callback, context);
+}
+
+PakitStatus pakit_file_create(PakitFileWriter* writer, const char* path,
+                              unsigned flags, size_t buffer_size) {
+    if (writer == NULL || path == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    memset(writer, 0, sizeof(PakitFileWriter));
+    writer->fd = -1;
+
+    if (buffer_size == 0) {
+        buffer_size = PAKIT_FILE_BUFFER_SIZE;
+    }
+    if (buffer_size < PAKIT_FILE_MIN_BUFFER) {
+        buffer_size = PAKIT_FILE_MIN_BUFFER;
+    }
+    buffer_size = (buffer_size + PAKIT_FILE_BLOCK_SIZE - 1) / PAKIT_FILE_BLOCK_SIZE * PAKIT_FILE_BLOCK_SIZE;
+
+    void* buffer = NULL;
+    if (posix_memalign(&buffer, PAKIT_FILE_BLOCK_SIZE, buffer_size) != 0) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    int open_flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+    if ((flags & PAKIT_FILE_DIRECT) != 0) {
+        writer->fd = open(path, open_flags | O_DIRECT, 0644);
+        writer->direct = (writer->fd >= 0);
+    }
+#else
+    (void)flags;
+#endif
+    if (writer->fd < 0) {
+        // O_DIRECT not requested, or refused by the file system
+        writer->fd = open(path, open_flags, 0644);
+    }
+    if (writer->fd < 0) {
+        free(buffer);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    writer->buffer = buffer;
+    writer->capacity = buffer_size;
+    return PAKIT_STATUS_SUCCESS;
+}
+
+// Switches the writer to buffered writes for the rest of the file
+static bool pakit_file_drop_direct(PakitFileWriter* writer) {
+    writer->direct = false;
+#ifdef O_DIRECT
+    int file_flags = fcntl(writer->fd, F_GETFL);
+    return file_flags >= 0 && fcntl(writer->fd, F_SETFL, file_flags & ~O_DIRECT) == 0;
+#else
+    return true;
+#endif
+}
+
+static bool pakit_file_write_all(PakitFileWriter* writer, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(writer->fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+
+        // A short O_DIRECT write that ends mid-block leaves the rest unaligned
+        if (writer->direct && length > 0 && (size_t)written % PAKIT_FILE_BLOCK_SIZE != 0 &&
+            !pakit_file_drop_direct(writer)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes out the buffer. With O_DIRECT only whole blocks can go out, so the
+// unaligned tail is kept at the front of the buffer for the next flush.
+static bool pakit_file_flush(PakitFileWriter* writer) {
+    size_t length = writer->used;
+    if (writer->direct) {
+        length = writer->used / PAKIT_FILE_BLOCK_SIZE * PAKIT_FILE_BLOCK_SIZE;
+    }
+
+    if (!pakit_file_write_all(writer, writer->buffer, length)) {
+        return false;
+    }
+
+    memmove(writer->buffer, &writer->buffer[length], writer->used - length);
+    writer->used -= length;
+    return true;
+}
+
+PakitStatus pakit_file_write(PakitFileWriter* writer, const Packet* packets,
+                             size_t packet_count, uint16_t* sequence) {
+    if (writer == NULL || writer->buffer == NULL || (packets == NULL && packet_count > 0)) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    size_t index = 0;
+    while (index < packet_count) {
+        size_t written = 0;
+        size_t encoded = pakit_encode_batch(&packets[index], packet_count - index,
+                                            &writer->buffer[writer->used],
+                                            writer->capacity - writer->used, &written, sequence);
+        writer->used += written;
+        index += encoded;
+
+        if (index == packet_count) {
+            break;
+        }
+        if (packets[index].payload == NULL && packets[index].size > 0) {
+            return PAKIT_STATUS_ERROR_NULL_PARAM;
+        }
+
+        // Buffer is full; the minimum size guarantees the packet fits afterwards
+        if (!pakit_file_flush(writer)) {
+            return PAKIT_STATUS_ERROR_IO;
+        }
+    }
+
+    return PAKIT_STATUS_SUCCESS;
+}
+
+PakitStatus pakit_file_finish(PakitFileWriter* writer) {
+    if (writer == NULL || writer->fd < 0) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    bool ok = pakit_file_flush(writer);
+
+    // The unaligned tail has to bypass O_DIRECT
+    if (ok && writer->direct && writer->used > 0) {
+        ok = pakit_file_drop_direct(writer) && pakit_file_flush(writer);
+    }
+
+    if (close(writer->fd) != 0) {
+        ok = false;
+    }
+
+    free(writer->buffer);
+    writer->buffer = NULL;
+    writer->fd = -1;
+    writer->used = 0;
+
+    return ok ? PAKIT_STATUS_SUCCESS : PAKIT_STATUS_ERROR_IO;
+}
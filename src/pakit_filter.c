@@ -0,0 +1,30 @@
+#include <string.h>
+#include "pakit_filter.h"
+
+void pakit_filter_init(PakitTypeFilter* filter, bool accept_all) {
+    if (filter != NULL) {
+        memset(filter->accepted, accept_all ? 0xFF : 0x00, sizeof(filter->accepted));
+    }
+}
+
+void pakit_filter_set(PakitTypeFilter* filter, uint16_t first, uint16_t last, bool accepted) {
+    if (filter == NULL || first > last) {
+        return;
+    }
+
+    for (uint32_t type = first; type <= last; type++) {
+        uint64_t bit = (uint64_t)1 << (type & 63);
+        if (accepted) {
+            filter->accepted[type >> 6] |= bit;
+        } else {
+            filter->accepted[type >> 6] &= ~bit;
+        }
+    }
+}
+
+void pakit_set_filter(PakitReceiver* receiver, PakitTypeFilter* filter) {
+    if (receiver != NULL) {
+        receiver->filter = filter;
+        pakit_init(receiver);
+    }
+}
@@ -0,0 +1,343 @@
+#define _POSIX_C_SOURCE 200809L  // ftruncate
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pakit_index.h"
+#include "pakit_internal.h"
+
+#define PAKIT_INDEX_KEYS 65536
+
+typedef struct {
+    FILE* file;
+    uint64_t entry_count;
+    bool failed;
+    uint64_t* type_totals;       // Packets per type
+    uint64_t* count_totals;      // Packets per sequence number
+} PakitIndexBuilder;
+
+// Bytes of an index file with the given numbers of entries and types
+static size_t pakit_index_file_size(size_t entry_count, size_t type_count) {
+    return sizeof(PakitIndexFileHeader) + entry_count * sizeof(PakitIndexEntry) +
+           type_count * sizeof(PakitIndexTypeList) + entry_count * sizeof(uint64_t) +
+           entry_count * sizeof(PakitIndexCountKey);
+}
+
+static bool pakit_index_append(void* context, size_t offset, const PakitView* view) {
+    PakitIndexBuilder* builder = context;
+    PakitIndexEntry entry = {offset, view->type, view->count, view->size, 0};
+
+    if (fwrite(&entry, sizeof(entry), 1, builder->file) != 1) {
+        builder->failed = true;
+        return false;
+    }
+    builder->entry_count++;
+    builder->type_totals[view->type]++;
+    builder->count_totals[view->count]++;
+    return true;
+}
+
+// Appends the lookup sections to an index file holding its header and entries.
+// Both are counting sorts over the entries, which keep each run of equal keys
+// in ordinal order.
+static bool pakit_index_write_lookups(const char* path, PakitIndexFileHeader* header,
+                                      PakitIndexBuilder* builder) {
+    header->type_count = 0;
+    for (size_t key = 0; key < PAKIT_INDEX_KEYS; key++) {
+        header->type_count += builder->type_totals[key] != 0;
+    }
+
+    int fd = open(path, O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+    size_t length = pakit_index_file_size((size_t)header->entry_count, (size_t)header->type_count);
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, (off_t)length) == 0) {
+        mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (mapping == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    const PakitIndexEntry* entries = (const PakitIndexEntry*)((PakitIndexFileHeader*)mapping + 1);
+    size_t entry_count = (size_t)header->entry_count;
+    PakitIndexTypeList* types = (PakitIndexTypeList*)(entries + entry_count);
+    uint64_t* type_ordinals = (uint64_t*)(types + header->type_count);
+    PakitIndexCountKey* counts = (PakitIndexCountKey*)(type_ordinals + entry_count);
+
+    // Turn the totals into the position each key's run starts at
+    uint64_t type_first = 0;
+    uint64_t count_first = 0;
+    size_t type = 0;
+    for (size_t key = 0; key < PAKIT_INDEX_KEYS; key++) {
+        uint64_t total = builder->type_totals[key];
+        if (total != 0) {
+            types[type].type = (uint16_t)key;
+            types[type].first = type_first;
+            types[type].length = total;
+            type++;
+        }
+        builder->type_totals[key] = type_first;
+        type_first += total;
+
+        total = builder->count_totals[key];
+        builder->count_totals[key] = count_first;
+        count_first += total;
+    }
+
+    for (size_t i = 0; i < entry_count; i++) {
+        type_ordinals[builder->type_totals[entries[i].type]++] = i;
+        PakitIndexCountKey* key = &counts[builder->count_totals[entries[i].count]++];
+        key->ordinal = i;
+        key->count = entries[i].count;
+    }
+
+    memcpy(mapping, header, sizeof(PakitIndexFileHeader));
+    bool ok = msync(mapping, length, MS_SYNC) == 0;
+    munmap(mapping, length);
+    return (close(fd) == 0) && ok;
+}
+
+PakitStatus pakit_index_build(const PakitFileReader* reader, const char* path,
+                              const PakitParallelOptions* options) {
+    if (reader == NULL || path == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    PakitIndexBuilder builder = {NULL, 0, false, calloc(PAKIT_INDEX_KEYS, sizeof(uint64_t)),
+                                 calloc(PAKIT_INDEX_KEYS, sizeof(uint64_t))};
+    if (builder.type_totals != NULL && builder.count_totals != NULL) {
+        builder.file = fopen(path, "wb");
+    }
+    if (builder.file == NULL) {
+        free(builder.type_totals);
+        free(builder.count_totals);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    // Placeholder header, rewritten once the entry and type counts are known
+    PakitIndexFileHeader header;
+    memcpy(header.magic, PAKIT_INDEX_MAGIC, sizeof(header.magic));
+    header.version = PAKIT_INDEX_VERSION;
+    header.entry_count = 0;
+    header.source_size = reader->length;
+    header.type_count = 0;
+
+    bool ok = fwrite(&header, sizeof(header), 1, builder.file) == 1;
+    if (ok) {
+        pakit_file_decode_parallel(reader, options, pakit_index_append, &builder);
+        ok = !builder.failed;
+    }
+
+    if (fclose(builder.file) != 0) {
+        ok = false;
+    }
+
+    header.entry_count = builder.entry_count;
+    ok = ok && pakit_index_write_lookups(path, &header, &builder);
+
+    free(builder.type_totals);
+    free(builder.count_totals);
+
+    return ok ? PAKIT_STATUS_SUCCESS : PAKIT_STATUS_ERROR_IO;
+}
+
+PakitStatus pakit_index_open(PakitIndex* index, const char* path) {
+    if (index == NULL || path == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    memset(index, 0, sizeof(PakitIndex));
+    index->fd = open(path, O_RDONLY);
+    if (index->fd < 0) {
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    struct stat info;
+    if (fstat(index->fd, &info) != 0 || (size_t)info.st_size < sizeof(PakitIndexFileHeader)) {
+        pakit_index_close(index);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    index->mapping_length = (size_t)info.st_size;
+    index->mapping = mmap(NULL, index->mapping_length, PROT_READ, MAP_SHARED, index->fd, 0);
+    if (index->mapping == MAP_FAILED) {
+        index->mapping = NULL;
+        pakit_index_close(index);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    // Validate the header against the file size before trusting any entry
+    const PakitIndexFileHeader* header = index->mapping;
+    size_t capacity = (index->mapping_length - sizeof(PakitIndexFileHeader)) /
+                      (sizeof(PakitIndexEntry) + sizeof(uint64_t) + sizeof(PakitIndexCountKey));
+    if (memcmp(header->magic, PAKIT_INDEX_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != PAKIT_INDEX_VERSION || header->entry_count > capacity ||
+        header->type_count > PAKIT_INDEX_KEYS ||
+        pakit_index_file_size((size_t)header->entry_count, (size_t)header->type_count) !=
+            index->mapping_length) {
+        pakit_index_close(index);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    index->entries = (const PakitIndexEntry*)(header + 1);
+    index->entry_count = (size_t)header->entry_count;
+    index->source_size = header->source_size;
+    index->types = (const PakitIndexTypeList*)(index->entries + index->entry_count);
+    index->type_count = (size_t)header->type_count;
+    index->type_ordinals = (const uint64_t*)(index->types + index->type_count);
+    index->counts = (const PakitIndexCountKey*)(index->type_ordinals + index->entry_count);
+
+    // The posting lists must tile the ordinals so no lookup reads past them
+    uint64_t next = 0;
+    for (size_t i = 0; i < index->type_count; i++) {
+        if (index->types[i].first != next || index->types[i].length > index->entry_count - next ||
+            (i > 0 && index->types[i].type <= index->types[i - 1].type)) {
+            pakit_index_close(index);
+            return PAKIT_STATUS_ERROR_IO;
+        }
+        next += index->types[i].length;
+    }
+    if (next != index->entry_count) {
+        pakit_index_close(index);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    return PAKIT_STATUS_SUCCESS;
+}
+
+void pakit_index_close(PakitIndex* index) {
+    if (index == NULL) {
+        return;
+    }
+
+    if (index->mapping != NULL) {
+        munmap(index->mapping, index->mapping_length);
+    }
+    if (index->fd >= 0) {
+        close(index->fd);
+    }
+
+    memset(index, 0, sizeof(PakitIndex));
+    index->fd = -1;
+}
+
+const PakitIndexEntry* pakit_index_get(const PakitIndex* index, size_t ordinal) {
+    if (index == NULL || ordinal >= index->entry_count) {
+        return NULL;
+    }
+    return &index->entries[ordinal];
+}
+
+size_t pakit_index_find_offset(const PakitIndex* index, uint64_t offset) {
+    if (index == NULL) {
+        return PAKIT_INDEX_NOT_FOUND;
+    }
+
+    // Entries are in file order, so offsets are strictly increasing
+    size_t low = 0;
+    size_t high = index->entry_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (index->entries[middle].offset < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return (low < index->entry_count) ? low : PAKIT_INDEX_NOT_FOUND;
+}
+
+size_t pakit_index_find_count(const PakitIndex* index, uint16_t count, size_t from) {
+    if (index == NULL) {
+        return PAKIT_INDEX_NOT_FOUND;
+    }
+
+    // First (count, ordinal) pair at or after (count, from)
+    size_t low = 0;
+    size_t high = index->entry_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        const PakitIndexCountKey* key = &index->counts[middle];
+        if (key->count < count || (key->count == count && key->ordinal < from)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low == index->entry_count || index->counts[low].count != count ||
+        index->counts[low].ordinal >= index->entry_count) {
+        return PAKIT_INDEX_NOT_FOUND;
+    }
+    return (size_t)index->counts[low].ordinal;
+}
+
+size_t pakit_index_find_type(const PakitIndex* index, uint16_t type, size_t from) {
+    if (index == NULL) {
+        return PAKIT_INDEX_NOT_FOUND;
+    }
+
+    size_t low = 0;
+    size_t high = index->type_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (index->types[middle].type < type) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == index->type_count || index->types[low].type != type) {
+        return PAKIT_INDEX_NOT_FOUND;
+    }
+
+    // First ordinal at or after from in the type's posting list
+    const uint64_t* ordinals = &index->type_ordinals[index->types[low].first];
+    size_t length = (size_t)index->types[low].length;
+    low = 0;
+    high = length;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (ordinals[middle] < from) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low == length || ordinals[low] >= index->entry_count) {
+        return PAKIT_INDEX_NOT_FOUND;
+    }
+    return (size_t)ordinals[low];
+}
+
+bool pakit_index_view(const PakitIndex* index, const PakitFileReader* reader,
+                      size_t ordinal, PakitView* view) {
+    const PakitIndexEntry* entry = pakit_index_get(index, ordinal);
+    if (entry == NULL || reader == NULL || reader->data == NULL || view == NULL ||
+        index->source_size != reader->length || entry->offset > reader->length ||
+        reader->length - entry->offset < (uint64_t)HEADER_SIZE + entry->size) {
+        return false;
+    }
+
+    // A stale or foreign index points at bytes that are not this packet's header
+    uint64_t word = pakit_header_word(&reader->data[entry->offset]);
+    if ((uint16_t)(word >> 48) != ((EXPECTED_SOP_0 << 8) | EXPECTED_SOP_1) ||
+        (uint16_t)(word >> 32) != entry->type || (uint16_t)(word >> 16) != entry->count ||
+        (uint16_t)word != entry->size) {
+        return false;
+    }
+
+    view->type = entry->type;
+    view->count = entry->count;
+    view->size = entry->size;
+    view->payload = &reader->data[entry->offset + HEADER_SIZE];
+    return true;
+}
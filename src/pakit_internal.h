@@ -0,0 +1,73 @@
+#ifndef pakit_internal_H
+#define pakit_internal_H
+
+#include <string.h>
+#include "pakit.h"
+
+// Library internals shared between translation units; not part of the public API
+
+_Static_assert(HEADER_SIZE == sizeof(uint64_t), "header decode relies on an 8-byte header");
+
+#define PAKIT_SOP_WORD (((uint16_t)EXPECTED_SOP_0 << 8) | EXPECTED_SOP_1)
+
+// Loads the 8 header bytes at data with one unaligned load, in wire (big-endian)
+// order: SOP in bits 63-48, type in 47-32, count in 31-16 and size in 15-0
+static inline uint64_t pakit_header_word(const uint8_t* data) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#elif !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    word = ((uint64_t)data[0] << 56) | ((uint64_t)data[1] << 48) | ((uint64_t)data[2] << 40) |
+           ((uint64_t)data[3] << 32) | ((uint64_t)data[4] << 24) | ((uint64_t)data[5] << 16) |
+           ((uint64_t)data[6] << 8) | data[7];
+#endif
+    return word;
+}
+
+// Decodes a packet that lies entirely inside buffer without touching any receiver
+// Parameters:
+//   buffer - Pointer to the buffer containing bytes to process
+//   buffer_length - Number of bytes in the buffer
+//   position - Input is the starting position, output is the ending position
+//   max_payload_size - Largest payload accepted
+//   view - Receives the packet on success
+// Returns:
+//   PAKIT_STATUS_SUCCESS - view points into buffer
+//   PAKIT_STATUS_IN_PROGRESS - The packet is truncated; nothing was consumed
+//   PAKIT_STATUS_ERROR_* - The same bytes pakit_receive_buffer would discard were consumed
+PakitStatus pakit_parse_view(const uint8_t* buffer, size_t buffer_length,
+                             size_t* position, uint16_t max_payload_size,
+                             PakitView* view);
+
+#ifndef PAKIT_MINIMAL
+// Frees the handler table of a receiver (see pakit_dispatch.h)
+void pakit_dispatch_release(PakitReceiver* receiver);
+
+// Returns a receiver's pooled payload slot (see pakit_packet_pool.h)
+void pakit_packet_pool_release(PakitReceiver* receiver);
+
+// Records a completed packet in a receiver's timing block (see pakit_timing.h);
+// buffered is false for packets decoded in place within the current read
+void pakit_timing_complete(struct PakitTiming* timing, bool buffered);
+#endif
+
+#ifdef PAKIT_ENABLE_STATS
+// Monotonic clock for the time-to-complete statistic
+uint64_t pakit_stats_now_ns(void);
+#endif
+
+// USDT probes for eBPF/SystemTap, only when asked for and <sys/sdt.h> exists
+#if defined(PAKIT_ENABLE_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PAKIT_PROBE_COMPLETE(receiver, type, size) DTRACE_PROBE3(pakit, packet_complete, receiver, type, size)
+#define PAKIT_PROBE_ERROR(receiver, status, dropped) DTRACE_PROBE3(pakit, error, receiver, status, dropped)
+#endif
+#endif
+#ifndef PAKIT_PROBE_COMPLETE
+#define PAKIT_PROBE_COMPLETE(receiver, type, size) ((void)0)
+#define PAKIT_PROBE_ERROR(receiver, status, dropped) ((void)0)
+#endif
+
+#endif // pakit_internal_H
@@ -0,0 +1,609 @@
+#define _GNU_SOURCE  // syscall
+#include "pakit_io.h"
+
+#if defined(PAKIT_HAVE_IO)
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+// IORING_RECV_MULTISHOT (6.0) postdates provided buffer rings, which are enum values
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+#define PAKIT_IO_HAVE_URING 1
+#endif
+#endif
+#endif
+
+#define PAKIT_IO_EVENTS 64
+
+// Decodes one read and hands the packets to the channel's callback in batches
+static size_t pakit_io_deliver(PakitIoLoop* loop, size_t channel, const uint8_t* data, size_t length) {
+    PakitIoChannel* entry = &loop->channels[channel];
+    PakitView views[PAKIT_IO_MAX_VIEWS];
+    size_t delivered = 0;
+    size_t position = 0;
+
+    // The callback may detach the channel
+    while (position < length && entry->attached) {
+        size_t consumed = 0;
+        size_t count = pakit_receive_batch(entry->receiver, &data[position], length - position,
+                                           views, PAKIT_IO_MAX_VIEWS, &consumed);
+        position += consumed;
+
+        if (count > 0) {
+            delivered += count;
+            entry->callback(entry->context, channel, views, count);
+        }
+    }
+
+    return delivered;
+}
+
+// Reports end of stream or a read error, then detaches the channel
+static void pakit_io_close(PakitIoLoop* loop, size_t channel) {
+    PakitIoChannel* entry = &loop->channels[channel];
+    if (entry->attached) {
+        entry->callback(entry->context, channel, NULL, 0);
+        pakit_io_detach(loop, channel);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// epoll backend
+
+static PakitStatus pakit_io_epoll_poll(PakitIoLoop* loop, int timeout_ms, size_t* delivered) {
+    struct epoll_event events[PAKIT_IO_EVENTS];
+
+    int ready = epoll_wait(loop->fd, events, PAKIT_IO_EVENTS, timeout_ms);
+    if (ready < 0) {
+        return (errno == EINTR) ? PAKIT_STATUS_SUCCESS : PAKIT_STATUS_ERROR_IO;
+    }
+
+    for (int i = 0; i < ready; i++) {
+        size_t channel = (size_t)events[i].data.u64;
+        PakitIoChannel* entry = &loop->channels[channel];
+
+        // Keep reading while reads fill the whole buffer; a short read means the
+        // descriptor is drained, which saves the read that would return EAGAIN
+        while (entry->attached) {
+            ssize_t count = read(entry->fd, loop->buffers, loop->buffer_size);
+            if (count > 0) {
+                *delivered += pakit_io_deliver(loop, channel, loop->buffers, (size_t)count);
+                if ((size_t)count < loop->buffer_size) {
+                    break;
+                }
+            } else if (count < 0 && errno == EINTR) {
+                continue;
+            } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                pakit_io_close(loop, channel);
+            }
+        }
+    }
+
+    return PAKIT_STATUS_SUCCESS;
+}
+
+// ---------------------------------------------------------------------------
+// io_uring backend, driven with raw system calls so no liburing is needed
+
+#if defined(PAKIT_IO_HAVE_URING)
+
+#define PAKIT_IO_CANCEL_TAG UINT64_MAX   // user_data of cancel requests
+
+typedef struct PakitUring {
+    int fd;
+    void *sq_map;
+    size_t sq_map_size;
+    void *cq_map;
+    size_t cq_map_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_array;
+    unsigned sq_mask;
+    unsigned sq_entries;
+    unsigned pending;            // SQEs queued but not yet submitted
+    size_t rearm_count;          // Channels whose read waits for a free SQE
+
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    struct io_uring_cqe *cqes;
+    unsigned cq_mask;
+
+    struct io_uring_buf_ring *buf_ring;   // Provided buffers, group 0
+    size_t buf_ring_size;
+    uint16_t buf_tail;
+} PakitUring;
+
+static int pakit_uring_enter(PakitUring* uring, unsigned submit, unsigned wait, unsigned flags,
+                             void* argument, size_t argument_size) {
+    return (int)syscall(__NR_io_uring_enter, uring->fd, submit, wait, flags, argument, argument_size);
+}
+
+// Submits everything queued so far without waiting
+static void pakit_uring_submit(PakitUring* uring) {
+    while (uring->pending > 0) {
+        int submitted = pakit_uring_enter(uring, uring->pending, 0, 0, NULL, 0);
+        if (submitted < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        uring->pending -= (unsigned)submitted;
+    }
+}
+
+// Returns a zeroed SQE, submitting first if the queue is full
+static struct io_uring_sqe* pakit_uring_sqe(PakitUring* uring) {
+    unsigned tail = *uring->sq_tail;
+    if (tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE) >= uring->sq_entries) {
+        pakit_uring_submit(uring);
+        if (tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE) >= uring->sq_entries) {
+            return NULL;
+        }
+    }
+
+    struct io_uring_sqe* sqe = &uring->sqes[tail & uring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+// Publishes the SQE returned by the last pakit_uring_sqe call
+static void pakit_uring_queue(PakitUring* uring) {
+    unsigned tail = *uring->sq_tail;
+    uring->sq_array[tail & uring->sq_mask] = tail & uring->sq_mask;
+    __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    uring->pending++;
+}
+
+// Hands a provided buffer back to the kernel
+static void pakit_uring_recycle(PakitIoLoop* loop, uint16_t buffer) {
+    PakitUring* uring = loop->uring;
+    struct io_uring_buf* entry = &uring->buf_ring->bufs[uring->buf_tail & (PAKIT_IO_URING_BUFFERS - 1)];
+
+    entry->addr = (uint64_t)(uintptr_t)&loop->buffers[(size_t)buffer * loop->buffer_size];
+    entry->len = (uint32_t)loop->buffer_size;
+    entry->bid = buffer;
+    uring->buf_tail++;
+    __atomic_store_n(&uring->buf_ring->tail, uring->buf_tail, __ATOMIC_RELEASE);
+}
+
+static uint64_t pakit_uring_tag(const PakitIoLoop* loop, size_t channel) {
+    return ((uint64_t)loop->channels[channel].generation << 32) | (uint64_t)channel;
+}
+
+// Queues a read for a channel into the provided buffers
+static bool pakit_uring_arm(PakitIoLoop* loop, size_t channel) {
+    PakitIoChannel* entry = &loop->channels[channel];
+    struct io_uring_sqe* sqe = pakit_uring_sqe(loop->uring);
+    if (sqe == NULL) {
+        return false;
+    }
+
+    sqe->fd = entry->fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->user_data = pakit_uring_tag(loop, channel);
+
+    if (entry->socket) {
+        // One request keeps delivering completions until it is cancelled
+        sqe->opcode = IORING_OP_RECV;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+    } else {
+        sqe->opcode = IORING_OP_READ;
+        sqe->len = (uint32_t)loop->buffer_size;
+        sqe->off = (uint64_t)-1;   // Current file position
+    }
+
+    pakit_uring_queue(loop->uring);
+    entry->armed = true;
+    return true;
+}
+
+static void pakit_uring_free(PakitUring* uring) {
+    if (uring->buf_ring != NULL) {
+        munmap(uring->buf_ring, uring->buf_ring_size);
+    }
+    if (uring->sqes != NULL) {
+        munmap(uring->sqes, uring->sqes_size);
+    }
+    if (uring->cq_map != NULL && uring->cq_map != uring->sq_map) {
+        munmap(uring->cq_map, uring->cq_map_size);
+    }
+    if (uring->sq_map != NULL) {
+        munmap(uring->sq_map, uring->sq_map_size);
+    }
+    if (uring->fd >= 0) {
+        close(uring->fd);
+    }
+    free(uring);
+}
+
+static PakitStatus pakit_uring_create(PakitIoLoop* loop) {
+    PakitUring* uring = calloc(1, sizeof(PakitUring));
+    if (uring == NULL) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    unsigned entries = 8;
+    while (entries < loop->channel_count + 8 && entries < 4096) {
+        entries *= 2;
+    }
+
+    uring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (uring->fd < 0 || (params.features & IORING_FEAT_EXT_ARG) == 0) {
+        pakit_uring_free(uring);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    // Map the submission and completion rings (one mapping on newer kernels)
+    uring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    uring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (uring->cq_map_size > uring->sq_map_size) {
+            uring->sq_map_size = uring->cq_map_size;
+        }
+        uring->cq_map_size = uring->sq_map_size;
+    }
+
+    uring->sq_map = mmap(NULL, uring->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         uring->fd, IORING_OFF_SQ_RING);
+    if (uring->sq_map == MAP_FAILED) {
+        uring->sq_map = NULL;
+        pakit_uring_free(uring);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    uring->cq_map = uring->sq_map;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        uring->cq_map = mmap(NULL, uring->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             uring->fd, IORING_OFF_CQ_RING);
+        if (uring->cq_map == MAP_FAILED) {
+            uring->cq_map = NULL;
+            pakit_uring_free(uring);
+            return PAKIT_STATUS_ERROR_IO;
+        }
+    }
+
+    uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       uring->fd, IORING_OFF_SQES);
+    if (uring->sqes == MAP_FAILED) {
+        uring->sqes = NULL;
+        pakit_uring_free(uring);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    uint8_t* sq = uring->sq_map;
+    uint8_t* cq = uring->cq_map;
+    uring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    uring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    uring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    uring->sq_mask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    uring->sq_entries = params.sq_entries;
+    uring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    uring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    uring->cq_mask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    uring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    // Register the provided buffer ring the reads select their buffers from
+    uring->buf_ring_size = PAKIT_IO_URING_BUFFERS * sizeof(struct io_uring_buf);
+    uring->buf_ring = mmap(NULL, uring->buf_ring_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (uring->buf_ring == MAP_FAILED) {
+        uring->buf_ring = NULL;
+        pakit_uring_free(uring);
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    struct io_uring_buf_reg registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = (uint64_t)(uintptr_t)uring->buf_ring;
+    registration.ring_entries = PAKIT_IO_URING_BUFFERS;
+    registration.bgid = 0;
+    if (syscall(__NR_io_uring_register, uring->fd, IORING_REGISTER_PBUF_RING, &registration, 1) != 0) {
+        pakit_uring_free(uring);
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    loop->uring = uring;
+    for (uint16_t buffer = 0; buffer < PAKIT_IO_URING_BUFFERS; buffer++) {
+        pakit_uring_recycle(loop, buffer);
+    }
+
+    loop->fd = uring->fd;
+    return PAKIT_STATUS_SUCCESS;
+}
+
+// Processes one completion
+static void pakit_uring_complete(PakitIoLoop* loop, const struct io_uring_cqe* cqe, size_t* delivered) {
+    if (cqe->user_data == PAKIT_IO_CANCEL_TAG) {
+        return;
+    }
+
+    size_t channel = (size_t)(cqe->user_data & 0xFFFFFFFFu);
+    uint32_t generation = (uint32_t)(cqe->user_data >> 32);
+    PakitIoChannel* entry = &loop->channels[channel];
+    bool current = entry->attached && entry->generation == generation;
+
+    if (current && !(cqe->flags & IORING_CQE_F_MORE)) {
+        entry->armed = false;
+    }
+
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        uint16_t buffer = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        if (current && cqe->res > 0) {
+            *delivered += pakit_io_deliver(loop, channel,
+                                           &loop->buffers[(size_t)buffer * loop->buffer_size],
+                                           (size_t)cqe->res);
+        }
+        pakit_uring_recycle(loop, buffer);
+    }
+
+    if (!current || !entry->attached) {
+        return;
+    }
+
+    if (cqe->res == 0 || (cqe->res < 0 && cqe->res != -ENOBUFS && cqe->res != -EINTR &&
+                          cqe->res != -EAGAIN && cqe->res != -ECANCELED)) {
+        // End of stream or a hard error
+        pakit_io_close(loop, channel);
+    } else if (!entry->armed && !pakit_uring_arm(loop, channel)) {
+        // Single-shot read finished, or multishot stopped (e.g. out of buffers),
+        // and the submission queue is still full: pakit_io_uring_poll retries
+        entry->rearm = true;
+        loop->uring->rearm_count++;
+    }
+}
+
+// Queues the reads that found the submission queue full
+// Returns:
+//   true if no channel is left waiting for a read
+static bool pakit_uring_rearm(PakitIoLoop* loop) {
+    PakitUring* uring = loop->uring;
+
+    for (size_t channel = 0; channel < loop->channel_count && uring->rearm_count > 0; channel++) {
+        PakitIoChannel* entry = &loop->channels[channel];
+        if (!entry->rearm) {
+            continue;
+        }
+        if (!pakit_uring_arm(loop, channel)) {
+            return false;
+        }
+        entry->rearm = false;
+        uring->rearm_count--;
+    }
+
+    return true;
+}
+
+static PakitStatus pakit_io_uring_poll(PakitIoLoop* loop, int timeout_ms, size_t* delivered) {
+    PakitUring* uring = loop->uring;
+    unsigned head = *uring->cq_head;
+
+    // Submit queued reads and wait for at least one completion, unless a
+    // channel still has no read to complete
+    bool rearmed = pakit_uring_rearm(loop);
+    if (head == __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE) && timeout_ms != 0 && rearmed) {
+        struct __kernel_timespec timeout = {timeout_ms / 1000, (long long)(timeout_ms % 1000) * 1000000};
+        struct io_uring_getevents_arg argument;
+        memset(&argument, 0, sizeof(argument));
+        argument.sigmask_sz = _NSIG / 8;
+        argument.ts = (timeout_ms > 0) ? (uint64_t)(uintptr_t)&timeout : 0;
+
+        int result = pakit_uring_enter(uring, uring->pending, 1,
+                                       IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                       &argument, sizeof(argument));
+        if (result >= 0) {
+            uring->pending -= (unsigned)result;
+        } else if (errno != ETIME && errno != EINTR) {
+            return PAKIT_STATUS_ERROR_IO;
+        }
+    } else {
+        pakit_uring_submit(uring);
+    }
+
+    unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        struct io_uring_cqe cqe = uring->cqes[head & uring->cq_mask];
+        head++;
+        __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+
+        pakit_uring_complete(loop, &cqe, delivered);
+        tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+    }
+
+    // Re-armed reads go out now rather than on the next poll
+    pakit_uring_rearm(loop);
+    pakit_uring_submit(uring);
+    return PAKIT_STATUS_SUCCESS;
+}
+
+#endif // PAKIT_IO_HAVE_URING
+
+// ---------------------------------------------------------------------------
+// Common entry points
+
+PakitStatus pakit_io_create(PakitIoLoop* loop, PakitIoBackend backend,
+                            size_t channel_count, size_t buffer_size) {
+    if (loop == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    memset(loop, 0, sizeof(PakitIoLoop));
+    loop->backend = backend;
+    loop->fd = -1;
+    loop->channel_count = channel_count;
+    loop->buffer_size = (buffer_size != 0) ? buffer_size : PAKIT_IO_BUFFER_SIZE;
+
+    size_t buffer_count = (backend == PAKIT_IO_URING) ? PAKIT_IO_URING_BUFFERS : 1;
+    loop->channels = calloc(channel_count > 0 ? channel_count : 1, sizeof(PakitIoChannel));
+    loop->buffers = malloc(buffer_count * loop->buffer_size);
+    if (loop->channels == NULL || loop->buffers == NULL) {
+        pakit_io_destroy(loop);
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    PakitStatus status = PAKIT_STATUS_ERROR_IO;
+    if (backend == PAKIT_IO_EPOLL) {
+        loop->fd = epoll_create1(EPOLL_CLOEXEC);
+        status = (loop->fd >= 0) ? PAKIT_STATUS_SUCCESS : PAKIT_STATUS_ERROR_IO;
+    }
+#if defined(PAKIT_IO_HAVE_URING)
+    else if (backend == PAKIT_IO_URING) {
+        status = pakit_uring_create(loop);
+    }
+#endif
+
+    if (status != PAKIT_STATUS_SUCCESS) {
+        pakit_io_destroy(loop);
+    }
+    return status;
+}
+
+void pakit_io_destroy(PakitIoLoop* loop) {
+    if (loop == NULL) {
+        return;
+    }
+
+#if defined(PAKIT_IO_HAVE_URING)
+    if (loop->uring != NULL) {
+        // Closing the ring cancels every outstanding read
+        pakit_uring_free(loop->uring);
+        loop->fd = -1;
+    }
+#endif
+    if (loop->fd >= 0) {
+        close(loop->fd);
+    }
+
+    free(loop->channels);
+    free(loop->buffers);
+    memset(loop, 0, sizeof(PakitIoLoop));
+    loop->fd = -1;
+}
+
+PakitStatus pakit_io_attach(PakitIoLoop* loop, int fd, PakitReceiver* receiver,
+                            PakitIoCallback callback, void* context, size_t* channel) {
+    if (loop == NULL || loop->channels == NULL || fd < 0 || receiver == NULL || callback == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    size_t slot = 0;
+    while (slot < loop->channel_count && loop->channels[slot].attached) {
+        slot++;
+    }
+    if (slot == loop->channel_count) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    PakitIoChannel* entry = &loop->channels[slot];
+    struct stat info;
+    entry->fd = fd;
+    entry->receiver = receiver;
+    entry->callback = callback;
+    entry->context = context;
+    entry->socket = fstat(fd, &info) == 0 && S_ISSOCK(info.st_mode);
+    entry->armed = false;
+    entry->rearm = false;
+
+    bool registered = false;
+    if (loop->backend == PAKIT_IO_EPOLL) {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.u64 = slot;
+        registered = epoll_ctl(loop->fd, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+#if defined(PAKIT_IO_HAVE_URING)
+    else if (loop->uring != NULL) {
+        registered = pakit_uring_arm(loop, slot);
+    }
+#endif
+    if (!registered) {
+        return PAKIT_STATUS_ERROR_IO;
+    }
+
+    entry->attached = true;
+    if (channel != NULL) {
+        *channel = slot;
+    }
+    return PAKIT_STATUS_SUCCESS;
+}
+
+PakitStatus pakit_io_detach(PakitIoLoop* loop, size_t channel) {
+    if (loop == NULL || channel >= loop->channel_count || !loop->channels[channel].attached) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    PakitIoChannel* entry = &loop->channels[channel];
+    if (loop->backend == PAKIT_IO_EPOLL) {
+        epoll_ctl(loop->fd, EPOLL_CTL_DEL, entry->fd, NULL);
+    }
+#if defined(PAKIT_IO_HAVE_URING)
+    else if (loop->uring != NULL && entry->armed) {
+        // Cancel the outstanding read so the caller may close the descriptor.
+        // Without a free SQE the read stays in flight, so the channel does too.
+        struct io_uring_sqe* sqe = pakit_uring_sqe(loop->uring);
+        if (sqe == NULL) {
+            return PAKIT_STATUS_ERROR_IO;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = pakit_uring_tag(loop, channel);
+        sqe->user_data = PAKIT_IO_CANCEL_TAG;
+        pakit_uring_queue(loop->uring);
+        pakit_uring_submit(loop->uring);
+    }
+    if (loop->uring != NULL && entry->rearm) {
+        loop->uring->rearm_count--;
+    }
+#endif
+
+    // Later completions of this use of the slot are ignored
+    entry->attached = false;
+    entry->armed = false;
+    entry->rearm = false;
+    entry->generation++;
+    return PAKIT_STATUS_SUCCESS;
+}
+
+PakitStatus pakit_io_poll(PakitIoLoop* loop, int timeout_ms, size_t* delivered) {
+    size_t count = 0;
+    PakitStatus status = PAKIT_STATUS_ERROR_NULL_PARAM;
+
+    if (loop != NULL && loop->channels != NULL) {
+        if (loop->backend == PAKIT_IO_EPOLL) {
+            status = pakit_io_epoll_poll(loop, timeout_ms, &count);
+        }
+#if defined(PAKIT_IO_HAVE_URING)
+        else if (loop->uring != NULL) {
+            status = pakit_io_uring_poll(loop, timeout_ms, &count);
+        }
+#endif
+    }
+
+    if (delivered != NULL) {
+        *delivered = count;
+    }
+    return status;
+}
+
+#endif // PAKIT_HAVE_IO
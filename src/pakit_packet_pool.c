@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <string.h>
+#include "pakit_packet_pool.h"
+#include "pakit_internal.h"
+
+// Bytes reserved ahead of each payload for its PakitPacket
+#define PAKIT_PACKET_HEADROOM \
+    ((sizeof(PakitPacket) + PAKIT_CACHE_LINE - 1) & ~(size_t)(PAKIT_CACHE_LINE - 1))
+
+static PakitPacket* pakit_pool_slot(const PakitPacketPool* pool, uint32_t index) {
+    return (PakitPacket*)&pool->slab[(size_t)index * pool->slot_size];
+}
+
+// Freelist head with the tag advanced, so a slot popped and pushed back in
+// between is not mistaken for an unchanged head
+static uint64_t pakit_pool_head(uint64_t previous, uint32_t index) {
+    return (((previous >> 32) + 1) << 32) | index;
+}
+
+static void pakit_pool_push(PakitPacketPool* pool, PakitPacket* packet) {
+    uint64_t head = atomic_load_explicit(&pool->free_head, memory_order_relaxed);
+    uint64_t desired;
+    do {
+        atomic_store_explicit(&packet->next, (uint32_t)head, memory_order_relaxed);
+        desired = pakit_pool_head(head, packet->index);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->free_head, &head, desired,
+                                                    memory_order_release, memory_order_relaxed));
+    // Release, so a thread that sees every slot free may tear the pool down
+    atomic_fetch_add_explicit(&pool->free_count, 1, memory_order_release);
+}
+
+PakitStatus pakit_packet_pool_create(PakitPacketPool* pool, uint32_t slot_count, uint16_t max_payload_size) {
+    if (pool == NULL || slot_count == 0 || slot_count == PAKIT_PACKET_NONE) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    memset(pool, 0, sizeof(PakitPacketPool));
+    pool->slot_count = slot_count;
+    pool->max_payload_size = max_payload_size;
+    pool->slot_size = (PAKIT_PACKET_HEADROOM + max_payload_size + PAKIT_CACHE_LINE - 1) &
+                      ~(size_t)(PAKIT_CACHE_LINE - 1);
+
+    pool->slab = aligned_alloc(PAKIT_CACHE_LINE, (size_t)slot_count * pool->slot_size);
+    if (pool->slab == NULL) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    // Chain the slots in address order
+    for (uint32_t i = 0; i < slot_count; i++) {
+        PakitPacket* packet = pakit_pool_slot(pool, i);
+        memset(packet, 0, sizeof(PakitPacket));
+        packet->pool = pool;
+        packet->index = i;
+        atomic_init(&packet->refs, 0);
+        atomic_init(&packet->next, (i + 1 < slot_count) ? i + 1 : PAKIT_PACKET_NONE);
+    }
+    atomic_init(&pool->free_head, 0);
+    atomic_init(&pool->free_count, slot_count);
+
+    return PAKIT_STATUS_SUCCESS;
+}
+
+void pakit_packet_pool_destroy(PakitPacketPool* pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    free(pool->slab);
+    memset(pool, 0, sizeof(PakitPacketPool));
+}
+
+PakitPacket* pakit_packet_acquire(PakitPacketPool* pool) {
+    if (pool == NULL || pool->slab == NULL) {
+        return NULL;
+    }
+
+    uint64_t head = atomic_load_explicit(&pool->free_head, memory_order_acquire);
+    PakitPacket* packet;
+    uint64_t desired;
+    do {
+        uint32_t index = (uint32_t)head;
+        if (index == PAKIT_PACKET_NONE) {
+            return NULL;
+        }
+
+        // The slot may be taken meanwhile; the tag then fails the exchange
+        packet = pakit_pool_slot(pool, index);
+        desired = pakit_pool_head(head, atomic_load_explicit(&packet->next, memory_order_relaxed));
+    } while (!atomic_compare_exchange_weak_explicit(&pool->free_head, &head, desired,
+                                                    memory_order_acquire, memory_order_acquire));
+    atomic_fetch_sub_explicit(&pool->free_count, 1, memory_order_relaxed);
+
+    atomic_store_explicit(&packet->refs, 1, memory_order_relaxed);
+    packet->view.type = 0;
+    packet->view.count = 0;
+    packet->view.size = 0;
+    packet->view.payload = pakit_packet_data(packet);
+    return packet;
+}
+
+void pakit_packet_retain(PakitPacket* packet) {
+    if (packet != NULL) {
+        atomic_fetch_add_explicit(&packet->refs, 1, memory_order_relaxed);
+    }
+}
+
+bool pakit_packet_release(PakitPacket* packet) {
+    if (packet == NULL) {
+        return false;
+    }
+
+    // Release orders this owner's accesses before the slot is reused
+    if (atomic_fetch_sub_explicit(&packet->refs, 1, memory_order_acq_rel) != 1) {
+        return false;
+    }
+
+    pakit_pool_push(packet->pool, packet);
+    return true;
+}
+
+PakitPacket* pakit_packet_from_view(PakitPacketPool* pool, const PakitView* view) {
+    if (pool == NULL || view == NULL || view->size > pool->max_payload_size ||
+        (view->payload == NULL && view->size > 0)) {
+        return NULL;
+    }
+
+    PakitPacket* packet = pakit_packet_acquire(pool);
+    if (packet != NULL) {
+        if (view->size > 0) {
+            memcpy(pakit_packet_data(packet), view->payload, view->size);
+        }
+        packet->view.type = view->type;
+        packet->view.count = view->count;
+        packet->view.size = view->size;
+    }
+    return packet;
+}
+
+PakitStatus pakit_attach_packet_pool(PakitReceiver* receiver, PakitPacketPool* pool) {
+    // The receiver always keeps a slot, so handing one out needs a second
+    if (receiver == NULL || pool == NULL || receiver->pooled != NULL || pool->slot_count < 2) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    PakitPacket* packet = pakit_packet_acquire(pool);
+    if (packet == NULL) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    if (receiver->owns_storage) {
+        free(receiver->payload);
+        receiver->owns_storage = false;
+    }
+    receiver->pooled = packet;
+    receiver->payload = pakit_packet_data(packet);
+    receiver->max_payload_size = pool->max_payload_size;
+    pakit_init(receiver);
+
+    return PAKIT_STATUS_SUCCESS;
+}
+
+void pakit_packet_pool_release(PakitReceiver* receiver) {
+    if (receiver->pooled == NULL) {
+        return;
+    }
+
+    pakit_packet_release(receiver->pooled);
+    receiver->pooled = NULL;
+    receiver->payload = NULL;
+    receiver->max_payload_size = 0;
+}
+
+PakitPacket* pakit_take_packet(PakitReceiver* receiver) {
+    Packet complete;
+    if (receiver == NULL || receiver->pooled == NULL || receiver->state != STATE_COMPLETE ||
+        !pakit_is_packet_complete(receiver, &complete)) {
+        return NULL;
+    }
+
+    PakitPacket* fresh = pakit_packet_acquire(receiver->pooled->pool);
+    if (fresh == NULL) {
+        return NULL;
+    }
+
+    // The payload is already in the slot; only the header fields are filled in
+    PakitPacket* filled = receiver->pooled;
+    filled->view.type = ((uint16_t)complete.type[0] << 8) | complete.type[1];
+    filled->view.count = complete.count;
+    filled->view.size = complete.size;
+    filled->view.payload = pakit_packet_data(filled);
+
+    receiver->pooled = fresh;
+    receiver->payload = pakit_packet_data(fresh);
+    pakit_init(receiver);
+    return filled;
+}
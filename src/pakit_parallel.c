@@ -0,0 +1,355 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "pakit_parallel.h"
+#include "pakit_internal.h"
+
+typedef struct {
+    size_t offset;
+    PakitView view;
+} PakitChunkPacket;
+
+// One chunk of a window, decoded by one worker
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    uint16_t max_payload_size;
+    size_t chunk_start;
+    size_t chunk_end;
+    size_t start;                // Position decoding began at
+    size_t end;                  // Position after the last packet starting in the chunk
+    PakitChunkPacket* packets;
+    size_t count;
+    size_t capacity;
+    bool failed;                 // Packet list could not grow
+    bool ready;                  // Decoded and waiting to be stitched, under the pipeline lock
+} PakitChunk;
+
+// State shared by the workers and the delivering thread. Chunk i of the data
+// is decoded into slot i % slot_count, and the workers run up to slot_count
+// chunks ahead of delivery, so the next window is decoded while the current
+// one is stitched and delivered.
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work;         // Signalled when chunk_limit grows or on shutdown
+    pthread_cond_t done;         // Signalled when a chunk is decoded
+    const uint8_t* data;
+    size_t length;
+    size_t chunk_size;
+    uint16_t max_payload_size;
+    PakitChunk* chunks;
+    size_t slot_count;
+    size_t chunk_total;
+    size_t next_chunk;           // Next chunk to be decoded
+    size_t chunk_limit;          // Chunks below this have a free slot
+    bool shutdown;
+} PakitPipeline;
+
+// True if a header at pos looks like the start of a real packet: the size is
+// acceptable and, when there is room, another SOP follows the payload
+static bool pakit_plausible_header(const uint8_t* data, size_t length, size_t pos,
+                                   uint16_t max_payload_size) {
+    if (length - pos < HEADER_SIZE) {
+        return true;
+    }
+
+    uint16_t size = (uint16_t)pakit_header_word(&data[pos]);
+    if (size > max_payload_size) {
+        return false;
+    }
+
+    size_t next = pos + HEADER_SIZE + size;
+    if (next >= length) {
+        return true;
+    }
+    if (data[next] != EXPECTED_SOP_0) {
+        return false;
+    }
+    return next + 1 == length || data[next + 1] == EXPECTED_SOP_1;
+}
+
+// Finds the first plausible packet start in [from, limit), or limit if there is none
+static size_t pakit_find_safe_start(const uint8_t* data, size_t length, size_t from,
+                                    size_t limit, uint16_t max_payload_size) {
+    size_t scan_end = (limit < length) ? limit + 1 : length;
+    size_t pos = from;
+
+    while (pos < limit) {
+        pos += pakit_find_sop(&data[pos], scan_end - pos);
+        if (pos >= limit) {
+            break;
+        }
+        if (pakit_plausible_header(data, length, pos, max_payload_size)) {
+            return pos;
+        }
+        pos++;
+    }
+
+    return limit;
+}
+
+static bool pakit_chunk_append(PakitChunk* chunk, size_t offset, const PakitView* view) {
+    if (chunk->count == chunk->capacity) {
+        size_t capacity = (chunk->capacity == 0) ? 1024 : chunk->capacity * 2;
+        PakitChunkPacket* packets = realloc(chunk->packets, capacity * sizeof(PakitChunkPacket));
+        if (packets == NULL) {
+            chunk->failed = true;
+            return false;
+        }
+        chunk->packets = packets;
+        chunk->capacity = capacity;
+    }
+
+    chunk->packets[chunk->count].offset = offset;
+    chunk->packets[chunk->count].view = *view;
+    chunk->count++;
+    return true;
+}
+
+// Decodes the packets starting in the chunk, beginning at start. This is the
+// same loop a single receiver runs, so from a true packet boundary it produces
+// exactly the single-threaded result.
+static void pakit_decode_chunk(PakitChunk* chunk, size_t start) {
+    size_t pos = start;
+
+    chunk->start = start;
+    chunk->count = 0;
+    chunk->failed = false;
+
+    while (pos < chunk->chunk_end) {
+        size_t offset = pos;
+        PakitView view;
+        PakitStatus status = pakit_parse_view(chunk->data, chunk->length, &pos,
+                                              chunk->max_payload_size, &view);
+
+        if (status == PAKIT_STATUS_IN_PROGRESS) {
+            // Truncated final packet: nothing more can be decoded
+            pos = chunk->length;
+            break;
+        }
+        if (status == PAKIT_STATUS_SUCCESS && !pakit_chunk_append(chunk, offset, &view)) {
+            break;
+        }
+    }
+
+    chunk->end = pos;
+}
+
+// Decodes chunk index into its slot, from a safe start point found by scanning
+// unless the chunk begins the data
+static void pakit_pipeline_decode(PakitPipeline* pipeline, size_t index) {
+    PakitChunk* chunk = &pipeline->chunks[index % pipeline->slot_count];
+    size_t start = 0;
+
+    chunk->data = pipeline->data;
+    chunk->length = pipeline->length;
+    chunk->max_payload_size = pipeline->max_payload_size;
+    chunk->chunk_start = index * pipeline->chunk_size;
+    chunk->chunk_end = (pipeline->length - chunk->chunk_start > pipeline->chunk_size)
+                           ? chunk->chunk_start + pipeline->chunk_size : pipeline->length;
+    if (index != 0) {
+        start = pakit_find_safe_start(chunk->data, chunk->length, chunk->chunk_start,
+                                      chunk->chunk_end, chunk->max_payload_size);
+    }
+    pakit_decode_chunk(chunk, start);
+}
+
+// Takes the next chunk that has a free slot. Called with the lock held.
+static bool pakit_pipeline_claim(PakitPipeline* pipeline, size_t* index) {
+    if (pipeline->shutdown || pipeline->next_chunk >= pipeline->chunk_limit) {
+        return false;
+    }
+    *index = pipeline->next_chunk++;
+    return true;
+}
+
+// Decodes a claimed chunk and hands it to the delivering thread. Called with
+// the lock held; drops it while decoding.
+static void pakit_pipeline_run(PakitPipeline* pipeline, size_t index) {
+    pthread_mutex_unlock(&pipeline->lock);
+    pakit_pipeline_decode(pipeline, index);
+    pthread_mutex_lock(&pipeline->lock);
+
+    pipeline->chunks[index % pipeline->slot_count].ready = true;
+    pthread_cond_signal(&pipeline->done);
+}
+
+static void* pakit_pipeline_worker(void* argument) {
+    PakitPipeline* pipeline = argument;
+
+    pthread_mutex_lock(&pipeline->lock);
+    while (!pipeline->shutdown && pipeline->next_chunk < pipeline->chunk_total) {
+        size_t index;
+        if (pakit_pipeline_claim(pipeline, &index)) {
+            pakit_pipeline_run(pipeline, index);
+        } else {
+            pthread_cond_wait(&pipeline->work, &pipeline->lock);
+        }
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+
+    return NULL;
+}
+
+// Returns chunk index once it is decoded. Rather than sit idle, the delivering
+// thread decodes pending chunks itself, so this finishes even with no workers.
+static PakitChunk* pakit_pipeline_wait(PakitPipeline* pipeline, size_t index) {
+    PakitChunk* chunk = &pipeline->chunks[index % pipeline->slot_count];
+
+    pthread_mutex_lock(&pipeline->lock);
+    while (!chunk->ready) {
+        size_t pending;
+        if (pakit_pipeline_claim(pipeline, &pending)) {
+            pakit_pipeline_run(pipeline, pending);
+        } else {
+            pthread_cond_wait(&pipeline->done, &pipeline->lock);
+        }
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+
+    return chunk;
+}
+
+// Frees the slot of a delivered chunk for the chunk slot_count ahead of it
+static void pakit_pipeline_release(PakitPipeline* pipeline, size_t index) {
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->chunks[index % pipeline->slot_count].ready = false;
+    if (pipeline->chunk_limit < pipeline->chunk_total) {
+        pipeline->chunk_limit++;
+        pthread_cond_signal(&pipeline->work);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+// Decodes one chunk on the calling thread and delivers its packets directly.
+// Used when a chunk's packet list could not be allocated.
+static size_t pakit_emit_chunk(const PakitChunk* chunk, size_t start, PakitPacketCallback callback,
+                               void* context, size_t* delivered, bool* stop) {
+    size_t pos = start;
+
+    while (pos < chunk->chunk_end && !*stop) {
+        size_t offset = pos;
+        PakitView view;
+        PakitStatus status = pakit_parse_view(chunk->data, chunk->length, &pos,
+                                              chunk->max_payload_size, &view);
+
+        if (status == PAKIT_STATUS_IN_PROGRESS) {
+            return chunk->length;
+        }
+        if (status == PAKIT_STATUS_SUCCESS) {
+            (*delivered)++;
+            *stop = !callback(context, offset, &view);
+        }
+    }
+
+    return pos;
+}
+
+size_t pakit_decode_parallel(const uint8_t* data, size_t length,
+                             const PakitParallelOptions* options,
+                             PakitPacketCallback callback, void* context) {
+    if (data == NULL || callback == NULL || length == 0) {
+        return 0;
+    }
+
+    unsigned thread_count = (options != NULL) ? options->thread_count : 0;
+    size_t chunk_size = (options != NULL) ? options->chunk_size : 0;
+    uint16_t max_payload_size = (options != NULL) ? options->max_payload_size : 0;
+
+    if (thread_count == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (online > 0) ? (unsigned)online : 1;
+    }
+    if (chunk_size == 0) {
+        chunk_size = PAKIT_PARALLEL_CHUNK_SIZE;
+    }
+    if (max_payload_size == 0) {
+        max_payload_size = MAX_PACKET_SIZE;
+    }
+
+    PakitPipeline pipeline;
+    pipeline.data = data;
+    pipeline.length = length;
+    pipeline.chunk_size = chunk_size;
+    pipeline.max_payload_size = max_payload_size;
+    pipeline.chunk_total = (length - 1) / chunk_size + 1;
+    if (thread_count > pipeline.chunk_total) {
+        thread_count = (unsigned)pipeline.chunk_total;
+    }
+
+    // Two windows of thread_count chunks: one being delivered, one being decoded
+    pipeline.slot_count = 2 * (size_t)thread_count;
+    if (pipeline.slot_count > pipeline.chunk_total) {
+        pipeline.slot_count = pipeline.chunk_total;
+    }
+    pipeline.next_chunk = 0;
+    pipeline.chunk_limit = pipeline.slot_count;
+    pipeline.shutdown = false;
+
+    pipeline.chunks = calloc(pipeline.slot_count, sizeof(PakitChunk));
+    pthread_t* threads = calloc(thread_count, sizeof(pthread_t));
+    if (pipeline.chunks == NULL || threads == NULL) {
+        free(pipeline.chunks);
+        free(threads);
+        return 0;
+    }
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.work, NULL);
+    pthread_cond_init(&pipeline.done, NULL);
+
+    // Workers that fail to start are made up for by pakit_pipeline_wait
+    unsigned started = 0;
+    for (unsigned k = 0; k < thread_count; k++) {
+        if (pthread_create(&threads[started], NULL, pakit_pipeline_worker, &pipeline) == 0) {
+            started++;
+        }
+    }
+
+    size_t delivered = 0;
+    size_t entry = 0;   // Where the single-threaded decoder stands
+    bool stop = false;
+
+    // Stitch the chunks together in order while the workers decode ahead
+    for (size_t index = 0; index < pipeline.chunk_total && entry < length && !stop; index++) {
+        PakitChunk* chunk = pakit_pipeline_wait(&pipeline, index);
+
+        // Unless a packet from an earlier chunk covers this one entirely
+        if (entry < chunk->chunk_end) {
+            // The speculative start was not a real packet boundary
+            if (chunk->start != entry) {
+                pakit_decode_chunk(chunk, entry);
+            }
+
+            if (chunk->failed) {
+                entry = pakit_emit_chunk(chunk, entry, callback, context, &delivered, &stop);
+            } else {
+                for (size_t i = 0; i < chunk->count && !stop; i++) {
+                    delivered++;
+                    stop = !callback(context, chunk->packets[i].offset, &chunk->packets[i].view);
+                }
+                entry = chunk->end;
+            }
+        }
+
+        pakit_pipeline_release(&pipeline, index);
+    }
+
+    pthread_mutex_lock(&pipeline.lock);
+    pipeline.shutdown = true;
+    pthread_cond_broadcast(&pipeline.work);
+    pthread_mutex_unlock(&pipeline.lock);
+    for (unsigned k = 0; k < started; k++) {
+        pthread_join(threads[k], NULL);
+    }
+
+    pthread_cond_destroy(&pipeline.done);
+    pthread_cond_destroy(&pipeline.work);
+    pthread_mutex_destroy(&pipeline.lock);
+    for (size_t k = 0; k < pipeline.slot_count; k++) {
+        free(pipeline.chunks[k].packets);
+    }
+    free(pipeline.chunks);
+    free(threads);
+
+    return delivered;
+}
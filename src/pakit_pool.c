@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <string.h>
+#include "pakit_pool.h"
+#include "pakit_internal.h"
+
+
+PakitStatus pakit_pool_create(PakitReceiverPool* pool, size_t channel_count,
+                              uint32_t slot_count, uint16_t max_payload_size) {
+    if (pool == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    memset(pool, 0, sizeof(PakitReceiverPool));
+
+    // Refuse sizes whose arrays cannot be described by size_t; a header is the
+    // largest per-channel element
+    size_t slots = slot_count;
+    if (channel_count > SIZE_MAX / sizeof(PacketHeader) || slots > SIZE_MAX / sizeof(uint32_t) ||
+        (slots > 0 && max_payload_size > SIZE_MAX / slots)) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    pool->channel_count = channel_count;
+    pool->max_payload_size = max_payload_size;
+    pool->slot_count = slot_count;
+
+    pool->state = malloc(channel_count * sizeof(uint8_t));
+    pool->received_bytes = malloc(channel_count * sizeof(uint32_t));
+    pool->expected_payload_size = malloc(channel_count * sizeof(uint16_t));
+    pool->slot = malloc(channel_count * sizeof(uint32_t));
+    pool->headers = malloc(channel_count * sizeof(PacketHeader));
+    pool->slab = malloc((size_t)slot_count * max_payload_size);
+    pool->free_slots = malloc(slot_count * sizeof(uint32_t));
+
+    if ((channel_count > 0 && (pool->state == NULL || pool->received_bytes == NULL ||
+                               pool->expected_payload_size == NULL || pool->slot == NULL ||
+                               pool->headers == NULL)) ||
+        (slot_count > 0 && (pool->free_slots == NULL ||
+                            (max_payload_size > 0 && pool->slab == NULL)))) {
+        pakit_pool_destroy(pool);
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    // Every slot starts out free
+    for (uint32_t i = 0; i < slot_count; i++) {
+        pool->free_slots[i] = slot_count - 1 - i;
+    }
+    pool->free_count = slot_count;
+
+    for (size_t channel = 0; channel < channel_count; channel++) {
+        pool->state[channel] = STATE_UNIQUE_SOP;
+        pool->received_bytes[channel] = 0;
+        pool->expected_payload_size[channel] = 0;
+        pool->slot[channel] = PAKIT_POOL_NO_SLOT;
+    }
+
+    return PAKIT_STATUS_SUCCESS;
+}
+
+void pakit_pool_destroy(PakitReceiverPool* pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    free(pool->state);
+    free(pool->received_bytes);
+    free(pool->expected_payload_size);
+    free(pool->slot);
+    free(pool->headers);
+    free(pool->slab);
+    free(pool->free_slots);
+    memset(pool, 0, sizeof(PakitReceiverPool));
+}
+
+void pakit_pool_reset(PakitReceiverPool* pool, size_t channel) {
+    if (pool == NULL || channel >= pool->channel_count) {
+        return;
+    }
+
+    // Hand the payload slot back to the slab
+    if (pool->slot[channel] != PAKIT_POOL_NO_SLOT) {
+        pool->free_slots[pool->free_count++] = pool->slot[channel];
+        pool->slot[channel] = PAKIT_POOL_NO_SLOT;
+    }
+
+    pool->state[channel] = STATE_UNIQUE_SOP;
+    pool->received_bytes[channel] = 0;
+    pool->expected_payload_size[channel] = 0;
+}
+
+static uint8_t* pakit_pool_slot_data(const PakitReceiverPool* pool, uint32_t slot) {
+    return &pool->slab[(size_t)slot * pool->max_payload_size];
+}
+
+// Fills a view from the packet staged in a channel
+static void pakit_pool_view(const PakitReceiverPool* pool, size_t channel, PakitView* view) {
+    const PacketHeader* header = &pool->headers[channel];
+    uint64_t word = pakit_header_word((const uint8_t*)header);
+
+    view->type = (uint16_t)(word >> 32);
+    view->count = (uint16_t)(word >> 16);
+    view->size = pool->expected_payload_size[channel];
+    // A zero-size packet takes no slot and has no payload to point at
+    view->payload = (pool->slot[channel] != PAKIT_POOL_NO_SLOT)
+                        ? pakit_pool_slot_data(pool, pool->slot[channel])
+                        : NULL;
+}
+
+// Stores one header byte for a channel, mirroring the pakit_receive_byte checks
+static PakitStatus pakit_pool_header_byte(PakitReceiverPool* pool, size_t channel, uint8_t byte) {
+    uint8_t* header = (uint8_t*)&pool->headers[channel];
+    uint32_t received = pool->received_bytes[channel];
+
+    header[received++] = byte;
+    pool->received_bytes[channel] = received;
+
+    if (received == 1 && byte != EXPECTED_SOP_0) {
+        pakit_pool_reset(pool, channel);
+        return PAKIT_STATUS_ERROR_INVALID_SOP;
+    }
+    if (received == 2 && byte != EXPECTED_SOP_1) {
+        pakit_pool_reset(pool, channel);
+
+        // A repeated first SOP byte may still start the next packet
+        if (byte == EXPECTED_SOP_0) {
+            header[0] = byte;
+            pool->received_bytes[channel] = 1;
+        }
+        return PAKIT_STATUS_ERROR_INVALID_SOP;
+    }
+    if (received < HEADER_SIZE) {
+        return PAKIT_STATUS_IN_PROGRESS;
+    }
+
+    // Header complete: validate the payload size
+    uint16_t size = (uint16_t)pakit_header_word((const uint8_t*)&pool->headers[channel]);
+
+    if (size > pool->max_payload_size) {
+        pakit_pool_reset(pool, channel);
+        return PAKIT_STATUS_ERROR_SIZE_LARGE;
+    }
+
+    pool->expected_payload_size[channel] = size;
+    if (size == 0) {
+        pool->state[channel] = STATE_COMPLETE;
+        return PAKIT_STATUS_SUCCESS;
+    }
+
+    // Take payload storage for the packet now that it is in flight
+    if (pool->free_count == 0) {
+        pakit_pool_reset(pool, channel);
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+    pool->slot[channel] = pool->free_slots[--pool->free_count];
+    pool->state[channel] = STATE_PAYLOAD;
+
+    return PAKIT_STATUS_IN_PROGRESS;
+}
+
+PakitStatus pakit_pool_receive(PakitReceiverPool* pool, size_t channel,
+                               const uint8_t* buffer, size_t buffer_length,
+                               size_t* position, PakitView* view) {
+    // Check for null parameters (but position can be NULL)
+    if (pool == NULL || buffer == NULL || view == NULL || channel >= pool->channel_count) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    size_t current_pos = (position != NULL) ? *position : 0;
+    PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
+
+    // The packet delivered by the previous call is released
+    if (pool->state[channel] == STATE_COMPLETE) {
+        pakit_pool_reset(pool, channel);
+    }
+
+    while (current_pos < buffer_length && status == PAKIT_STATUS_IN_PROGRESS) {
+        uint32_t received = pool->received_bytes[channel];
+
+        if (received == 0) {
+            // Idle channel: decode in place when the whole packet is here
+            status = pakit_parse_view(buffer, buffer_length, &current_pos,
+                                      pool->max_payload_size, view);
+            if (status != PAKIT_STATUS_IN_PROGRESS) {
+                break;
+            }
+        }
+
+        if (received < HEADER_SIZE) {
+            status = pakit_pool_header_byte(pool, channel, buffer[current_pos++]);
+        } else {
+            // Copy as much of the outstanding payload as is available
+            uint32_t payload_received = received - HEADER_SIZE;
+            size_t remaining = pool->expected_payload_size[channel] - payload_received;
+            size_t available = buffer_length - current_pos;
+            size_t count = (available < remaining) ? available : remaining;
+
+            memcpy(pakit_pool_slot_data(pool, pool->slot[channel]) + payload_received,
+                   &buffer[current_pos], count);
+            pool->received_bytes[channel] = received + (uint32_t)count;
+            current_pos += count;
+
+            if (count == remaining) {
+                pool->state[channel] = STATE_COMPLETE;
+                status = PAKIT_STATUS_SUCCESS;
+            }
+        }
+
+        if (status == PAKIT_STATUS_SUCCESS) {
+            pakit_pool_view(pool, channel, view);
+        }
+    }
+
+    if (position != NULL) {
+        *position = current_pos;
+    }
+
+    return status;
+}
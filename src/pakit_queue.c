@@ -0,0 +1,179 @@
+#define _POSIX_C_SOURCE 200809L  // sched_yield
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pakit_queue.h"
+
+PakitStatus pakit_queue_create(PakitQueue* queue, size_t capacity) {
+    if (queue == NULL || capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    queue->cells = malloc(capacity * sizeof(PakitQueueCell));
+    if (queue->cells == NULL) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    // Cell i is first pushed at position i
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&queue->cells[i].sequence, i);
+        queue->cells[i].packet = NULL;
+    }
+    queue->mask = capacity - 1;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+
+    return PAKIT_STATUS_SUCCESS;
+}
+
+void pakit_queue_destroy(PakitQueue* queue) {
+    if (queue != NULL) {
+        free(queue->cells);
+        queue->cells = NULL;
+        queue->mask = 0;
+    }
+}
+
+bool pakit_queue_push(PakitQueue* queue, PakitPacket* packet) {
+    size_t position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    PakitQueueCell* cell;
+
+    while (true) {
+        cell = &queue->cells[position & queue->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0) {
+            // The cell is free for this position; claim it
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The cell still holds the packet of the previous lap
+            return false;
+        } else {
+            position = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        }
+    }
+
+    cell->packet = packet;
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    return true;
+}
+
+// Removes one packet, or returns NULL if the queue is empty
+static PakitPacket* pakit_queue_pop(PakitQueue* queue) {
+    size_t position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    PakitQueueCell* cell;
+
+    while (true) {
+        cell = &queue->cells[position & queue->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return NULL;
+        } else {
+            position = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+
+    PakitPacket* packet = cell->packet;
+    // Hand the cell to the producer one lap ahead
+    atomic_store_explicit(&cell->sequence, position + queue->mask + 1, memory_order_release);
+    return packet;
+}
+
+size_t pakit_queue_pop_batch(PakitQueue* queue, PakitPacket** packets, size_t max_packets) {
+    size_t count = 0;
+
+    if (queue != NULL && packets != NULL) {
+        while (count < max_packets) {
+            PakitPacket* packet = pakit_queue_pop(queue);
+            if (packet == NULL) {
+                break;
+            }
+            packets[count++] = packet;
+        }
+    }
+
+    return count;
+}
+
+PakitStatus pakit_shards_create(PakitShardedQueue* queue, size_t shard_count, size_t capacity) {
+    if (queue == NULL || shard_count == 0) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    queue->shards = aligned_alloc(PAKIT_CACHE_LINE, shard_count * sizeof(PakitQueue));
+    queue->shard_count = 0;
+    if (queue->shards == NULL) {
+        return PAKIT_STATUS_ERROR_NO_MEMORY;
+    }
+
+    for (size_t i = 0; i < shard_count; i++) {
+        PakitStatus status = pakit_queue_create(&queue->shards[i], capacity);
+        if (status != PAKIT_STATUS_SUCCESS) {
+            pakit_shards_destroy(queue);
+            return status;
+        }
+        queue->shard_count++;
+    }
+
+    return PAKIT_STATUS_SUCCESS;
+}
+
+void pakit_shards_destroy(PakitShardedQueue* queue) {
+    if (queue == NULL || queue->shards == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < queue->shard_count; i++) {
+        pakit_queue_destroy(&queue->shards[i]);
+    }
+    free(queue->shards);
+    queue->shards = NULL;
+    queue->shard_count = 0;
+}
+
+bool pakit_shards_push(PakitShardedQueue* queue, PakitPacket* packet) {
+    return pakit_queue_push(&queue->shards[pakit_shard_for_type(queue, packet->view.type)], packet);
+}
+
+size_t pakit_receive_enqueue(PakitReceiver* receiver, const uint8_t* buffer, size_t buffer_length,
+                             PakitShardedQueue* queue, size_t* consumed) {
+    size_t queued = 0;
+    size_t position = 0;
+
+    if (receiver != NULL && receiver->pooled != NULL && buffer != NULL &&
+        queue != NULL && queue->shard_count > 0) {
+        while (position < buffer_length) {
+            if (pakit_receive_buffer(receiver, buffer, buffer_length, &position) != PAKIT_STATUS_SUCCESS) {
+                continue;
+            }
+
+            // Wait for a free slot, then for room in the shard
+            PakitPacket* packet;
+            while ((packet = pakit_take_packet(receiver)) == NULL) {
+                sched_yield();
+            }
+            while (!pakit_shards_push(queue, packet)) {
+                sched_yield();
+            }
+            queued++;
+        }
+    }
+
+    if (consumed != NULL) {
+        *consumed = position;
+    }
+
+    return queued;
+}
@@ -0,0 +1,90 @@
+#include <string.h>
+#include "pakit_ring.h"
+
+
+bool pakit_ring_init(PakitRing* ring, uint8_t* storage, size_t capacity) {
+    if (ring == NULL || storage == NULL || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+
+    ring->data = storage;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+
+    return true;
+}
+
+size_t pakit_ring_used(PakitRing* ring) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head - tail;
+}
+
+size_t pakit_ring_write(PakitRing* ring, const uint8_t* data, size_t length) {
+    if (ring == NULL || data == NULL) {
+        return 0;
+    }
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t space = ring->mask + 1 - (head - tail);
+    size_t count = (length < space) ? length : space;
+
+    // Copy in up to two pieces around the end of storage
+    size_t offset = head & ring->mask;
+    size_t first = ring->mask + 1 - offset;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(&ring->data[offset], data, first);
+    memcpy(ring->data, &data[first], count - first);
+
+    atomic_store_explicit(&ring->head, head + count, memory_order_release);
+    return count;
+}
+
+size_t pakit_ring_peek(PakitRing* ring,
+                       const uint8_t** first, size_t* first_length,
+                       const uint8_t** second, size_t* second_length) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t used = head - tail;
+    size_t offset = tail & ring->mask;
+    size_t contiguous = ring->mask + 1 - offset;
+
+    *first = &ring->data[offset];
+    *first_length = (used < contiguous) ? used : contiguous;
+    *second = ring->data;
+    *second_length = used - *first_length;
+
+    return used;
+}
+
+void pakit_ring_consume(PakitRing* ring, size_t count) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+}
+
+PakitStatus pakit_receive_ring(PakitReceiver* receiver, PakitRing* ring) {
+    if (receiver == NULL || ring == NULL) {
+        return PAKIT_STATUS_ERROR_NULL_PARAM;
+    }
+
+    const uint8_t* spans[2];
+    size_t lengths[2];
+    pakit_ring_peek(ring, &spans[0], &lengths[0], &spans[1], &lengths[1]);
+
+    PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
+    size_t consumed = 0;
+
+    // Parse each span in place; a packet may straddle the wrap point
+    for (int i = 0; i < 2 && status == PAKIT_STATUS_IN_PROGRESS; i++) {
+        size_t position = 0;
+        status = pakit_receive_buffer(receiver, spans[i], lengths[i], &position);
+        consumed += position;
+    }
+
+    pakit_ring_consume(ring, consumed);
+    return status;
+}
@@ -0,0 +1,106 @@
+#include <string.h>
+#include "pakit_sequence.h"
+
+bool pakit_sequence_init(PakitSequenceTracker* tracker, PakitSequenceEntry* entries,
+                         size_t capacity, bool per_type) {
+    // Capacity must be a non-zero power of two for the probe mask
+    if (tracker == NULL || entries == NULL || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+
+    tracker->entries = entries;
+    tracker->mask = capacity - 1;
+    tracker->shift = 32;
+    for (size_t size = capacity; size > 1 && tracker->shift > 0; size >>= 1) {
+        tracker->shift--;
+    }
+    tracker->per_type = per_type;
+    pakit_sequence_reset(tracker);
+
+    return true;
+}
+
+void pakit_sequence_reset(PakitSequenceTracker* tracker) {
+    if (tracker == NULL) {
+        return;
+    }
+
+    memset(tracker->entries, 0, (tracker->mask + 1) * sizeof(PakitSequenceEntry));
+    memset(&tracker->stats, 0, sizeof(tracker->stats));
+    tracker->last_event = PAKIT_SEQUENCE_FIRST;
+    tracker->last_gap = 0;
+}
+
+// Finds the entry of a type, claiming a free one on first sight. Linear probing
+// from a Fibonacci hash; NULL when the table is full. The top bits of the
+// product depend on every bit of the type, so types that differ only in their
+// high byte (0x0100, 0x0200, ...) still spread over the table.
+static PakitSequenceEntry* pakit_sequence_entry(PakitSequenceTracker* tracker, uint16_t type) {
+    uint64_t product = (uint32_t)type * 2654435769u;
+    size_t index = (size_t)(product >> tracker->shift);
+
+    for (size_t probe = 0; probe <= tracker->mask; probe++) {
+        PakitSequenceEntry* entry = &tracker->entries[(index + probe) & tracker->mask];
+        if (!entry->used || entry->type == type) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+PakitSequenceEvent pakit_sequence_update(PakitSequenceTracker* tracker, uint16_t type, uint16_t count) {
+    if (tracker == NULL) {
+        return PAKIT_SEQUENCE_UNTRACKED;
+    }
+
+    PakitSequenceEntry* entry = pakit_sequence_entry(tracker, tracker->per_type ? type : 0);
+    PakitSequenceEvent event;
+    tracker->last_gap = 0;
+
+    if (entry == NULL) {
+        tracker->stats.untracked++;
+        tracker->last_event = PAKIT_SEQUENCE_UNTRACKED;
+        return PAKIT_SEQUENCE_UNTRACKED;
+    }
+
+    // Distance ahead of the expected count, modulo 2^16
+    uint16_t ahead = (uint16_t)(count - entry->expected);
+
+    if (!entry->used) {
+        entry->used = true;
+        entry->type = tracker->per_type ? type : 0;
+        entry->expected = (uint16_t)(count + 1);
+        event = PAKIT_SEQUENCE_FIRST;
+    } else if (ahead == 0) {
+        entry->expected = (uint16_t)(count + 1);
+        event = PAKIT_SEQUENCE_IN_ORDER;
+    } else if (ahead < 0x8000) {
+        tracker->stats.gaps++;
+        tracker->stats.lost += ahead;
+        tracker->last_gap = ahead;
+        entry->expected = (uint16_t)(count + 1);
+        event = PAKIT_SEQUENCE_GAP;
+    } else if (ahead == 0xFFFF) {
+        // One behind: the previous packet again
+        tracker->stats.duplicates++;
+        event = PAKIT_SEQUENCE_DUPLICATE;
+    } else {
+        // A packet counted as lost turned up after all
+        tracker->stats.reordered++;
+        if (tracker->stats.lost > 0) {
+            tracker->stats.lost--;
+        }
+        event = PAKIT_SEQUENCE_REORDERED;
+    }
+
+    tracker->stats.packets++;
+    tracker->last_event = event;
+    return event;
+}
+
+void pakit_set_sequence(PakitReceiver* receiver, PakitSequenceTracker* tracker) {
+    if (receiver != NULL) {
+        receiver->sequence = tracker;
+    }
+}
@@ -0,0 +1,128 @@
+#include <string.h>
+#include "pakit.h"
+
+// SOP resynchronization scan. SSE2 and NEON are selected at compile time;
+// AVX2 is picked at runtime on x86 when the CPU supports it. Define
+// PAKIT_NO_SIMD to force the portable memchr based scan.
+#if !defined(PAKIT_NO_SIMD) && defined(__GNUC__)
+#if defined(__x86_64__) || defined(__i386__)
+#define PAKIT_SOP_AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__)
+#define PAKIT_SOP_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#define PAKIT_SOP_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+// A candidate is EXPECTED_SOP_0 followed by EXPECTED_SOP_1, or EXPECTED_SOP_0
+// as the very last byte (its partner may arrive with the next read)
+static size_t pakit_find_sop_scalar(const uint8_t* buffer, size_t buffer_length, size_t start) {
+    size_t pos = start;
+
+    while (pos < buffer_length) {
+        const uint8_t* hit = memchr(&buffer[pos], EXPECTED_SOP_0, buffer_length - pos);
+        if (hit == NULL) {
+            return buffer_length;
+        }
+
+        pos = (size_t)(hit - buffer);
+        if (pos + 1 == buffer_length || buffer[pos + 1] == EXPECTED_SOP_1) {
+            return pos;
+        }
+        pos++;
+    }
+
+    return buffer_length;
+}
+
+#if defined(PAKIT_SOP_AVX2)
+__attribute__((target("avx2")))
+static size_t pakit_find_sop_avx2(const uint8_t* buffer, size_t buffer_length) {
+    const __m256i sop0 = _mm256_set1_epi8((char)EXPECTED_SOP_0);
+    const __m256i sop1 = _mm256_set1_epi8((char)EXPECTED_SOP_1);
+    size_t pos = 0;
+
+    // Each step also reads the byte after the block for the second SOP byte
+    while (pos + 33 <= buffer_length) {
+        __m256i first = _mm256_loadu_si256((const __m256i*)&buffer[pos]);
+        __m256i second = _mm256_loadu_si256((const __m256i*)&buffer[pos + 1]);
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, sop0), _mm256_cmpeq_epi8(second, sop1)));
+        if (mask != 0) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+        pos += 32;
+    }
+
+    return pakit_find_sop_scalar(buffer, buffer_length, pos);
+}
+#endif
+
+#if defined(PAKIT_SOP_SSE2)
+static size_t pakit_find_sop_sse2(const uint8_t* buffer, size_t buffer_length) {
+    const __m128i sop0 = _mm_set1_epi8((char)EXPECTED_SOP_0);
+    const __m128i sop1 = _mm_set1_epi8((char)EXPECTED_SOP_1);
+    size_t pos = 0;
+
+    while (pos + 17 <= buffer_length) {
+        __m128i first = _mm_loadu_si128((const __m128i*)&buffer[pos]);
+        __m128i second = _mm_loadu_si128((const __m128i*)&buffer[pos + 1]);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, sop0), _mm_cmpeq_epi8(second, sop1)));
+        if (mask != 0) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+
+    return pakit_find_sop_scalar(buffer, buffer_length, pos);
+}
+#endif
+
+#if defined(PAKIT_SOP_NEON)
+static size_t pakit_find_sop_neon(const uint8_t* buffer, size_t buffer_length) {
+    const uint8x16_t sop0 = vdupq_n_u8(EXPECTED_SOP_0);
+    const uint8x16_t sop1 = vdupq_n_u8(EXPECTED_SOP_1);
+    size_t pos = 0;
+
+    while (pos + 17 <= buffer_length) {
+        uint8x16_t first = vld1q_u8(&buffer[pos]);
+        uint8x16_t second = vld1q_u8(&buffer[pos + 1]);
+        uint8x16_t match = vandq_u8(vceqq_u8(first, sop0), vceqq_u8(second, sop1));
+
+        // Narrow to 4 bits per byte so the match fits in one 64-bit lane
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+            vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+        if (mask != 0) {
+            return pos + ((size_t)__builtin_ctzll(mask) >> 2);
+        }
+        pos += 16;
+    }
+
+    return pakit_find_sop_scalar(buffer, buffer_length, pos);
+}
+#endif
+
+size_t pakit_find_sop(const uint8_t* buffer, size_t buffer_length) {
+    if (buffer == NULL) {
+        return 0;
+    }
+
+#if defined(PAKIT_SOP_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return pakit_find_sop_avx2(buffer, buffer_length);
+    }
+#endif
+#if defined(PAKIT_SOP_SSE2)
+    return pakit_find_sop_sse2(buffer, buffer_length);
+#elif defined(PAKIT_SOP_NEON)
+    return pakit_find_sop_neon(buffer, buffer_length);
+#else
+    return pakit_find_sop_scalar(buffer, buffer_length, 0);
+#endif
+}
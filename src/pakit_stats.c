@@ -0,0 +1,63 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#include <string.h>
+#include <time.h>
+#include "pakit.h"
+#include "pakit_internal.h"
+
+#ifdef PAKIT_ENABLE_STATS
+uint64_t pakit_stats_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+#endif
+
+bool pakit_get_stats(const PakitReceiver* receiver, PakitStats* stats) {
+    if (stats == NULL) {
+        return false;
+    }
+    memset(stats, 0, sizeof(PakitStats));
+
+#ifdef PAKIT_ENABLE_STATS
+    if (receiver == NULL) {
+        return false;
+    }
+
+    const PakitStatsCounters* counters = &receiver->stats;
+    stats->bytes_in = atomic_load_explicit(&counters->bytes_in, memory_order_relaxed);
+    stats->packets_out = atomic_load_explicit(&counters->packets_out, memory_order_relaxed);
+    stats->dropped_invalid_sop = atomic_load_explicit(&counters->dropped_invalid_sop, memory_order_relaxed);
+    stats->dropped_size_large = atomic_load_explicit(&counters->dropped_size_large, memory_order_relaxed);
+    stats->dropped_overflow = atomic_load_explicit(&counters->dropped_overflow, memory_order_relaxed);
+    stats->dropped_crc = atomic_load_explicit(&counters->dropped_crc, memory_order_relaxed);
+    stats->filtered = atomic_load_explicit(&counters->filtered, memory_order_relaxed);
+    stats->resyncs = atomic_load_explicit(&counters->resyncs, memory_order_relaxed);
+    stats->max_complete_ns = atomic_load_explicit(&counters->max_complete_ns, memory_order_relaxed);
+    return true;
+#else
+    (void)receiver;
+    return false;
+#endif
+}
+
+void pakit_reset_stats(PakitReceiver* receiver) {
+#ifdef PAKIT_ENABLE_STATS
+    if (receiver == NULL) {
+        return;
+    }
+
+    PakitStatsCounters* counters = &receiver->stats;
+    atomic_store_explicit(&counters->bytes_in, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->packets_out, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->dropped_invalid_sop, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->dropped_size_large, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->dropped_overflow, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->dropped_crc, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->filtered, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->resyncs, 0, memory_order_relaxed);
+    atomic_store_explicit(&counters->max_complete_ns, 0, memory_order_relaxed);
+    counters->packet_start_ns = 0;
+#else
+    (void)receiver;
+#endif
+}
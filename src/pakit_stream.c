@@ -0,0 +1,8 @@
+#include "pakit_stream.h"
+
+void pakit_set_stream(PakitReceiver* receiver, PakitStream* stream) {
+    if (receiver != NULL) {
+        receiver->stream = stream;
+        pakit_init(receiver);
+    }
+}
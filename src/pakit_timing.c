@@ -0,0 +1,197 @@
+#include <string.h>
+#include "pakit_timing.h"
+#include "pakit_internal.h"
+
+// Bucket of a value: values below PAKIT_HISTOGRAM_SUB_COUNT have their own
+// bucket, larger ones are grouped by their top PAKIT_HISTOGRAM_SUB_BITS + 1 bits
+static size_t pakit_histogram_index(uint64_t value) {
+    if (value >= PAKIT_HISTOGRAM_MAX_NS) {
+        return PAKIT_HISTOGRAM_BUCKETS - 1;
+    }
+    if (value < PAKIT_HISTOGRAM_SUB_COUNT) {
+        return (size_t)value;
+    }
+
+    unsigned shift = (unsigned)(63 - __builtin_clzll(value)) - PAKIT_HISTOGRAM_SUB_BITS;
+    return (size_t)(shift + 1) * PAKIT_HISTOGRAM_SUB_COUNT +
+           (size_t)((value >> shift) & (PAKIT_HISTOGRAM_SUB_COUNT - 1));
+}
+
+uint64_t pakit_histogram_bucket_value(size_t index) {
+    if (index < PAKIT_HISTOGRAM_SUB_COUNT) {
+        return index;
+    }
+
+    unsigned shift = (unsigned)(index / PAKIT_HISTOGRAM_SUB_COUNT) - 1;
+    return (uint64_t)(PAKIT_HISTOGRAM_SUB_COUNT + index % PAKIT_HISTOGRAM_SUB_COUNT) << shift;
+}
+
+// Only one thread writes, so a relaxed load and store is enough
+static inline void pakit_histogram_add(_Atomic uint64_t* counter, uint64_t amount) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + amount,
+                          memory_order_relaxed);
+}
+
+void pakit_histogram_record(PakitHistogram* histogram, uint64_t value_ns) {
+    pakit_histogram_add(&histogram->counts[pakit_histogram_index(value_ns)], 1);
+    pakit_histogram_add(&histogram->total, 1);
+    if (value_ns > atomic_load_explicit(&histogram->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&histogram->max_ns, value_ns, memory_order_relaxed);
+    }
+}
+
+// pakit_histogram_record for histograms written by several threads
+static void pakit_histogram_record_shared(PakitHistogram* histogram, uint64_t value_ns) {
+    atomic_fetch_add_explicit(&histogram->counts[pakit_histogram_index(value_ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->total, 1, memory_order_relaxed);
+
+    uint64_t max = atomic_load_explicit(&histogram->max_ns, memory_order_relaxed);
+    while (value_ns > max &&
+           !atomic_compare_exchange_weak_explicit(&histogram->max_ns, &max, value_ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void pakit_histogram_reset(PakitHistogram* histogram) {
+    for (size_t i = 0; i < PAKIT_HISTOGRAM_BUCKETS; i++) {
+        atomic_store_explicit(&histogram->counts[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&histogram->total, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->max_ns, 0, memory_order_relaxed);
+}
+
+void pakit_histogram_snapshot(const PakitHistogram* histogram, PakitHistogramSnapshot* snapshot) {
+    if (histogram == NULL || snapshot == NULL) {
+        return;
+    }
+
+    // Buckets are read one by one, so the total is summed from them rather than
+    // read, keeping the snapshot consistent with itself
+    snapshot->total = 0;
+    for (size_t i = 0; i < PAKIT_HISTOGRAM_BUCKETS; i++) {
+        snapshot->counts[i] = atomic_load_explicit(&histogram->counts[i], memory_order_relaxed);
+        snapshot->total += snapshot->counts[i];
+    }
+    snapshot->max_ns = atomic_load_explicit(&histogram->max_ns, memory_order_relaxed);
+}
+
+uint64_t pakit_histogram_percentile(const PakitHistogramSnapshot* snapshot, double percentile) {
+    if (snapshot == NULL || snapshot->total == 0) {
+        return 0;
+    }
+
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    } else if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    uint64_t rank = (uint64_t)((double)snapshot->total * percentile / 100.0 + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    // Report the highest value of the bucket holding the rank-th value
+    uint64_t seen = 0;
+    for (size_t i = 0; i < PAKIT_HISTOGRAM_BUCKETS; i++) {
+        seen += snapshot->counts[i];
+        if (seen >= rank) {
+            uint64_t highest = (i + 1 < PAKIT_HISTOGRAM_BUCKETS)
+                                   ? pakit_histogram_bucket_value(i + 1) - 1 : PAKIT_HISTOGRAM_MAX_NS;
+            return (highest < snapshot->max_ns) ? highest : snapshot->max_ns;
+        }
+    }
+
+    return snapshot->max_ns;
+}
+
+void pakit_timing_reset(PakitTiming* timing) {
+    if (timing == NULL) {
+        return;
+    }
+
+    timing->now_ns = 0;
+    timing->first_byte_ns = 0;
+    timing->last_read_ns = 0;
+    timing->last.first_byte_ns = 0;
+    timing->last.complete_ns = 0;
+    pakit_histogram_reset(&timing->complete);
+    pakit_histogram_reset(&timing->stall);
+    pakit_histogram_reset(&timing->wait);
+}
+
+void pakit_set_timing(PakitReceiver* receiver, PakitTiming* timing) {
+    if (receiver != NULL) {
+        receiver->timing = timing;
+        pakit_init(receiver);
+    }
+}
+
+void pakit_timing_read(PakitReceiver* receiver, uint64_t timestamp_ns) {
+    if (receiver == NULL || receiver->timing == NULL) {
+        return;
+    }
+
+    PakitTiming* timing = receiver->timing;
+    if (timestamp_ns == timing->now_ns) {
+        // More of the same read
+        return;
+    }
+
+    // A packet left unfinished by the previous read continues in this one
+    if (receiver->state != STATE_COMPLETE && receiver->received_bytes > 0) {
+        pakit_histogram_record(&timing->stall, (timestamp_ns > timing->last_read_ns)
+                                                   ? timestamp_ns - timing->last_read_ns : 0);
+    }
+    timing->now_ns = timestamp_ns;
+    timing->last_read_ns = timestamp_ns;
+}
+
+void pakit_timing_complete(PakitTiming* timing, bool buffered) {
+    // A packet decoded in place arrived within the current read
+    uint64_t first = buffered ? timing->first_byte_ns : timing->now_ns;
+
+    timing->last.first_byte_ns = first;
+    timing->last.complete_ns = timing->now_ns;
+    pakit_histogram_record(&timing->complete, (timing->now_ns > first) ? timing->now_ns - first : 0);
+}
+
+bool pakit_packet_times(const PakitReceiver* receiver, PakitPacketTimes* times) {
+    if (receiver == NULL || receiver->timing == NULL) {
+        return false;
+    }
+
+    if (times != NULL) {
+        *times = receiver->timing->last;
+    }
+    return true;
+}
+
+void pakit_timing_pickup(PakitTiming* timing, uint64_t complete_ns, uint64_t now_ns) {
+    if (timing != NULL) {
+        pakit_histogram_record_shared(&timing->wait, (now_ns > complete_ns) ? now_ns - complete_ns : 0);
+    }
+}
+
+PakitStatus pakit_receive_byte_at(PakitReceiver* receiver, uint8_t byte, uint64_t timestamp_ns) {
+    pakit_timing_read(receiver, timestamp_ns);
+    return pakit_receive_byte(receiver, byte);
+}
+
+PakitStatus pakit_receive_buffer_at(PakitReceiver* receiver, const uint8_t* buffer,
+                                    size_t buffer_length, size_t* position, uint64_t timestamp_ns) {
+    pakit_timing_read(receiver, timestamp_ns);
+    return pakit_receive_buffer(receiver, buffer, buffer_length, position);
+}
+
+PakitStatus pakit_next_view_at(PakitReceiver* receiver, const uint8_t* buffer, size_t buffer_length,
+                               size_t* position, uint64_t timestamp_ns, PakitView* view,
+                               PakitPacketTimes* times) {
+    pakit_timing_read(receiver, timestamp_ns);
+    PakitStatus status = pakit_next_view(receiver, buffer, buffer_length, position, view);
+
+    if (status == PAKIT_STATUS_SUCCESS) {
+        pakit_packet_times(receiver, times);
+    }
+    return status;
+}
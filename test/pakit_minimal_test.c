@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "pakit.h"
+#include "pakit_ring.h"
+
+/* Tests of the core decoder alone: the only ones the PAKIT_MINIMAL profile
+ * can build, and run by the full build too */
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST_ASSERT(message, test) do { \
+    tests_run++; \
+    if (test) { \
+        tests_passed++; \
+        printf("[PASS] %s\n", message); \
+    } else { \
+        tests_failed++; \
+        printf("[FAIL] %s at line %d\n", message, __LINE__); \
+    } \
+} while (0)
+
+#define RUN_TEST(test_function) do { \
+    printf("\nRunning %s...\n", #test_function); \
+    test_function(); \
+} while (0)
+
+void print_test_summary() {
+    printf("\n----- TEST SUMMARY -----\n");
+    printf("Total tests: %d\n", tests_run);
+    printf("Passed: %d\n", tests_passed);
+    printf("Failed: %d\n", tests_failed);
+    printf("Success rate: %.1f%%\n", (tests_run > 0) ? (100.0 * tests_passed / tests_run) : 0);
+    printf("-----------------------\n");
+}
+
+/* Encodes count packets of type 0x0100 + i, payload bytes equal to i, sizes 0, 3, 6, ... */
+static size_t build_stream(uint8_t* stream, size_t capacity, int count, bool crc) {
+    static uint8_t payloads[16][64];
+    size_t length = 0;
+
+    for (int i = 0; i < count; i++) {
+        Packet packet;
+        uint16_t size = (uint16_t)(i * 3);
+        memset(payloads[i], i, size);
+        pakit_packet_create(&packet, (uint16_t)(0x0100 + i), (uint16_t)i, size ? payloads[i] : NULL, size);
+        if (crc) {
+            length += pakit_encode_crc(&packet, &stream[length], capacity - length);
+        } else {
+            size_t written = 0;
+            pakit_encode_batch(&packet, 1, &stream[length], capacity - length, &written, NULL);
+            length += written;
+        }
+    }
+    return length;
+}
+
+/* True if the receiver holds packet i of build_stream */
+static bool holds_packet(PakitReceiver* receiver, int i) {
+    Packet packet;
+    if (!pakit_is_packet_complete(receiver, &packet)) {
+        return false;
+    }
+    bool payload_ok = true;
+    for (uint16_t j = 0; j < packet.size; j++) {
+        payload_ok = payload_ok && packet.payload[j] == i;
+    }
+    return packet.type[0] == 0x01 && packet.type[1] == i && packet.count == i &&
+           packet.size == i * 3 && payload_ok;
+}
+
+void test_layout() {
+#ifdef PAKIT_MINIMAL
+    PakitReceiver receiver;
+    TEST_ASSERT("Minimal state is one byte", sizeof(receiver.state) == 1);
+    TEST_ASSERT("Minimal receiver is small", sizeof(PakitReceiver) <= 48);
+#endif
+    TEST_ASSERT("Every state fits the state field", STATE_COMPLETE <= 0xFF);
+}
+
+void test_crc_vector() {
+    const uint8_t check[] = "123456789";
+    TEST_ASSERT("CRC32C check value", pakit_crc32c(0, check, 9) == 0xE3069283u);
+    TEST_ASSERT("CRC32C chained", pakit_crc32c(pakit_crc32c(0, check, 4), &check[4], 5) == 0xE3069283u);
+    TEST_ASSERT("CRC32C empty", pakit_crc32c(0, check, 0) == 0);
+
+    // Ragged pieces give the same result as one pass
+    uint8_t data[1000];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 31 + 7);
+    }
+    uint32_t whole = pakit_crc32c(0, data, sizeof(data));
+    uint32_t pieces = 0;
+    for (size_t offset = 0, step = 1; offset < sizeof(data); offset += step, step = step * 2 + 1) {
+        size_t length = (sizeof(data) - offset < step) ? sizeof(data) - offset : step;
+        pieces = pakit_crc32c(pieces, &data[offset], length);
+    }
+    TEST_ASSERT("CRC32C pieces", whole == pieces && whole != 0);
+}
+
+void test_receive_byte() {
+    uint8_t stream[512];
+    size_t length = build_stream(stream, sizeof(stream), 8, false);
+
+    // Storage of exactly the largest payload
+    uint8_t storage[21];
+    PakitReceiver receiver;
+    TEST_ASSERT("Create on exact storage", pakit_create(&receiver, storage, sizeof(storage)) == PAKIT_STATUS_SUCCESS &&
+                receiver.max_payload_size == 21);
+
+    int delivered = 0;
+    bool all_match = true;
+    for (size_t i = 0; i < length; i++) {
+        PakitStatus status = pakit_receive_byte(&receiver, stream[i]);
+        if (status == PAKIT_STATUS_SUCCESS) {
+            all_match = all_match && holds_packet(&receiver, delivered);
+            delivered++;
+        } else if (status != PAKIT_STATUS_IN_PROGRESS) {
+            all_match = false;
+        }
+    }
+    TEST_ASSERT("Byte path delivers every packet", delivered == 8 && all_match);
+    TEST_ASSERT("Completion is read from the state", receiver.state == STATE_COMPLETE);
+
+    // A new byte starts the next packet
+    TEST_ASSERT("Invalid SOP", pakit_receive_byte(&receiver, 0x00) == PAKIT_STATUS_ERROR_INVALID_SOP &&
+                !pakit_is_packet_complete(&receiver, NULL));
+    const uint8_t oversized[HEADER_SIZE] = {EXPECTED_SOP_0, EXPECTED_SOP_1, 0, 1, 0, 0, 0, 22};
+    PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
+    for (size_t i = 0; i < sizeof(oversized); i++) {
+        status = pakit_receive_byte(&receiver, oversized[i]);
+    }
+    TEST_ASSERT("Payload above the storage", status == PAKIT_STATUS_ERROR_SIZE_LARGE &&
+                receiver.state == STATE_UNIQUE_SOP && receiver.received_bytes == 0);
+
+    pakit_destroy(&receiver);
+}
+
+void test_receive_buffer() {
+    uint8_t stream[512];
+    size_t length = 0;
+    stream[length++] = 0x11;
+    stream[length++] = EXPECTED_SOP_0;
+    length += build_stream(&stream[length], sizeof(stream) - length, 8, false);
+
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 64);
+
+    // One read: the junk comes back as one error, then the packets
+    size_t position = 0;
+    PakitStatus status = pakit_receive_buffer(&receiver, stream, length, &position);
+    TEST_ASSERT("Buffer skips junk", status == PAKIT_STATUS_ERROR_INVALID_SOP && position == 2);
+    int delivered = 0;
+    bool all_match = true;
+    while (position < length) {
+        if (pakit_receive_buffer(&receiver, stream, length, &position) == PAKIT_STATUS_SUCCESS) {
+            all_match = all_match && holds_packet(&receiver, delivered);
+            delivered++;
+        }
+    }
+    TEST_ASSERT("Buffer path delivers every packet", delivered == 8 && all_match && position == length);
+
+    // Reads of every size up to a header and a half
+    for (size_t chunk = 1; chunk <= 12; chunk++) {
+        pakit_init(&receiver);
+        delivered = 0;
+        all_match = true;
+        for (size_t offset = 0; offset < length; offset += chunk) {
+            size_t end = (length - offset < chunk) ? length : offset + chunk;
+            position = offset;
+            while (position < end) {
+                if (pakit_receive_buffer(&receiver, stream, end, &position) == PAKIT_STATUS_SUCCESS) {
+                    all_match = all_match && holds_packet(&receiver, delivered);
+                    delivered++;
+                }
+            }
+        }
+        if (delivered != 8 || !all_match) {
+            break;
+        }
+    }
+    TEST_ASSERT("Buffer path across reads", delivered == 8 && all_match);
+
+    // Bytes arriving through an ISR ring
+    uint8_t ring_storage[16];
+    PakitRing ring;
+    pakit_ring_init(&ring, ring_storage, sizeof(ring_storage));
+    pakit_init(&receiver);
+    delivered = 0;
+    size_t written = 0;
+    size_t guard = 0;
+    while ((written < length || pakit_ring_used(&ring) > 0) && guard++ < 10000) {
+        written += pakit_ring_write(&ring, &stream[written], (length - written < 5) ? length - written : 5);
+        while ((status = pakit_receive_ring(&receiver, &ring)) != PAKIT_STATUS_IN_PROGRESS) {
+            delivered += status == PAKIT_STATUS_SUCCESS;
+        }
+    }
+    TEST_ASSERT("Ring feeds the receiver", delivered == 8 && pakit_ring_used(&ring) == 0);
+
+    pakit_destroy(&receiver);
+}
+
+void test_crc_mode() {
+    uint8_t stream[512];
+    size_t length = build_stream(stream, sizeof(stream), 8, true);
+
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 64);
+    pakit_set_crc(&receiver, true);
+
+    int delivered = 0;
+    bool all_match = true;
+    for (size_t i = 0; i < length; i++) {
+        PakitStatus status = pakit_receive_byte(&receiver, stream[i]);
+        if (status == PAKIT_STATUS_SUCCESS) {
+            all_match = all_match && holds_packet(&receiver, delivered);
+            delivered++;
+        } else if (status != PAKIT_STATUS_IN_PROGRESS) {
+            all_match = false;
+        }
+    }
+    TEST_ASSERT("CRC byte path", delivered == 8 && all_match);
+
+    // A corrupted payload byte fails its packet only
+    size_t third = 2 * HEADER_SIZE + 3 + 2 * PAKIT_CRC_SIZE;
+    stream[third + HEADER_SIZE + 1] ^= 0x40;
+    size_t position = 0;
+    int errors = 0;
+    delivered = 0;
+    while (position < length) {
+        PakitStatus status = pakit_receive_buffer(&receiver, stream, length, &position);
+        delivered += status == PAKIT_STATUS_SUCCESS;
+        errors += status == PAKIT_STATUS_ERROR_CRC;
+    }
+    TEST_ASSERT("CRC mismatch detected", delivered == 7 && errors == 1 && position == length);
+
+    // Without CRC mode the trailers are junk between packets
+    pakit_set_crc(&receiver, false);
+    stream[third + HEADER_SIZE + 1] ^= 0x40;
+    position = 0;
+    delivered = 0;
+    while (position < length) {
+        delivered += pakit_receive_buffer(&receiver, stream, length, &position) == PAKIT_STATUS_SUCCESS;
+    }
+    TEST_ASSERT("CRC trailers ignored when off", delivered == 8);
+
+    pakit_destroy(&receiver);
+}
+
+int main() {
+    printf("Starting Pakit core tests...\n");
+
+    RUN_TEST(test_layout);
+    RUN_TEST(test_crc_vector);
+    RUN_TEST(test_receive_byte);
+    RUN_TEST(test_receive_buffer);
+    RUN_TEST(test_crc_mode);
+
+    print_test_summary();
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -1,8 +1,32 @@
+#define _POSIX_C_SOURCE 200809L  // mkstemp, truncate
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/socket.h>
+#endif
 #include "pakit.h"
+#include "pakit_demux.h"
+#include "pakit_dispatch.h"
+#include "pakit_file.h"
+#include "pakit_filter.h"
+#include "pakit_index.h"
+#include "pakit_io.h"
+#include "pakit_packet_pool.h"
+#include "pakit_parallel.h"
+#include "pakit_pool.h"
+#include "pakit_queue.h"
+#include "pakit_ring.h"
+#include "pakit_sequence.h"
+#include "pakit_spec.h"
+#include "pakit_stream.h"
+#include "pakit_timing.h"
 
 /* Simple testing framework */
 static int tests_run = 0;
@@ -63,7 +87,7 @@ bool compare_packets(const Packet* p1, const Packet* p2) {
 
 void test_initialization() {
     PakitReceiver receiver;
-    pakit_create(&receiver);
+    pakit_create(&receiver, NULL, 0);
 
     // Test state after initialization
     Packet packet;
@@ -80,7 +104,7 @@ void test_initialization() {
 
 void test_valid_packet_byte_by_byte() {
     PakitReceiver receiver;
-    pakit_create(&receiver);
+    pakit_create(&receiver, NULL, 0);
 
     // Create test packet with pakit_packet_create
     Packet expected_packet;
@@ -159,7 +183,7 @@ void test_packet_create() {
 
 void test_invalid_packet_handling() {
     PakitReceiver receiver;
-    pakit_create(&receiver);
+    pakit_create(&receiver, NULL, 0);
 
     // Test invalid SOP (not 0xB0B2)
     uint8_t invalid_sop[] = {
@@ -203,7 +227,7 @@ void test_invalid_packet_handling() {
 
 void test_empty_payload() {
     PakitReceiver receiver;
-    pakit_create(&receiver);
+    pakit_create(&receiver, NULL, 0);
 
     // Valid packet with empty payload
     uint8_t empty_packet[] = {
@@ -232,7 +256,7 @@ void test_empty_payload() {
 
 void test_large_payload() {
     PakitReceiver receiver;
-    pakit_create(&receiver);
+    pakit_create(&receiver, NULL, 0);
 
     // Create a large payload (100 bytes)
     const size_t payload_size = 100;
@@ -283,7 +307,7 @@ void test_large_payload() {
 
 void test_packet_malformed() {
     PakitReceiver receiver;
-    pakit_create(&receiver);
+    pakit_create(&receiver, NULL, 0);
 
     // Malformed packet: correct SOP but invalid size
     uint8_t invalid_size[] = {
@@ -327,7 +351,7 @@ void test_packet_malformed() {
 
 void test_multiple_packets() {
     PakitReceiver receiver;
-    pakit_create(&receiver);
+    pakit_create(&receiver, NULL, 0);
 
     // Two packets back to back
     uint8_t dual_packets[] = {
@@ -388,6 +412,2355 @@ void test_multiple_packets() {
     pakit_destroy(&receiver);
 }
 
+#define MAX_RECORDED_PACKETS 16
+
+typedef struct {
+    size_t end_position;
+    Packet packet;
+    uint8_t payload[MAX_PACKET_SIZE];
+} RecordedPacket;
+
+// Records every packet pakit_receive_buffer delivers when fed in chunks
+static size_t record_bulk_packets(const uint8_t* stream, size_t length, size_t chunk,
+                                  RecordedPacket* out) {
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    size_t found = 0;
+
+    for (size_t start = 0; start < length; start += chunk) {
+        size_t end = (start + chunk < length) ? start + chunk : length;
+        size_t position = start;
+
+        while (position < end) {
+            PakitStatus status = pakit_receive_buffer(&receiver, stream, end, &position);
+            if (status == PAKIT_STATUS_SUCCESS && found < MAX_RECORDED_PACKETS &&
+                pakit_is_packet_complete(&receiver, &out[found].packet)) {
+                out[found].end_position = position;
+                memcpy(out[found].payload, out[found].packet.payload, out[found].packet.size);
+                found++;
+            }
+        }
+    }
+
+    pakit_destroy(&receiver);
+    return found;
+}
+
+// Records every packet the per-byte state machine delivers
+static size_t record_reference_packets(const uint8_t* stream, size_t length, RecordedPacket* out) {
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    size_t found = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        if (pakit_receive_byte(&receiver, stream[i]) == PAKIT_STATUS_SUCCESS &&
+            found < MAX_RECORDED_PACKETS &&
+            pakit_is_packet_complete(&receiver, &out[found].packet)) {
+            out[found].end_position = i + 1;
+            memcpy(out[found].payload, out[found].packet.payload, out[found].packet.size);
+            found++;
+        }
+    }
+
+    pakit_destroy(&receiver);
+    return found;
+}
+
+void test_receive_buffer_bulk_matches_byte_path() {
+    // Valid packets, back to back packets, garbage, a bad second SOP byte,
+    // a repeated first SOP byte, an oversized header and an empty payload
+    uint8_t stream[] = {
+        0xB0, 0xB2, 0x01, 0x01, 0x00, 0x01, 0x00, 0x03, 'A', 'B', 'C',
+        0xB0, 0xB2, 0x01, 0x02, 0x00, 0x02, 0x00, 0x00,
+        0x11, 0x22, 0xB0, 0x33,
+        0xB0, 0xB2, 0x01, 0x03, 0x00, 0x03, 0xFF, 0xFF,
+        0xB0, 0xB2, 0x01, 0x04, 0x00, 0x04, 0x00, 0x05, 'H', 'e', 'l', 'l', 'o',
+        0xB0, 0xB0, 0xB2, 0x01, 0x05, 0x00, 0x05, 0x00, 0x01, 'Z',
+        0xB0, 0xB2, 0x01, 0x06, 0x00, 0x06, 0x00, 0x02, 'X'
+    };
+    RecordedPacket expected[MAX_RECORDED_PACKETS];
+    RecordedPacket actual[MAX_RECORDED_PACKETS];
+    bool all_match = true;
+
+    size_t expected_count = record_reference_packets(stream, sizeof(stream), expected);
+    TEST_ASSERT("Reference finds the valid packets", expected_count == 4);
+
+    for (size_t chunk = 1; chunk <= sizeof(stream); chunk++) {
+        size_t actual_count = record_bulk_packets(stream, sizeof(stream), chunk, actual);
+        if (actual_count != expected_count) {
+            all_match = false;
+            continue;
+        }
+
+        for (size_t i = 0; i < expected_count; i++) {
+            if (actual[i].end_position != expected[i].end_position ||
+                !compare_packets(&actual[i].packet, &expected[i].packet) ||
+                memcmp(actual[i].payload, expected[i].payload, expected[i].packet.size) != 0) {
+                all_match = false;
+            }
+        }
+    }
+
+    TEST_ASSERT("Bulk receive matches byte path for every chunk size", all_match);
+}
+
+void test_resync_skips_garbage_run() {
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+
+    uint8_t stream[64];
+    memset(stream, 0x5A, sizeof(stream));
+    stream[10] = 0xB0;  // Lone first SOP byte inside the garbage
+    const uint8_t header[] = {0xB0, 0xB2, 0x07, 0x07, 0x00, 0x01, 0x00, 0x00};
+    memcpy(&stream[40], header, sizeof(header));
+
+    size_t position = 0;
+    PakitStatus status = pakit_receive_buffer(&receiver, stream, sizeof(stream), &position);
+    TEST_ASSERT("Garbage run reported once", status == PAKIT_STATUS_ERROR_INVALID_SOP);
+    TEST_ASSERT("Garbage run skipped to SOP", position == 40);
+
+    status = pakit_receive_buffer(&receiver, stream, sizeof(stream), &position);
+    TEST_ASSERT("Packet after garbage", status == PAKIT_STATUS_SUCCESS && position == 48);
+
+    // Trailing first SOP byte is kept for the next read
+    uint8_t tail[] = {0x01, 0x02, 0xB0};
+    position = 0;
+    pakit_init(&receiver);
+    status = pakit_receive_buffer(&receiver, tail, sizeof(tail), &position);
+    TEST_ASSERT("Tail garbage skipped", status == PAKIT_STATUS_ERROR_INVALID_SOP && position == 2);
+    status = pakit_receive_buffer(&receiver, tail, sizeof(tail), &position);
+    TEST_ASSERT("Trailing SOP byte buffered", status == PAKIT_STATUS_IN_PROGRESS &&
+                                             receiver.received_bytes == 1);
+
+    pakit_destroy(&receiver);
+}
+
+void test_find_sop_matches_scalar_scan() {
+    uint8_t data[301];
+    uint32_t seed = 12345;
+    bool all_match = true;
+
+    for (int round = 0; round < 200; round++) {
+        // Random bytes drawn mostly from the SOP values to create near misses
+        for (size_t i = 0; i < sizeof(data); i++) {
+            seed = seed * 1103515245u + 12345u;
+            uint8_t pick = (uint8_t)(seed >> 16);
+            data[i] = (pick & 0x3) == 0 ? EXPECTED_SOP_0 : (pick & 0x3) == 1 ? EXPECTED_SOP_1 : pick;
+        }
+
+        for (size_t length = 0; length <= sizeof(data); length += 7) {
+            size_t expected = length;
+            for (size_t i = 0; i < length; i++) {
+                if (data[i] == EXPECTED_SOP_0 && (i + 1 == length || data[i + 1] == EXPECTED_SOP_1)) {
+                    expected = i;
+                    break;
+                }
+            }
+            if (pakit_find_sop(data, length) != expected) {
+                all_match = false;
+            }
+        }
+
+        data[round % sizeof(data)] = 0;
+    }
+
+    TEST_ASSERT("pakit_find_sop matches scalar scan", all_match);
+}
+
+void test_next_view_zero_copy() {
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+
+    uint8_t stream[] = {
+        0xB0, 0xB2, 0x01, 0x01, 0x00, 0x07, 0x00, 0x03, 'A', 'B', 'C',
+        0xB0, 0xB2, 0x02, 0x02, 0x00, 0x08, 0x00, 0x00,
+        0x55,
+        0xB0, 0xB2, 0x03, 0x03, 0x00, 0x09, 0x00, 0x04, 'W', 'X', 'Y', 'Z'
+    };
+    const size_t split = sizeof(stream) - 2;  // Third packet spans two reads
+
+    PakitView view;
+    size_t position = 0;
+    PakitStatus status = pakit_next_view(&receiver, stream, split, &position, &view);
+    TEST_ASSERT("First view status", status == PAKIT_STATUS_SUCCESS);
+    TEST_ASSERT("First view fields", view.type == 0x0101 && view.count == 7 && view.size == 3);
+    TEST_ASSERT("First view points into caller buffer", view.payload == &stream[8]);
+    TEST_ASSERT("First view position", position == 11);
+
+    status = pakit_next_view(&receiver, stream, split, &position, &view);
+    TEST_ASSERT("Empty view status", status == PAKIT_STATUS_SUCCESS);
+    TEST_ASSERT("Empty view fields", view.type == 0x0202 && view.count == 8 && view.size == 0);
+    TEST_ASSERT("Receiver untouched by zero-copy views",
+                pakit_is_packet_complete(&receiver, NULL) == false);
+
+    status = pakit_next_view(&receiver, stream, split, &position, &view);
+    TEST_ASSERT("Garbage byte reported", status == PAKIT_STATUS_ERROR_INVALID_SOP);
+    TEST_ASSERT("Garbage byte consumed", position == 20);
+
+    status = pakit_next_view(&receiver, stream, split, &position, &view);
+    TEST_ASSERT("Spanning packet buffered", status == PAKIT_STATUS_IN_PROGRESS);
+    TEST_ASSERT("Spanning packet consumed", position == split);
+
+    size_t next_position = 0;
+    status = pakit_next_view(&receiver, &stream[split], sizeof(stream) - split, &next_position, &view);
+    TEST_ASSERT("Spanning view status", status == PAKIT_STATUS_SUCCESS);
+    TEST_ASSERT("Spanning view fields", view.type == 0x0303 && view.count == 9 && view.size == 4);
+    TEST_ASSERT("Spanning view copied", view.payload == receiver.payload &&
+                                       memcmp(view.payload, "WXYZ", 4) == 0);
+    TEST_ASSERT("Spanning view position", next_position == 2);
+
+    status = pakit_next_view(NULL, stream, sizeof(stream), NULL, &view);
+    TEST_ASSERT("NULL receiver rejected", status == PAKIT_STATUS_ERROR_NULL_PARAM);
+
+    pakit_destroy(&receiver);
+}
+
+void test_receive_batch() {
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+
+    uint8_t stream[] = {
+        0xB0, 0xB2, 0x01, 0x01, 0x00, 0x01, 0x00, 0x02, 'A', 'B',
+        0xB0, 0xB2, 0x01, 0x02, 0x00, 0x02, 0x00, 0x01, 'C',
+        0x99, 0x98,
+        0xB0, 0xB2, 0x01, 0x03, 0x00, 0x03, 0x00, 0x00,
+        0xB0, 0xB2, 0x01, 0x04, 0x00, 0x04, 0x00, 0x03, 'D', 'E', 'F',
+        0xB0, 0xB2, 0x01, 0x05, 0x00, 0x05, 0x00, 0x02, 'G'
+    };
+    PakitView views[8];
+    size_t consumed = 0;
+
+    // First read ends in the middle of the first packet's payload
+    size_t found = pakit_receive_batch(&receiver, stream, 9, views, 8, &consumed);
+    TEST_ASSERT("Batch with partial packet finds nothing", found == 0 && consumed == 9);
+
+    // Second read completes it and holds the rest of the stream
+    found = pakit_receive_batch(&receiver, &stream[9], sizeof(stream) - 9, views, 8, &consumed);
+    TEST_ASSERT("Batch found all complete packets", found == 4);
+    TEST_ASSERT("Batch first view from receiver", views[0].count == 1 && views[0].size == 2 &&
+                                                 memcmp(views[0].payload, "AB", 2) == 0);
+    TEST_ASSERT("Batch second view in place", views[1].count == 2 && views[1].payload == &stream[18]);
+    TEST_ASSERT("Batch skips garbage", views[2].count == 3 && views[2].size == 0);
+    TEST_ASSERT("Batch fourth view", views[3].count == 4 && memcmp(views[3].payload, "DEF", 3) == 0);
+    TEST_ASSERT("Batch stops before overwriting receiver view", consumed == sizeof(stream) - 9 - 9);
+
+    // Next call buffers the tail
+    size_t tail = sizeof(stream) - 9;
+    found = pakit_receive_batch(&receiver, &stream[tail], 9, views, 8, &consumed);
+    TEST_ASSERT("Batch buffers trailing partial packet", found == 0 && consumed == 9);
+
+    // Limit on the number of views
+    pakit_init(&receiver);
+    found = pakit_receive_batch(&receiver, &stream[10], sizeof(stream) - 10, views, 2, &consumed);
+    TEST_ASSERT("Batch respects max_views", found == 2 && consumed == 19);
+
+    found = pakit_receive_batch(NULL, stream, sizeof(stream), views, 8, &consumed);
+    TEST_ASSERT("Batch NULL receiver", found == 0 && consumed == 0);
+
+    pakit_destroy(&receiver);
+}
+
+void test_reset_and_clear() {
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+
+    uint8_t packet_bytes[] = {0xB0, 0xB2, 0x01, 0x01, 0x00, 0x01, 0x00, 0x02, 'O', 'K'};
+    pakit_receive_buffer(&receiver, packet_bytes, sizeof(packet_bytes), NULL);
+
+    // Light reset only clears the parse state
+    pakit_init(&receiver);
+    TEST_ASSERT("Reset clears parse state", receiver.state == STATE_UNIQUE_SOP &&
+                                           receiver.received_bytes == 0 &&
+                                           receiver.expected_payload_size == 0);
+    TEST_ASSERT("Reset leaves buffer alone", receiver.payload[0] == 'O');
+
+    // Full clear scrubs the buffer
+    pakit_receive_buffer(&receiver, packet_bytes, sizeof(packet_bytes), NULL);
+    pakit_clear(&receiver);
+    TEST_ASSERT("Clear resets parse state", receiver.state == STATE_UNIQUE_SOP &&
+                                           receiver.received_bytes == 0);
+    TEST_ASSERT("Clear scrubs buffer", receiver.payload[0] == 0 &&
+                                      receiver.header.sop[0] == 0);
+
+    pakit_destroy(&receiver);
+}
+
+void test_back_to_back_max_size_packets() {
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+
+    // A maximum size packet fills the buffer; the next byte must start a new packet
+    uint8_t header[] = {0xB0, 0xB2, 0x01, 0x01, 0x00, 0x01,
+                        (uint8_t)(MAX_PACKET_SIZE >> 8), (uint8_t)(MAX_PACKET_SIZE & 0xFF)};
+    PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
+
+    for (int packet = 0; packet < 2; packet++) {
+        for (size_t i = 0; i < sizeof(header); i++) {
+            status = pakit_receive_byte(&receiver, header[i]);
+        }
+        for (size_t i = 0; i < MAX_PACKET_SIZE; i++) {
+            status = pakit_receive_byte(&receiver, (uint8_t)i);
+        }
+        TEST_ASSERT("Maximum size packet completes", status == PAKIT_STATUS_SUCCESS);
+    }
+
+    pakit_destroy(&receiver);
+}
+
+void test_encode_header() {
+    Packet packet;
+    uint8_t payload[] = {'P', 'I', 'N', 'G'};
+    pakit_packet_create(&packet, 0x1234, 0xABCD, payload, sizeof(payload));
+
+    uint8_t header[HEADER_SIZE];
+    bool encoded = pakit_encode_header(header, &packet);
+    const uint8_t expected[HEADER_SIZE] = {0xB0, 0xB2, 0x12, 0x34, 0xAB, 0xCD, 0x00, 0x04};
+    TEST_ASSERT("Header encoded", encoded == true);
+    TEST_ASSERT("Header bytes", memcmp(header, expected, HEADER_SIZE) == 0);
+
+    // Encoded header and payload decode back to the same packet
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    PakitStatus status = pakit_receive_buffer(&receiver, header, HEADER_SIZE, NULL);
+    status = pakit_receive_buffer(&receiver, payload, sizeof(payload), NULL);
+    Packet decoded;
+    TEST_ASSERT("Encoded packet decodes", status == PAKIT_STATUS_SUCCESS &&
+                                         pakit_is_packet_complete(&receiver, &decoded) &&
+                                         compare_packets(&decoded, &packet) &&
+                                         memcmp(decoded.payload, payload, sizeof(payload)) == 0);
+    pakit_destroy(&receiver);
+
+    TEST_ASSERT("Encode NULL packet", pakit_encode_header(header, NULL) == false);
+    static uint8_t large_payload[1000];
+    pakit_packet_create(&packet, 0x0001, 1, large_payload, sizeof(large_payload));
+    TEST_ASSERT("Encode large packet", pakit_encode_header(header, &packet) == true &&
+                                      header[6] == 0x03 && header[7] == 0xE8);
+
+#ifdef PAKIT_HAVE_IOVEC
+    struct iovec iov[2];
+    pakit_packet_create(&packet, 0x0001, 2, payload, sizeof(payload));
+    int segments = pakit_encode_iov(&packet, header, iov);
+    TEST_ASSERT("iov segments", segments == 2);
+    TEST_ASSERT("iov header", iov[0].iov_base == header && iov[0].iov_len == HEADER_SIZE);
+    TEST_ASSERT("iov payload not copied", iov[1].iov_base == payload && iov[1].iov_len == sizeof(payload));
+
+    pakit_packet_create(&packet, 0x0001, 3, NULL, 0);
+    TEST_ASSERT("iov empty payload", pakit_encode_iov(&packet, header, iov) == 1);
+    TEST_ASSERT("iov NULL packet", pakit_encode_iov(NULL, header, iov) == 0);
+#endif
+}
+
+void test_encode_batch() {
+    Packet packets[3];
+    uint8_t payload1[] = {'A', 'B'};
+    uint8_t payload3[] = {'C', 'D', 'E'};
+    pakit_packet_create(&packets[0], 0x0101, 0, payload1, sizeof(payload1));
+    pakit_packet_create(&packets[1], 0x0202, 0, NULL, 0);
+    pakit_packet_create(&packets[2], 0x0303, 0, payload3, sizeof(payload3));
+
+    uint8_t buffer[64];
+    size_t written = 0;
+    uint16_t sequence = 0xFFFF;  // Wraps to 0 after the first packet
+    size_t encoded = pakit_encode_batch(packets, 3, buffer, sizeof(buffer), &written, &sequence);
+    TEST_ASSERT("Batch encoded all packets", encoded == 3);
+    TEST_ASSERT("Batch bytes written", written == 3 * HEADER_SIZE + 5);
+    TEST_ASSERT("Batch sequence advanced", sequence == 2);
+
+    // Decode the burst back
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    PakitView views[3];
+    size_t found = pakit_receive_batch(&receiver, buffer, written, views, 3, NULL);
+    TEST_ASSERT("Batch decodes", found == 3);
+    TEST_ASSERT("Batch counts from sequence", views[0].count == 0xFFFF && views[1].count == 0 &&
+                                             views[2].count == 1);
+    TEST_ASSERT("Batch types and payload", views[0].type == 0x0101 && views[2].type == 0x0303 &&
+                                          memcmp(views[2].payload, "CDE", 3) == 0);
+    pakit_destroy(&receiver);
+
+    // Own counts are kept without a sequence, and encoding stops when full
+    packets[0].count = 42;
+    encoded = pakit_encode_batch(packets, 3, buffer, 2 * HEADER_SIZE + 2, &written, NULL);
+    TEST_ASSERT("Batch stops when buffer is full", encoded == 2 && written == 2 * HEADER_SIZE + 2);
+    TEST_ASSERT("Batch keeps packet count", buffer[4] == 0 && buffer[5] == 42);
+}
+
+void test_caller_storage() {
+    // Tiny receiver with caller storage
+    uint8_t small_storage[64];
+    PakitReceiver small;
+    PakitStatus status = pakit_create(&small, small_storage, sizeof(small_storage));
+    TEST_ASSERT("Create with caller storage", status == PAKIT_STATUS_SUCCESS);
+    TEST_ASSERT("Caller storage used", small.payload == small_storage && small.max_payload_size == 64);
+
+    uint8_t too_large[] = {0xB0, 0xB2, 0x01, 0x01, 0x00, 0x01, 0x00, 65};
+    status = pakit_receive_buffer(&small, too_large, sizeof(too_large), NULL);
+    TEST_ASSERT("Payload above capacity rejected", status == PAKIT_STATUS_ERROR_SIZE_LARGE);
+
+    uint8_t fits[8 + 64] = {0xB0, 0xB2, 0x01, 0x01, 0x00, 0x02, 0x00, 64};
+    fits[8 + 63] = 0x7E;
+    status = pakit_receive_buffer(&small, fits, sizeof(fits), NULL);
+    TEST_ASSERT("Payload at capacity accepted", status == PAKIT_STATUS_SUCCESS &&
+                                               small_storage[63] == 0x7E);
+    pakit_destroy(&small);
+    TEST_ASSERT("Caller storage kept on destroy", small.payload == small_storage);
+
+    // Large receiver with allocated storage for firmware sized frames
+    const uint16_t frame_size = 4096;
+    static uint8_t frame[HEADER_SIZE + 4096];
+    Packet packet;
+    pakit_packet_create(&packet, 0x0F0F, 3, &frame[HEADER_SIZE], frame_size);
+    for (size_t i = 0; i < frame_size; i++) {
+        frame[HEADER_SIZE + i] = (uint8_t)(i * 7);
+    }
+    pakit_encode_header(frame, &packet);
+
+    PakitReceiver large;
+    status = pakit_create(&large, NULL, frame_size);
+    TEST_ASSERT("Create with allocated storage", status == PAKIT_STATUS_SUCCESS &&
+                                                large.owns_storage && large.max_payload_size == frame_size);
+
+    size_t position = 0;
+    while (position < 100) {
+        status = pakit_receive_byte(&large, frame[position++]);
+    }
+    status = pakit_receive_buffer(&large, frame, sizeof(frame), &position);
+    Packet received;
+    TEST_ASSERT("Large frame received", status == PAKIT_STATUS_SUCCESS &&
+                                       pakit_is_packet_complete(&large, &received) &&
+                                       received.size == frame_size &&
+                                       memcmp(received.payload, &frame[HEADER_SIZE], frame_size) == 0);
+    pakit_destroy(&large);
+    TEST_ASSERT("Allocated storage released", large.payload == NULL && !large.owns_storage);
+
+    TEST_ASSERT("Create NULL receiver", pakit_create(NULL, NULL, 0) == PAKIT_STATUS_ERROR_NULL_PARAM);
+}
+
+void test_receiver_pool() {
+    PakitReceiverPool pool;
+    PakitStatus status = pakit_pool_create(&pool, 3, 1, 16);
+    TEST_ASSERT("Pool created", status == PAKIT_STATUS_SUCCESS && pool.free_count == 1);
+
+    uint8_t first[] = {0xB0, 0xB2, 0x00, 0x01, 0x00, 0x01, 0x00, 0x04, 'a', 'b', 'c', 'd'};
+    uint8_t second[] = {0xB0, 0xB2, 0x00, 0x02, 0x00, 0x07, 0x00, 0x02, 'x', 'y'};
+    PakitView view;
+
+    // Whole packet in the buffer is delivered in place without a slot
+    size_t position = 0;
+    status = pakit_pool_receive(&pool, 0, first, sizeof(first), &position, &view);
+    TEST_ASSERT("Pool in-place packet", status == PAKIT_STATUS_SUCCESS && view.payload == &first[8] &&
+                                       pool.free_count == 1);
+
+    // Channel 1 receives a fragmented packet and takes the only slot
+    position = 0;
+    status = pakit_pool_receive(&pool, 1, first, 5, &position, &view);
+    TEST_ASSERT("Pool fragment header", status == PAKIT_STATUS_IN_PROGRESS && position == 5);
+    position = 5;
+    status = pakit_pool_receive(&pool, 1, first, 10, &position, &view);
+    TEST_ASSERT("Pool slot taken", status == PAKIT_STATUS_IN_PROGRESS && pool.free_count == 0);
+
+    // Channel 2 has no slot left for its fragmented packet
+    position = 0;
+    status = pakit_pool_receive(&pool, 2, second, 9, &position, &view);
+    TEST_ASSERT("Pool exhausted", status == PAKIT_STATUS_ERROR_NO_MEMORY && position == 8);
+
+    // Channel 1 completes from its slot
+    position = 10;
+    status = pakit_pool_receive(&pool, 1, first, sizeof(first), &position, &view);
+    TEST_ASSERT("Pool slot packet", status == PAKIT_STATUS_SUCCESS && view.type == 0x0001 &&
+                                   view.size == 4 && memcmp(view.payload, "abcd", 4) == 0);
+    TEST_ASSERT("Pool slot held until next call", pool.free_count == 0);
+
+    // Next call on channel 1 releases the slot, so channel 2 can buffer again
+    position = 0;
+    status = pakit_pool_receive(&pool, 1, second, 0, &position, &view);
+    TEST_ASSERT("Pool slot released", pool.free_count == 1);
+    position = 0;
+    status = pakit_pool_receive(&pool, 2, second, 9, &position, &view);
+    position = 9;
+    status = pakit_pool_receive(&pool, 2, second, sizeof(second), &position, &view);
+    TEST_ASSERT("Pool second channel packet", status == PAKIT_STATUS_SUCCESS && view.count == 7 &&
+                                             memcmp(view.payload, "xy", 2) == 0);
+
+    // Fragmented SOP across reads and a repeated first SOP byte
+    uint8_t noisy[] = {0xB0, 0xB0, 0xB2, 0x00, 0x03, 0x00, 0x03, 0x00, 0x00};
+    position = 0;
+    status = pakit_pool_receive(&pool, 0, noisy, 1, &position, &view);
+    TEST_ASSERT("Pool first SOP byte staged", status == PAKIT_STATUS_IN_PROGRESS && position == 1);
+    status = pakit_pool_receive(&pool, 0, noisy, 2, &position, &view);
+    TEST_ASSERT("Pool repeated SOP byte", status == PAKIT_STATUS_ERROR_INVALID_SOP && position == 2 &&
+                                         pool.received_bytes[0] == 1);
+    status = pakit_pool_receive(&pool, 0, noisy, sizeof(noisy), &position, &view);
+    TEST_ASSERT("Pool packet after repeated SOP", status == PAKIT_STATUS_SUCCESS && view.count == 3 &&
+                                                 view.size == 0 && view.payload == NULL);
+
+    TEST_ASSERT("Pool bad channel", pakit_pool_receive(&pool, 3, first, sizeof(first), NULL, &view) ==
+                                    PAKIT_STATUS_ERROR_NULL_PARAM);
+
+    pakit_pool_destroy(&pool);
+
+    TEST_ASSERT("Pool channel count overflow", pakit_pool_create(&pool, SIZE_MAX / 2, 1, 16) ==
+                                               PAKIT_STATUS_ERROR_NO_MEMORY && pool.state == NULL);
+}
+
+void test_ring_receive() {
+    uint8_t storage[16];
+    PakitRing ring;
+    TEST_ASSERT("Ring rejects non power of two", pakit_ring_init(&ring, storage, 12) == false);
+    TEST_ASSERT("Ring init", pakit_ring_init(&ring, storage, sizeof(storage)) == true);
+
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+
+    // Move the indices so the next packet wraps around the end of storage
+    uint8_t filler[11] = {0};
+    pakit_ring_write(&ring, filler, sizeof(filler));
+    pakit_ring_consume(&ring, sizeof(filler));
+
+    uint8_t packet_bytes[] = {0xB0, 0xB2, 0x04, 0x04, 0x00, 0x09, 0x00, 0x03, 'R', 'N', 'G'};
+    for (size_t i = 0; i < 6; i++) {
+        TEST_ASSERT("Ring put", pakit_ring_put(&ring, packet_bytes[i]) == true);
+    }
+    size_t written = pakit_ring_write(&ring, &packet_bytes[6], sizeof(packet_bytes) - 6);
+    TEST_ASSERT("Ring write", written == sizeof(packet_bytes) - 6 && pakit_ring_used(&ring) == 11);
+
+    const uint8_t* first;
+    const uint8_t* second;
+    size_t first_length;
+    size_t second_length;
+    pakit_ring_peek(&ring, &first, &first_length, &second, &second_length);
+    TEST_ASSERT("Ring data wraps", first_length == 5 && second_length == 6);
+
+    PakitStatus status = pakit_receive_ring(&receiver, &ring);
+    Packet packet;
+    TEST_ASSERT("Ring packet received", status == PAKIT_STATUS_SUCCESS &&
+                                       pakit_is_packet_complete(&receiver, &packet) &&
+                                       packet.count == 9 && memcmp(packet.payload, "RNG", 3) == 0);
+    TEST_ASSERT("Ring drained", pakit_ring_used(&ring) == 0);
+
+    // Full ring refuses more bytes
+    uint8_t big[20] = {0};
+    TEST_ASSERT("Ring write limited by space", pakit_ring_write(&ring, big, sizeof(big)) == 16);
+    TEST_ASSERT("Ring put when full", pakit_ring_put(&ring, 0) == false);
+    status = pakit_receive_ring(&receiver, &ring);
+    TEST_ASSERT("Ring garbage up to wrap discarded", status == PAKIT_STATUS_ERROR_INVALID_SOP &&
+                                                    pakit_ring_used(&ring) == 6);
+    status = pakit_receive_ring(&receiver, &ring);
+    TEST_ASSERT("Ring garbage discarded", status == PAKIT_STATUS_ERROR_INVALID_SOP &&
+                                         pakit_ring_used(&ring) == 0);
+
+    pakit_destroy(&receiver);
+}
+
+typedef struct {
+    size_t offset;
+    uint16_t type;
+    uint16_t count;
+    uint16_t size;
+} DecodedRecord;
+
+typedef struct {
+    DecodedRecord* records;
+    size_t count;
+    size_t capacity;
+    size_t stop_after;
+} DecodedList;
+
+static bool collect_record(void* context, size_t offset, const PakitView* view) {
+    DecodedList* list = context;
+    if (list->count < list->capacity) {
+        DecodedRecord record = {offset, view->type, view->count, view->size};
+        list->records[list->count] = record;
+    }
+    list->count++;
+    return list->stop_after == 0 || list->count < list->stop_after;
+}
+
+// Builds a capture with garbage runs and payloads full of fake SOPs and headers
+static size_t build_noisy_capture(uint8_t* data, size_t capacity) {
+    uint32_t seed = 99;
+    size_t length = 0;
+    uint16_t count = 0;
+
+    while (length + HEADER_SIZE + 64 < capacity) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t pick = seed >> 16;
+
+        if ((pick & 0x7) == 0) {
+            // Garbage run, sometimes with a lone or fake SOP
+            size_t run = pick % 13;
+            for (size_t i = 0; i < run; i++) {
+                data[length++] = (i % 5 == 0) ? EXPECTED_SOP_0 : (uint8_t)(pick + i);
+            }
+            continue;
+        }
+
+        uint16_t size = (uint16_t)(pick % 48);
+        uint8_t payload[64];
+        for (uint16_t i = 0; i < size; i++) {
+            payload[i] = (i % 4 == 0) ? EXPECTED_SOP_0 : (i % 4 == 1) ? EXPECTED_SOP_1 : (uint8_t)(i * pick);
+        }
+
+        Packet packet;
+        pakit_packet_create(&packet, (uint16_t)(pick & 0xFF), count++, size ? payload : NULL, size);
+        size_t written = 0;
+        pakit_encode_batch(&packet, 1, &data[length], capacity - length, &written, NULL);
+        length += written;
+    }
+
+    return length;
+}
+
+void test_parallel_decode_matches_single_thread() {
+    static uint8_t data[40000];
+    static DecodedRecord expected_records[8000];
+    static DecodedRecord actual_records[8000];
+    size_t length = build_noisy_capture(data, sizeof(data));
+
+    // Single receiver reference
+    DecodedList expected = {expected_records, 0, 8000, 0};
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    size_t position = 0;
+    while (position < length) {
+        PakitView view;
+        if (pakit_next_view(&receiver, data, length, &position, &view) == PAKIT_STATUS_SUCCESS) {
+            collect_record(&expected, (size_t)(view.payload - data) - HEADER_SIZE, &view);
+        }
+    }
+    pakit_destroy(&receiver);
+    TEST_ASSERT("Reference decoded packets", expected.count > 1000);
+
+    const PakitParallelOptions configs[] = {
+        {4, 97, 0},
+        {3, 1000, 0},
+        {8, 4096, 0},
+        {1, 0, 0},
+        {2, 50, 0},     // Hundreds of windows through the same four slots
+        {16, 300, 0},
+    };
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+        DecodedList actual = {actual_records, 0, 8000, 0};
+        size_t delivered = pakit_decode_parallel(data, length, &configs[c], collect_record, &actual);
+        bool match = delivered == expected.count && actual.count == expected.count &&
+                     memcmp(actual_records, expected_records, expected.count * sizeof(DecodedRecord)) == 0;
+        TEST_ASSERT("Parallel decode matches single receiver", match);
+    }
+
+    // Early stop from the callback
+    DecodedList limited = {actual_records, 0, 8000, 10};
+    size_t delivered = pakit_decode_parallel(data, length, &configs[0], collect_record, &limited);
+    TEST_ASSERT("Parallel decode stops on request", delivered == 10 &&
+                memcmp(actual_records, expected_records, 10 * sizeof(DecodedRecord)) == 0);
+
+    // Stopping many windows in, with workers still decoding ahead
+    DecodedList late = {actual_records, 0, 8000, 700};
+    delivered = pakit_decode_parallel(data, length, &configs[4], collect_record, &late);
+    TEST_ASSERT("Parallel decode stops mid-pipeline", delivered == 700 &&
+                memcmp(actual_records, expected_records, 700 * sizeof(DecodedRecord)) == 0);
+
+    TEST_ASSERT("Parallel decode NULL data", pakit_decode_parallel(NULL, 10, NULL, collect_record, &limited) == 0);
+}
+
+void test_capture_file_round_trip() {
+    static uint8_t payloads[300][40];
+    static Packet packets[300];
+    for (size_t i = 0; i < 300; i++) {
+        memset(payloads[i], (int)i, sizeof(payloads[i]));
+        pakit_packet_create(&packets[i], (uint16_t)(i % 7), 0, i % 5 ? payloads[i] : NULL,
+                            (uint16_t)(i % 5 ? i % 40 : 0));
+    }
+
+    const unsigned flag_sets[] = {0, PAKIT_FILE_DIRECT};
+    for (size_t f = 0; f < 2; f++) {
+        char path[] = "/tmp/pakit_capture_XXXXXX";
+        int fd = mkstemp(path);
+        close(fd);
+
+        // Small buffer forces several flushes, including unaligned tails
+        PakitFileWriter writer;
+        uint16_t sequence = 100;
+        PakitStatus status = pakit_file_create(&writer, path, flag_sets[f], 1);
+        TEST_ASSERT("Capture file created", status == PAKIT_STATUS_SUCCESS);
+        for (size_t repeat = 0; repeat < 10; repeat++) {
+            status = pakit_file_write(&writer, packets, 300, &sequence);
+        }
+        TEST_ASSERT("Capture packets written", status == PAKIT_STATUS_SUCCESS);
+        TEST_ASSERT("Capture file finished", pakit_file_finish(&writer) == PAKIT_STATUS_SUCCESS);
+
+        PakitFileReader reader;
+        status = pakit_file_open(&reader, path, 0);
+        TEST_ASSERT("Capture file opened", status == PAKIT_STATUS_SUCCESS);
+
+        PakitView view;
+        size_t offset = 0;
+        size_t expected_offset = 0;
+        size_t found = 0;
+        bool match = true;
+        while (pakit_file_next(&reader, &view, &offset)) {
+            const Packet* packet = &packets[found % 300];
+            if (offset != expected_offset || view.count != (uint16_t)(100 + found) ||
+                view.type != (packet->type[1]) || view.size != packet->size ||
+                (view.size && memcmp(view.payload, packet->payload, view.size) != 0) ||
+                view.payload != reader.data + offset + HEADER_SIZE) {
+                match = false;
+            }
+            expected_offset = offset + HEADER_SIZE + view.size;
+            found++;
+        }
+        TEST_ASSERT("Capture packets read back in place", found == 3000 && match &&
+                                                         expected_offset == reader.length);
+
+        DecodedRecord records[3000];
+        DecodedList list = {records, 0, 3000, 0};
+        PakitParallelOptions options = {4, 4096, 0};
+        TEST_ASSERT("Capture file parallel decode",
+                    pakit_file_decode_parallel(&reader, &options, collect_record, &list) == 3000 &&
+                    records[2999].count == (uint16_t)(100 + 2999));
+
+        pakit_file_close(&reader);
+        unlink(path);
+    }
+
+    PakitFileReader missing;
+    TEST_ASSERT("Missing capture file", pakit_file_open(&missing, "/nonexistent/capture", 0) ==
+                                        PAKIT_STATUS_ERROR_IO);
+}
+
+void test_capture_index() {
+    static uint8_t data[40000];
+    static DecodedRecord records[8000];
+    size_t length = build_noisy_capture(data, sizeof(data));
+
+    char capture_path[] = "/tmp/pakit_index_capture_XXXXXX";
+    int fd = mkstemp(capture_path);
+    TEST_ASSERT("Capture written", write(fd, data, length) == (ssize_t)length);
+    close(fd);
+
+    PakitFileReader reader;
+    pakit_file_open(&reader, capture_path, 0);
+    DecodedList expected = {records, 0, 8000, 0};
+    pakit_file_decode_parallel(&reader, NULL, collect_record, &expected);
+
+    char index_path[] = "/tmp/pakit_index_XXXXXX";
+    close(mkstemp(index_path));
+
+    const PakitParallelOptions configs[] = {{1, 0, 0}, {4, 97, 0}};
+    for (size_t c = 0; c < 2; c++) {
+        TEST_ASSERT("Index built", pakit_index_build(&reader, index_path, &configs[c]) ==
+                                   PAKIT_STATUS_SUCCESS);
+
+        PakitIndex index;
+        TEST_ASSERT("Index opened", pakit_index_open(&index, index_path) == PAKIT_STATUS_SUCCESS);
+
+        bool match = index.entry_count == expected.count && index.source_size == length;
+        for (size_t i = 0; match && i < expected.count; i++) {
+            const PakitIndexEntry* entry = pakit_index_get(&index, i);
+            match = entry->offset == records[i].offset && entry->type == records[i].type &&
+                    entry->count == records[i].count && entry->size == records[i].size;
+        }
+        TEST_ASSERT("Index entries match decoded packets", match);
+        TEST_ASSERT("Index ordinal out of range", pakit_index_get(&index, expected.count) == NULL);
+
+        // Seek by ordinal
+        size_t ordinal = expected.count / 2;
+        PakitView view;
+        TEST_ASSERT("Index view", pakit_index_view(&index, &reader, ordinal, &view) &&
+                    view.payload == reader.data + records[ordinal].offset + HEADER_SIZE &&
+                    view.count == records[ordinal].count);
+
+        // Seek by offset: exact and between packets
+        TEST_ASSERT("Index find exact offset",
+                    pakit_index_find_offset(&index, records[ordinal].offset) == ordinal);
+        TEST_ASSERT("Index find offset inside packet",
+                    pakit_index_find_offset(&index, records[ordinal].offset + 1) == ordinal + 1);
+        TEST_ASSERT("Index find offset past end",
+                    pakit_index_find_offset(&index, length) == PAKIT_INDEX_NOT_FOUND);
+
+        // Seek by sequence number and type
+        TEST_ASSERT("Index find count", pakit_index_find_count(&index, records[ordinal].count, 0) == ordinal);
+        size_t typed = pakit_index_find_type(&index, records[ordinal].type, ordinal);
+        TEST_ASSERT("Index find type", typed == ordinal);
+        size_t next_typed = pakit_index_find_type(&index, records[ordinal].type, ordinal + 1);
+        bool none_between = true;
+        for (size_t i = ordinal + 1; i < expected.count && i < next_typed; i++) {
+            none_between = none_between && records[i].type != records[ordinal].type;
+        }
+        TEST_ASSERT("Index find next type", next_typed > ordinal && none_between);
+        TEST_ASSERT("Index find missing count",
+                    pakit_index_find_count(&index, 0xFFFF, 0) == PAKIT_INDEX_NOT_FOUND);
+
+        // Both lookups agree with a forward scan from every kind of start
+        bool count_ok = true;
+        bool type_ok = true;
+        for (size_t from = 0; from <= expected.count + 1; from += (from < 50) ? 1 : 37) {
+            for (size_t probe = 0; probe < 40; probe++) {
+                uint16_t key = (uint16_t)(probe < 32 ? records[(from + probe * 7) % expected.count].count
+                                                     : 0xFFF0 + probe);
+                size_t scan = PAKIT_INDEX_NOT_FOUND;
+                for (size_t i = from; i < expected.count && scan == PAKIT_INDEX_NOT_FOUND; i++) {
+                    scan = (records[i].count == key) ? i : scan;
+                }
+                count_ok = count_ok && pakit_index_find_count(&index, key, from) == scan;
+
+                key = (uint16_t)(probe < 32 ? records[(from + probe * 11) % expected.count].type : 0x100 + probe);
+                scan = PAKIT_INDEX_NOT_FOUND;
+                for (size_t i = from; i < expected.count && scan == PAKIT_INDEX_NOT_FOUND; i++) {
+                    scan = (records[i].type == key) ? i : scan;
+                }
+                type_ok = type_ok && pakit_index_find_type(&index, key, from) == scan;
+            }
+        }
+        TEST_ASSERT("Index count lookup matches scan", count_ok);
+        TEST_ASSERT("Index type lookup matches scan", type_ok);
+        TEST_ASSERT("Index type table", index.type_count > 1 && index.type_count <= 256);
+
+        pakit_index_close(&index);
+    }
+
+    // An index of a different capture of the same size gives no views
+    PakitIndex stale;
+    pakit_file_close(&reader);
+    FILE* shifted = fopen(capture_path, "wb");
+    TEST_ASSERT("Capture rewritten shifted", fwrite(&data[1], 1, length - 1, shifted) == length - 1 &&
+                                             fwrite(data, 1, 1, shifted) == 1);
+    fclose(shifted);
+    pakit_file_open(&reader, capture_path, 0);
+    TEST_ASSERT("Stale index opened", pakit_index_open(&stale, index_path) == PAKIT_STATUS_SUCCESS);
+    bool any_view = false;
+    for (size_t i = 0; i < stale.entry_count; i++) {
+        PakitView view;
+        any_view = any_view || pakit_index_view(&stale, &reader, i, &view);
+    }
+    TEST_ASSERT("Stale index views rejected", !any_view);
+    pakit_index_close(&stale);
+
+    // An index missing part of its lookup sections is rejected, as is a truncated one
+    struct stat info;
+    stat(index_path, &info);
+    TEST_ASSERT("Index lookups cut", truncate(index_path, info.st_size - 8) == 0);
+    PakitIndex cut;
+    TEST_ASSERT("Cut index rejected", pakit_index_open(&cut, index_path) == PAKIT_STATUS_ERROR_IO);
+    TEST_ASSERT("Index truncated", truncate(index_path, sizeof(PakitIndexFileHeader) + 8) == 0);
+    PakitIndex broken;
+    TEST_ASSERT("Truncated index rejected", pakit_index_open(&broken, index_path) == PAKIT_STATUS_ERROR_IO);
+
+    pakit_file_close(&reader);
+    unlink(capture_path);
+    unlink(index_path);
+}
+
+static uint32_t reference_crc32c(const uint8_t* data, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0);
+        }
+    }
+    return ~crc;
+}
+
+void test_crc32c() {
+    const uint8_t check[] = "123456789";
+    TEST_ASSERT("CRC32C check value", pakit_crc32c(0, check, 9) == 0xE3069283u);
+    TEST_ASSERT("CRC32C of nothing", pakit_crc32c(0, check, 0) == 0);
+
+    uint8_t data[300];
+    uint32_t seed = 7;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (uint8_t)(seed >> 16);
+    }
+
+    // Every length and split point, from odd offsets, matches the bitwise reference
+    bool match = true;
+    for (size_t length = 0; length < 40 && match; length++) {
+        for (size_t split = 0; split <= length; split++) {
+            uint32_t crc = pakit_crc32c(pakit_crc32c(0, &data[3], split), &data[3 + split], length - split);
+            match = match && crc == reference_crc32c(&data[3], length);
+        }
+    }
+    match = match && pakit_crc32c(0, data, sizeof(data)) == reference_crc32c(data, sizeof(data));
+    TEST_ASSERT("CRC32C matches reference in pieces", match);
+}
+
+void test_crc_trailer() {
+    uint8_t payload[40];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7);
+    }
+
+    // Three packets: full, empty, full
+    uint8_t stream[3 * (HEADER_SIZE + sizeof(payload) + PAKIT_CRC_SIZE)];
+    size_t length = 0;
+    Packet packet;
+    pakit_packet_create(&packet, 0x0A0B, 1, payload, sizeof(payload));
+    length += pakit_encode_crc(&packet, &stream[length], sizeof(stream) - length);
+    pakit_packet_create(&packet, 0x0A0C, 2, NULL, 0);
+    length += pakit_encode_crc(&packet, &stream[length], sizeof(stream) - length);
+    pakit_packet_create(&packet, 0x0A0D, 3, payload, sizeof(payload));
+    size_t last = length;
+    length += pakit_encode_crc(&packet, &stream[length], sizeof(stream) - length);
+    TEST_ASSERT("CRC packets encoded", length == 2 * sizeof(payload) + 3 * (HEADER_SIZE + PAKIT_CRC_SIZE));
+    TEST_ASSERT("CRC encode refuses short buffer", pakit_encode_crc(&packet, stream, HEADER_SIZE + 42) == 0);
+
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    pakit_set_crc(&receiver, true);
+
+    // Byte by byte: the packet only completes once the trailer is checked
+    int completed = 0;
+    bool early = false;
+    for (size_t i = 0; i < length; i++) {
+        PakitStatus status = pakit_receive_byte(&receiver, stream[i]);
+        if (status == PAKIT_STATUS_SUCCESS) {
+            completed++;
+        } else if (pakit_is_packet_complete(&receiver, NULL)) {
+            early = true;
+        }
+    }
+    TEST_ASSERT("CRC byte path completes packets", completed == 3 && !early);
+
+    // Zero-copy views, and a split read leaving the trailer for the next buffer
+    PakitView view;
+    size_t position = 0;
+    int views = 0;
+    while (position < length) {
+        if (pakit_next_view(&receiver, stream, length, &position, &view) == PAKIT_STATUS_SUCCESS) {
+            views++;
+        }
+    }
+    TEST_ASSERT("CRC views", views == 3 && view.count == 3 && view.payload == &stream[last + HEADER_SIZE]);
+
+    size_t split = length - 2;
+    position = 0;
+    views = 0;
+    while (position < split) {
+        if (pakit_next_view(&receiver, stream, split, &position, &view) == PAKIT_STATUS_SUCCESS) {
+            views++;
+        }
+    }
+    position = 0;
+    PakitStatus status = pakit_next_view(&receiver, &stream[split], 2, &position, &view);
+    TEST_ASSERT("CRC split trailer", views == 2 && status == PAKIT_STATUS_SUCCESS &&
+                view.count == 3 && memcmp(view.payload, payload, sizeof(payload)) == 0);
+
+    // A corrupted payload byte drops only that packet
+    stream[HEADER_SIZE + 5] ^= 0x01;
+    const size_t chunks[] = {1, 7, length};
+    for (size_t c = 0; c < 3; c++) {
+        pakit_init(&receiver);
+        position = 0;
+        int errors = 0;
+        int good = 0;
+        while (position < length) {
+            size_t end = (position + chunks[c] < length) ? position + chunks[c] : length;
+            status = pakit_next_view(&receiver, stream, end, &position, &view);
+            errors += (status == PAKIT_STATUS_ERROR_CRC);
+            good += (status == PAKIT_STATUS_SUCCESS);
+        }
+        TEST_ASSERT("CRC mismatch detected", errors == 1 && good == 2 && view.count == 3);
+    }
+
+    // Batch decode reports the two intact packets
+    PakitView batch[4];
+    size_t consumed = 0;
+    pakit_init(&receiver);
+    TEST_ASSERT("CRC batch", pakit_receive_batch(&receiver, stream, length, batch, 4, &consumed) == 2 &&
+                consumed == length && batch[0].count == 2 && batch[1].count == 3);
+
+    pakit_destroy(&receiver);
+}
+
+void test_sequence_tracking() {
+    PakitSequenceEntry entries[4];
+    PakitSequenceTracker tracker;
+    TEST_ASSERT("Sequence capacity must be a power of two", !pakit_sequence_init(&tracker, entries, 3, true));
+    TEST_ASSERT("Sequence tracker init", pakit_sequence_init(&tracker, entries, 4, true));
+
+    // Type 1 wraps around 0xFFFF and skips two packets; type 2 is independent
+    TEST_ASSERT("Sequence first", pakit_sequence_update(&tracker, 1, 0xFFFE) == PAKIT_SEQUENCE_FIRST);
+    TEST_ASSERT("Sequence in order", pakit_sequence_update(&tracker, 1, 0xFFFF) == PAKIT_SEQUENCE_IN_ORDER);
+    TEST_ASSERT("Sequence wraps", pakit_sequence_update(&tracker, 1, 0) == PAKIT_SEQUENCE_IN_ORDER);
+    TEST_ASSERT("Sequence other type", pakit_sequence_update(&tracker, 2, 500) == PAKIT_SEQUENCE_FIRST);
+    TEST_ASSERT("Sequence gap", pakit_sequence_update(&tracker, 1, 3) == PAKIT_SEQUENCE_GAP &&
+                tracker.last_gap == 2);
+    TEST_ASSERT("Sequence duplicate", pakit_sequence_update(&tracker, 1, 3) == PAKIT_SEQUENCE_DUPLICATE);
+    TEST_ASSERT("Sequence late packet", pakit_sequence_update(&tracker, 1, 1) == PAKIT_SEQUENCE_REORDERED);
+    TEST_ASSERT("Sequence continues", pakit_sequence_update(&tracker, 1, 4) == PAKIT_SEQUENCE_IN_ORDER &&
+                pakit_sequence_update(&tracker, 2, 501) == PAKIT_SEQUENCE_IN_ORDER);
+    TEST_ASSERT("Sequence stats", tracker.stats.packets == 9 && tracker.stats.gaps == 1 &&
+                tracker.stats.lost == 1 && tracker.stats.duplicates == 1 && tracker.stats.reordered == 1);
+
+    // Table full
+    pakit_sequence_update(&tracker, 3, 0);
+    pakit_sequence_update(&tracker, 4, 0);
+    TEST_ASSERT("Sequence table full", pakit_sequence_update(&tracker, 5, 0) == PAKIT_SEQUENCE_UNTRACKED &&
+                tracker.stats.untracked == 1);
+
+    // Types differing only in their high byte do not pile up on a few slots
+    PakitSequenceEntry spread_entries[32];
+    PakitSequenceTracker spread;
+    pakit_sequence_init(&spread, spread_entries, 32, true);
+    for (uint16_t k = 1; k <= 16; k++) {
+        pakit_sequence_update(&spread, (uint16_t)(k << 8), 0);
+    }
+    size_t run = 0;
+    size_t longest_run = 0;
+    for (size_t i = 0; i < 64; i++) {
+        run = spread_entries[i % 32].used ? run + 1 : 0;
+        longest_run = (run > longest_run) ? run : longest_run;
+    }
+    TEST_ASSERT("Sequence hash spreads high-byte types", spread.stats.untracked == 0 && longest_run <= 4);
+
+    // Attached to a receiver, across the byte, bulk and zero-copy paths
+    uint8_t stream[6 * (HEADER_SIZE + 3)];
+    const uint16_t counts[] = {10, 11, 13, 14, 14, 15};
+    uint8_t payload[3] = {1, 2, 3};
+    size_t length = 0;
+    for (size_t i = 0; i < 6; i++) {
+        Packet packet;
+        pakit_packet_create(&packet, 0x0700, counts[i], payload, sizeof(payload));
+        size_t written = 0;
+        pakit_encode_batch(&packet, 1, &stream[length], sizeof(stream) - length, &written, NULL);
+        length += written;
+    }
+
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    pakit_sequence_init(&tracker, entries, 4, false);
+    pakit_set_sequence(&receiver, &tracker);
+
+    for (size_t i = 0; i < length; i++) {
+        pakit_receive_byte(&receiver, stream[i]);
+    }
+    TEST_ASSERT("Receiver tracks sequence byte by byte", tracker.stats.packets == 6 &&
+                tracker.stats.lost == 1 && tracker.stats.duplicates == 1);
+
+    pakit_sequence_reset(&tracker);
+    size_t position = 0;
+    while (position < length) {
+        PakitView view;
+        size_t end = (position + 5 < length) ? position + 5 : length;
+        if (position % 2 == 0) {
+            end = length;
+        }
+        pakit_next_view(&receiver, stream, end, &position, &view);
+    }
+    TEST_ASSERT("Receiver tracks sequence on views", tracker.stats.packets == 6 &&
+                tracker.stats.lost == 1 && tracker.stats.duplicates == 1 && tracker.stats.gaps == 1);
+
+    pakit_set_sequence(&receiver, NULL);
+    pakit_receive_buffer(&receiver, stream, length, NULL);
+    TEST_ASSERT("Detached tracker is untouched", tracker.stats.packets == 6);
+
+    pakit_destroy(&receiver);
+}
+
+void test_receiver_stats() {
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 16);
+
+    // 3 garbage bytes, a good packet, an oversized header, a good packet
+    // split across two reads
+    uint8_t stream[] = {
+        0x11, 0x22, 0x33,
+        0xB0, 0xB2, 0x00, 0x01, 0x00, 0x01, 0x00, 0x02, 0xAA, 0xBB,
+        0xB0, 0xB2, 0x00, 0x01, 0x00, 0x02, 0x00, 0x20,
+        0xB0, 0xB2, 0x00, 0x01, 0x00, 0x03, 0x00, 0x01, 0xCC,
+    };
+    size_t split = sizeof(stream) - 3;
+    size_t position = 0;
+    int packets = 0;
+    while (position < split) {
+        PakitView view;
+        packets += pakit_next_view(&receiver, stream, split, &position, &view) == PAKIT_STATUS_SUCCESS;
+    }
+    position = 0;
+    PakitView view;
+    packets += pakit_next_view(&receiver, &stream[split], 3, &position, &view) == PAKIT_STATUS_SUCCESS;
+    pakit_receive_byte(&receiver, 0x44);
+
+    PakitStats stats;
+#ifdef PAKIT_ENABLE_STATS
+    TEST_ASSERT("Stats enabled", pakit_get_stats(&receiver, &stats));
+    TEST_ASSERT("Stats bytes in", stats.bytes_in == sizeof(stream) + 1);
+    TEST_ASSERT("Stats packets out", packets == 2 && stats.packets_out == 2);
+    TEST_ASSERT("Stats dropped bytes", stats.dropped_invalid_sop == 4 &&
+                stats.dropped_size_large == HEADER_SIZE && stats.dropped_overflow == 0);
+    TEST_ASSERT("Stats resyncs", stats.resyncs == 3);
+
+    pakit_reset_stats(&receiver);
+    pakit_get_stats(&receiver, &stats);
+    TEST_ASSERT("Stats reset", stats.bytes_in == 0 && stats.packets_out == 0);
+#else
+    TEST_ASSERT("Stats compiled out", packets == 2 && !pakit_get_stats(&receiver, &stats) &&
+                stats.bytes_in == 0);
+#endif
+
+    pakit_destroy(&receiver);
+}
+
+typedef struct {
+    int calls;
+    uint16_t last_type;
+    uint16_t last_count;
+    const uint8_t* last_payload;
+    int stop_after;
+} HandlerLog;
+
+static bool log_packet(void* context, const PakitView* view) {
+    HandlerLog* log = context;
+    log->calls++;
+    log->last_type = view->type;
+    log->last_count = view->count;
+    log->last_payload = view->payload;
+    return log->stop_after == 0 || log->calls < log->stop_after;
+}
+
+void test_type_dispatch() {
+    // Types 0x0001, 0x0102, 0xFF00 and an unregistered 0x0103, round robin
+    const uint16_t types[] = {0x0001, 0x0102, 0xFF00, 0x0103};
+    uint8_t payload[5] = {1, 2, 3, 4, 5};
+    uint8_t stream[8 * (HEADER_SIZE + sizeof(payload)) + 3];
+    size_t length = 0;
+    stream[length++] = 0x42;  // Leading garbage
+    for (uint16_t i = 0; i < 8; i++) {
+        Packet packet;
+        pakit_packet_create(&packet, types[i % 4], i, payload, sizeof(payload));
+        size_t written = 0;
+        pakit_encode_batch(&packet, 1, &stream[length], sizeof(stream) - length, &written, NULL);
+        length += written;
+    }
+
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+
+    size_t consumed = 0;
+    TEST_ASSERT("Dispatch without handlers", pakit_receive_dispatch(&receiver, stream, length, &consumed) == 0 &&
+                consumed == length);
+
+    HandlerLog logs[4] = {{0}};
+    pakit_on_type(&receiver, 0x0001, log_packet, &logs[0]);
+    pakit_on_type(&receiver, 0x0102, log_packet, &logs[1]);
+    pakit_on_type(&receiver, 0xFF00, log_packet, &logs[2]);
+
+    // Split the stream inside the fourth packet
+    size_t split = 1 + 3 * (HEADER_SIZE + sizeof(payload)) + 6;
+    size_t dispatched = pakit_receive_dispatch(&receiver, stream, split, &consumed);
+    dispatched += pakit_receive_dispatch(&receiver, &stream[split], length - split, NULL);
+    TEST_ASSERT("Dispatch by type", dispatched == 6 && logs[0].calls == 2 && logs[1].calls == 2 &&
+                logs[2].calls == 2 && logs[2].last_count == 6 && logs[2].last_type == 0xFF00);
+    TEST_ASSERT("Dispatch is zero copy", logs[1].last_payload == &stream[length - 3 * (HEADER_SIZE + 5) + HEADER_SIZE]);
+
+    // Unhandled types go to the fallback; removing a handler sends its type there too
+    pakit_on_unhandled(&receiver, log_packet, &logs[3]);
+    pakit_on_type(&receiver, 0x0102, NULL, NULL);
+    dispatched = pakit_receive_dispatch(&receiver, stream, length, NULL);
+    TEST_ASSERT("Dispatch fallback", dispatched == 8 && logs[3].calls == 4 && logs[1].calls == 2);
+
+    // A handler can stop the loop
+    logs[0].calls = 0;
+    logs[0].stop_after = 1;
+    dispatched = pakit_receive_dispatch(&receiver, stream, length, &consumed);
+    TEST_ASSERT("Dispatch stops on request", dispatched == 1 && consumed == 1 + HEADER_SIZE + sizeof(payload));
+
+    TEST_ASSERT("Dispatch NULL receiver", pakit_on_type(NULL, 1, log_packet, NULL) == PAKIT_STATUS_ERROR_NULL_PARAM);
+    pakit_destroy(&receiver);
+    TEST_ASSERT("Destroy frees handler table", receiver.handlers == NULL);
+}
+
+#if defined(PAKIT_HAVE_IO)
+typedef struct {
+    size_t packets;
+    size_t batches;
+    int closed;
+    uint16_t last_count;
+} IoLog;
+
+static void log_io(void* context, size_t channel, const PakitView* views, size_t count) {
+    IoLog* log = &((IoLog*)context)[channel];
+    if (count == 0) {
+        log->closed += (views == NULL);
+        return;
+    }
+    log->packets += count;
+    log->batches++;
+    log->last_count = views[count - 1].count;
+}
+
+// Polls until every channel has seen at least the expected packets or the budget runs out
+static void poll_until(PakitIoLoop* loop, const IoLog* logs, size_t expected0, size_t expected1) {
+    for (int i = 0; i < 50 && (logs[0].packets < expected0 || logs[1].packets < expected1); i++) {
+        pakit_io_poll(loop, 20, NULL);
+    }
+}
+
+static void run_io_loop(PakitIoBackend backend, const char* name) {
+    PakitIoLoop loop;
+    PakitStatus status = pakit_io_create(&loop, backend, 2, 0);
+    if (status == PAKIT_STATUS_ERROR_IO) {
+        printf("  %s backend unavailable, skipped\n", name);
+        return;
+    }
+    TEST_ASSERT("IO loop created", status == PAKIT_STATUS_SUCCESS);
+
+    int sockets[2];
+    int pipe_fds[2];
+    TEST_ASSERT("IO descriptors", socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0 && pipe(pipe_fds) == 0);
+    fcntl(sockets[0], F_SETFL, fcntl(sockets[0], F_GETFL) | O_NONBLOCK);
+    fcntl(pipe_fds[0], F_SETFL, fcntl(pipe_fds[0], F_GETFL) | O_NONBLOCK);
+
+    PakitReceiver receivers[2];
+    pakit_create(&receivers[0], NULL, 0);
+    pakit_create(&receivers[1], NULL, 0);
+
+    IoLog logs[2];
+    memset(logs, 0, sizeof(logs));
+    size_t channels[2];
+    TEST_ASSERT("IO attach socket", pakit_io_attach(&loop, sockets[0], &receivers[0], log_io, logs,
+                                                    &channels[0]) == PAKIT_STATUS_SUCCESS);
+    TEST_ASSERT("IO attach pipe", pakit_io_attach(&loop, pipe_fds[0], &receivers[1], log_io, logs,
+                                                  &channels[1]) == PAKIT_STATUS_SUCCESS);
+    TEST_ASSERT("IO channel numbers", channels[0] == 0 && channels[1] == 1);
+    TEST_ASSERT("IO channels full", pakit_io_attach(&loop, sockets[0], &receivers[0], log_io, logs,
+                                                    NULL) == PAKIT_STATUS_ERROR_NO_MEMORY);
+
+    uint8_t payload[20];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)i;
+    }
+    uint8_t stream[10 * (HEADER_SIZE + sizeof(payload))];
+    Packet packets[10];
+    for (uint16_t i = 0; i < 10; i++) {
+        pakit_packet_create(&packets[i], 0x0201, i, payload, sizeof(payload));
+    }
+    size_t length = 0;
+    pakit_encode_batch(packets, 10, stream, sizeof(stream), &length, NULL);
+
+    // Nothing to read yet
+    size_t delivered = 1;
+    TEST_ASSERT("IO poll timeout", pakit_io_poll(&loop, 0, &delivered) == PAKIT_STATUS_SUCCESS &&
+                delivered == 0);
+
+    // The socket gets the stream split inside the fourth packet, the pipe all at once
+    size_t split = 3 * (HEADER_SIZE + sizeof(payload)) + 5;
+    TEST_ASSERT("IO write", write(sockets[1], stream, split) == (ssize_t)split &&
+                write(pipe_fds[1], stream, length) == (ssize_t)length);
+    poll_until(&loop, logs, 3, 10);
+    TEST_ASSERT("IO first part", logs[0].packets == 3 && logs[1].packets == 10 && logs[1].last_count == 9);
+
+    TEST_ASSERT("IO write rest", write(sockets[1], &stream[split], length - split) == (ssize_t)(length - split));
+    poll_until(&loop, logs, 10, 10);
+    TEST_ASSERT("IO packet across reads", logs[0].packets == 10 && logs[0].last_count == 9);
+
+    // Closing the writers reports end of stream and frees the channels
+    close(sockets[1]);
+    close(pipe_fds[1]);
+    for (int i = 0; i < 50 && (logs[0].closed == 0 || logs[1].closed == 0); i++) {
+        pakit_io_poll(&loop, 20, NULL);
+    }
+    TEST_ASSERT("IO end of stream", logs[0].closed == 1 && logs[1].closed == 1 &&
+                !loop.channels[0].attached && !loop.channels[1].attached);
+    TEST_ASSERT("IO detach twice", pakit_io_detach(&loop, 0) == PAKIT_STATUS_ERROR_NULL_PARAM);
+
+    // A freed slot can be reused
+    int again[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, again);
+    fcntl(again[0], F_SETFL, fcntl(again[0], F_GETFL) | O_NONBLOCK);
+    memset(logs, 0, sizeof(logs));
+    TEST_ASSERT("IO reattach", pakit_io_attach(&loop, again[0], &receivers[0], log_io, logs,
+                                               &channels[0]) == PAKIT_STATUS_SUCCESS && channels[0] == 0);
+    write(again[1], stream, length);
+    poll_until(&loop, logs, 10, 0);
+    TEST_ASSERT("IO reused slot", logs[0].packets == 10 && logs[0].closed == 0);
+    TEST_ASSERT("IO detach", pakit_io_detach(&loop, channels[0]) == PAKIT_STATUS_SUCCESS);
+
+    pakit_io_destroy(&loop);
+    close(again[0]);
+    close(again[1]);
+    close(sockets[0]);
+    close(pipe_fds[0]);
+    pakit_destroy(&receivers[0]);
+    pakit_destroy(&receivers[1]);
+}
+#endif
+
+void test_io_loop() {
+#if defined(PAKIT_HAVE_IO)
+    run_io_loop(PAKIT_IO_EPOLL, "epoll");
+    run_io_loop(PAKIT_IO_URING, "io_uring");
+    TEST_ASSERT("IO NULL loop", pakit_io_poll(NULL, 0, NULL) == PAKIT_STATUS_ERROR_NULL_PARAM);
+#endif
+}
+
+typedef struct {
+    int headers;
+    int ends;
+    PakitStatus last_status;
+    PakitView header;
+    size_t chunks;
+    size_t next_offset;
+    bool contiguous;
+    uint8_t data[4096];
+} StreamLog;
+
+static void stream_header(void* context, const PakitView* header) {
+    StreamLog* log = context;
+    log->headers++;
+    log->header = *header;
+    log->next_offset = 0;
+}
+
+static void stream_chunk(void* context, size_t offset, const uint8_t* data, size_t length) {
+    StreamLog* log = context;
+    log->chunks++;
+    log->contiguous = log->contiguous && offset == log->next_offset && length > 0;
+    memcpy(&log->data[offset], data, length);
+    log->next_offset = offset + length;
+}
+
+static void stream_end(void* context, PakitStatus status) {
+    StreamLog* log = context;
+    log->ends++;
+    log->last_status = status;
+}
+
+void test_stream_delivery() {
+    // A 3000 byte frame through a receiver with 16 bytes of storage
+    static uint8_t payload[3000];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7);
+    }
+    Packet packets[2];
+    pakit_packet_create(&packets[0], 0x0F0F, 41, payload, sizeof(payload));
+    pakit_packet_create(&packets[1], 0x0F10, 42, NULL, 0);
+    static uint8_t stream[2 * HEADER_SIZE + sizeof(payload) + 2 * PAKIT_CRC_SIZE];
+    size_t length = 0;
+    pakit_encode_batch(packets, 2, stream, sizeof(stream), &length, NULL);
+
+    uint8_t storage[16];
+    PakitReceiver receiver;
+    pakit_create(&receiver, storage, sizeof(storage));
+
+    StreamLog* log = calloc(1, sizeof(StreamLog));
+    log->contiguous = true;
+    PakitStream delivery = {stream_header, stream_chunk, stream_end, log, 4096};
+    pakit_set_stream(&receiver, &delivery);
+
+    // Odd read sizes; the header is announced before any payload arrives
+    size_t position = 0;
+    int completed = 0;
+    bool header_first = true;
+    size_t read_size = 1;
+    while (position < length) {
+        size_t end = (length - position < read_size) ? length : position + read_size;
+        while (position < end) {
+            PakitStatus status = pakit_receive_buffer(&receiver, stream, end, &position);
+            completed += status == PAKIT_STATUS_SUCCESS;
+        }
+        if (position >= HEADER_SIZE && position < HEADER_SIZE + sizeof(payload)) {
+            header_first = header_first && log->headers == 1 && log->ends == 0;
+        }
+        read_size = read_size * 3 + 1;
+    }
+    TEST_ASSERT("Stream header early", header_first);
+    TEST_ASSERT("Stream completes", completed == 2 && log->headers == 2 && log->ends == 2 &&
+                log->last_status == PAKIT_STATUS_SUCCESS);
+    TEST_ASSERT("Stream chunks contiguous", log->contiguous && log->chunks > 1);
+    TEST_ASSERT("Stream payload", memcmp(log->data, payload, sizeof(payload)) == 0);
+    TEST_ASSERT("Stream empty payload header", log->header.type == 0x0F10 && log->header.count == 42 &&
+                log->header.size == 0 && log->header.payload == NULL);
+
+    // Byte by byte
+    memset(log, 0, sizeof(StreamLog));
+    log->contiguous = true;
+    completed = 0;
+    for (size_t i = 0; i < length; i++) {
+        completed += pakit_receive_byte(&receiver, stream[i]) == PAKIT_STATUS_SUCCESS;
+    }
+    Packet received;
+    TEST_ASSERT("Stream byte path", completed == 2 && log->contiguous && log->ends == 2 &&
+                log->chunks == sizeof(payload) && memcmp(log->data, payload, sizeof(payload)) == 0);
+    TEST_ASSERT("Stream packet has no payload", pakit_is_packet_complete(&receiver, &received) &&
+                received.payload == NULL);
+
+    // Views are never decoded in place; chunks of a whole buffer are zero copy
+    memset(log, 0, sizeof(StreamLog));
+    PakitView views[4];
+    size_t consumed = 0;
+    size_t count = pakit_receive_batch(&receiver, stream, length, views, 4, &consumed);
+    TEST_ASSERT("Stream batch", count == 2 && consumed == length && views[0].size == sizeof(payload) &&
+                views[0].payload == NULL && views[0].count == 41 && log->chunks == 1);
+
+    // Frames larger than the stream limit are refused
+    delivery.max_payload_size = 1000;
+    memset(log, 0, sizeof(StreamLog));
+    position = 0;
+    TEST_ASSERT("Stream size limit", pakit_receive_buffer(&receiver, stream, length, &position) ==
+                PAKIT_STATUS_ERROR_SIZE_LARGE && log->headers == 0);
+    delivery.max_payload_size = 4096;
+
+    // CRC mode: a bad trailer ends the streamed packet with an error
+    pakit_set_crc(&receiver, true);
+    length = 0;
+    for (size_t i = 0; i < 2; i++) {
+        length += pakit_encode_crc(&packets[i], &stream[length], sizeof(stream) - length);
+    }
+    stream[HEADER_SIZE + sizeof(payload) + 1] ^= 0x01;
+    memset(log, 0, sizeof(StreamLog));
+    PakitStatus statuses[2];
+    position = 0;
+    statuses[0] = pakit_receive_buffer(&receiver, stream, length, &position);
+    statuses[1] = pakit_receive_buffer(&receiver, stream, length, &position);
+    TEST_ASSERT("Stream CRC mismatch", statuses[0] == PAKIT_STATUS_ERROR_CRC &&
+                statuses[1] == PAKIT_STATUS_SUCCESS && log->ends == 2 &&
+                log->last_status == PAKIT_STATUS_SUCCESS && position == length);
+
+    // Detaching goes back to buffering
+    pakit_set_crc(&receiver, false);
+    pakit_set_stream(&receiver, NULL);
+    TEST_ASSERT("Stream detached", receiver.stream == NULL);
+
+    free(log);
+    pakit_destroy(&receiver);
+}
+
+typedef struct {
+    PakitPacketPool* pool;
+    _Atomic(PakitPacket*) *handoff;   // One slot per packet, filled by the receiving thread
+    size_t packets;
+    size_t bad;
+} PoolConsumer;
+
+static void* consume_packets(void* argument) {
+    PoolConsumer* consumer = argument;
+    for (size_t i = 0; i < consumer->packets; i++) {
+        PakitPacket* packet;
+        while ((packet = atomic_load_explicit(&consumer->handoff[i], memory_order_acquire)) == NULL) {
+        }
+        // The payload repeats the low byte of its count
+        if (packet->view.count != (uint16_t)i || packet->view.size != 40 ||
+            packet->view.payload[0] != (uint8_t)i || packet->view.payload[39] != (uint8_t)i) {
+            consumer->bad++;
+        }
+        pakit_packet_release(packet);
+    }
+    return NULL;
+}
+
+static void* churn_pool(void* argument) {
+    PakitPacketPool* pool = argument;
+    for (int i = 0; i < 20000; i++) {
+        PakitPacket* a = pakit_packet_acquire(pool);
+        PakitPacket* b = pakit_packet_acquire(pool);
+        if (a != NULL) {
+            pakit_packet_data(a)[0] = 1;
+        }
+        pakit_packet_release(a);
+        pakit_packet_release(b);
+    }
+    return NULL;
+}
+
+void test_packet_pool() {
+    PakitPacketPool pool;
+    TEST_ASSERT("Packet pool create", pakit_packet_pool_create(&pool, 4, 100) == PAKIT_STATUS_SUCCESS);
+    TEST_ASSERT("Packet pool NULL", pakit_packet_pool_create(NULL, 4, 100) == PAKIT_STATUS_ERROR_NULL_PARAM);
+
+    // Slots are cache-line aligned and do not overlap
+    PakitPacket* taken[5];
+    for (int i = 0; i < 5; i++) {
+        taken[i] = pakit_packet_acquire(&pool);
+    }
+    TEST_ASSERT("Packet pool exhausted", taken[3] != NULL && taken[4] == NULL &&
+                atomic_load(&pool.free_count) == 0);
+    TEST_ASSERT("Packet pool alignment", ((uintptr_t)taken[0] % PAKIT_CACHE_LINE) == 0 &&
+                ((uintptr_t)pakit_packet_data(taken[1]) % PAKIT_CACHE_LINE) == 0 &&
+                pakit_packet_data(taken[0]) + 100 <= (uint8_t*)taken[1]);
+
+    // References
+    pakit_packet_retain(taken[0]);
+    TEST_ASSERT("Packet pool retained", !pakit_packet_release(taken[0]) && pakit_packet_release(taken[0]));
+    TEST_ASSERT("Packet pool slot reused", pakit_packet_acquire(&pool) == taken[0]);
+    for (int i = 0; i < 4; i++) {
+        pakit_packet_release(taken[i]);
+    }
+    TEST_ASSERT("Packet pool all free", atomic_load(&pool.free_count) == 4);
+
+    // A pooled receiver hands out its packets without copying them
+    uint8_t payload[40];
+    memset(payload, 0x5A, sizeof(payload));
+    Packet packet;
+    pakit_packet_create(&packet, 0x0303, 9, payload, sizeof(payload));
+    uint8_t wire[HEADER_SIZE + sizeof(payload)];
+    size_t length = 0;
+    pakit_encode_batch(&packet, 1, wire, sizeof(wire), &length, NULL);
+
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    TEST_ASSERT("Packet pool attach", pakit_attach_packet_pool(&receiver, &pool) == PAKIT_STATUS_SUCCESS &&
+                receiver.max_payload_size == 100 && !receiver.owns_storage);
+    TEST_ASSERT("Packet pool attach twice", pakit_attach_packet_pool(&receiver, &pool) == PAKIT_STATUS_ERROR_NULL_PARAM);
+    TEST_ASSERT("Packet pool nothing to take", pakit_take_packet(&receiver) == NULL);
+
+    uint8_t* slot_data = receiver.payload;
+    size_t position = 0;
+    PakitStatus status = pakit_receive_buffer(&receiver, wire, length, &position);
+    PakitPacket* received = pakit_take_packet(&receiver);
+    TEST_ASSERT("Packet pool take", status == PAKIT_STATUS_SUCCESS && received != NULL &&
+                received->view.payload == slot_data && received->view.type == 0x0303 &&
+                received->view.count == 9 && received->view.size == sizeof(payload) &&
+                memcmp(received->view.payload, payload, sizeof(payload)) == 0);
+    TEST_ASSERT("Packet pool receiver refilled", receiver.payload != slot_data &&
+                !pakit_is_packet_complete(&receiver, NULL) && pakit_take_packet(&receiver) == NULL);
+
+    // With the pool drained the packet stays in the receiver
+    PakitPacket* rest[2] = {pakit_packet_acquire(&pool), pakit_packet_acquire(&pool)};
+    position = 0;
+    pakit_receive_buffer(&receiver, wire, length, &position);
+    TEST_ASSERT("Packet pool drained", pakit_take_packet(&receiver) == NULL &&
+                pakit_is_packet_complete(&receiver, NULL));
+    pakit_packet_release(rest[0]);
+    pakit_packet_release(rest[1]);
+
+    // Views decoded in place are copied into a slot
+    PakitView view = {0x0404, 3, sizeof(payload), payload};
+    PakitPacket* copied = pakit_packet_from_view(&pool, &view);
+    TEST_ASSERT("Packet pool from view", copied != NULL && copied->view.type == 0x0404 &&
+                copied->view.payload != payload && memcmp(copied->view.payload, payload, sizeof(payload)) == 0);
+    pakit_packet_release(copied);
+    pakit_packet_release(received);
+
+    pakit_destroy(&receiver);
+    TEST_ASSERT("Packet pool slot returned on destroy", atomic_load(&pool.free_count) == 4);
+    pakit_packet_pool_destroy(&pool);
+
+    // Hand packets to another thread while the receiver keeps going
+    enum { HANDOFF_PACKETS = 2000 };
+    _Atomic(PakitPacket*) *handoff = calloc(HANDOFF_PACKETS, sizeof(*handoff));
+    pakit_packet_pool_create(&pool, 16, 64);
+    pakit_create(&receiver, NULL, 0);
+    pakit_attach_packet_pool(&receiver, &pool);
+
+    PoolConsumer consumer = {&pool, handoff, HANDOFF_PACKETS, 0};
+    pthread_t thread;
+    pthread_create(&thread, NULL, consume_packets, &consumer);
+    for (size_t i = 0; i < HANDOFF_PACKETS; i++) {
+        memset(payload, (uint8_t)i, sizeof(payload));
+        pakit_packet_create(&packet, 0x0505, (uint16_t)i, payload, sizeof(payload));
+        pakit_encode_batch(&packet, 1, wire, sizeof(wire), &length, NULL);
+
+        PakitPacket* next = NULL;
+        while (next == NULL) {
+            position = 0;
+            pakit_receive_buffer(&receiver, wire, length, &position);
+            next = pakit_take_packet(&receiver);
+        }
+        atomic_store_explicit(&handoff[i], next, memory_order_release);
+    }
+    pthread_join(thread, NULL);
+    TEST_ASSERT("Packet pool handoff", consumer.bad == 0);
+
+    // Concurrent acquire and release keep the freelist consistent
+    pthread_t churners[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&churners[i], NULL, churn_pool, &pool);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(churners[i], NULL);
+    }
+    size_t distinct = 0;
+    PakitPacket* all[17];
+    while (distinct < 17 && (all[distinct] = pakit_packet_acquire(&pool)) != NULL) {
+        distinct++;
+    }
+    TEST_ASSERT("Packet pool freelist intact", distinct == 15 && atomic_load(&pool.free_count) == 0);
+    for (size_t i = 0; i < distinct; i++) {
+        pakit_packet_release(all[i]);
+    }
+
+    pakit_destroy(&receiver);
+    pakit_packet_pool_destroy(&pool);
+    free(handoff);
+}
+
+enum { QUEUE_PRODUCERS = 3, QUEUE_WORKERS = 4, QUEUE_PACKETS = 3000 };
+
+typedef struct {
+    PakitShardedQueue* queue;
+    uint16_t type;               // Producer p sends types p * 8 .. p * 8 + 7
+    size_t queued;
+} QueueProducer;
+
+typedef struct {
+    PakitShardedQueue* queue;
+    size_t shard;
+    _Atomic int* producers_done;
+    size_t received;
+    size_t out_of_order;
+    uint16_t next_count[QUEUE_PRODUCERS * 8];
+} QueueWorker;
+
+static void* produce_queue(void* argument) {
+    QueueProducer* producer = argument;
+    PakitPacketPool pool;
+    PakitReceiver receiver;
+    pakit_packet_pool_create(&pool, 32, 32);
+    pakit_create(&receiver, NULL, 0);
+    pakit_attach_packet_pool(&receiver, &pool);
+
+    // Count runs per type; the payload's first byte names the type's low bits
+    uint8_t stream[64 * (HEADER_SIZE + 16)];
+    uint16_t counts[8] = {0};
+    for (size_t sent = 0; sent < QUEUE_PACKETS; sent += 64) {
+        size_t length = 0;
+        for (size_t i = 0; i < 64; i++) {
+            uint8_t payload[16];
+            uint16_t type = producer->type + (uint16_t)(i % 8);
+            memset(payload, (uint8_t)type, sizeof(payload));
+            Packet packet;
+            pakit_packet_create(&packet, type, counts[i % 8]++, payload, sizeof(payload));
+            size_t written = 0;
+            pakit_encode_batch(&packet, 1, &stream[length], sizeof(stream) - length, &written, NULL);
+            length += written;
+        }
+        // Split reads so some packets span two calls
+        producer->queued += pakit_receive_enqueue(&receiver, stream, 1000, producer->queue, NULL);
+        producer->queued += pakit_receive_enqueue(&receiver, &stream[1000], length - 1000, producer->queue, NULL);
+    }
+
+    // Wait for the workers to hand every slot back before the pool goes away
+    while (atomic_load(&pool.free_count) != pool.slot_count - 1) {
+        sched_yield();
+    }
+    pakit_destroy(&receiver);
+    pakit_packet_pool_destroy(&pool);
+    return NULL;
+}
+
+static void* work_queue(void* argument) {
+    QueueWorker* worker = argument;
+    PakitQueue* shard = &worker->queue->shards[worker->shard];
+    PakitPacket* batch[16];
+
+    while (true) {
+        bool done = atomic_load(worker->producers_done) == QUEUE_PRODUCERS;
+        size_t count = pakit_queue_pop_batch(shard, batch, 16);
+        for (size_t i = 0; i < count; i++) {
+            const PakitView* view = &batch[i]->view;
+            if (view->count != worker->next_count[view->type] || view->payload[0] != (uint8_t)view->type) {
+                worker->out_of_order++;
+            }
+            worker->next_count[view->type] = view->count + 1;
+            worker->received++;
+            pakit_packet_release(batch[i]);
+        }
+        if (count == 0) {
+            if (done) {
+                break;
+            }
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void test_packet_queue() {
+    // Single-threaded behaviour of one queue
+    PakitQueue queue;
+    TEST_ASSERT("Queue capacity must be a power of two", pakit_queue_create(&queue, 6) == PAKIT_STATUS_ERROR_NULL_PARAM);
+    TEST_ASSERT("Queue create", pakit_queue_create(&queue, 4) == PAKIT_STATUS_SUCCESS);
+
+    PakitPacket items[6];
+    PakitPacket* popped[8];
+    bool pushed = true;
+    for (int i = 0; i < 4; i++) {
+        pushed = pushed && pakit_queue_push(&queue, &items[i]);
+    }
+    TEST_ASSERT("Queue fills", pushed && !pakit_queue_push(&queue, &items[4]));
+    TEST_ASSERT("Queue pops in order", pakit_queue_pop_batch(&queue, popped, 3) == 3 &&
+                popped[0] == &items[0] && popped[2] == &items[2]);
+    TEST_ASSERT("Queue wraps", pakit_queue_push(&queue, &items[4]) && pakit_queue_push(&queue, &items[5]) &&
+                pakit_queue_pop_batch(&queue, popped, 8) == 3 && popped[0] == &items[3] && popped[2] == &items[5]);
+    TEST_ASSERT("Queue empty", pakit_queue_pop_batch(&queue, popped, 8) == 0);
+    pakit_queue_destroy(&queue);
+
+    // Several receiver threads feeding workers that each drain one shard
+    PakitShardedQueue shards;
+    TEST_ASSERT("Shards create", pakit_shards_create(&shards, QUEUE_WORKERS, 64) == PAKIT_STATUS_SUCCESS);
+
+    _Atomic int producers_done = 0;
+    QueueProducer producers[QUEUE_PRODUCERS];
+    QueueWorker* workers = calloc(QUEUE_WORKERS, sizeof(QueueWorker));
+    pthread_t producer_threads[QUEUE_PRODUCERS];
+    pthread_t worker_threads[QUEUE_WORKERS];
+
+    for (size_t i = 0; i < QUEUE_WORKERS; i++) {
+        workers[i].queue = &shards;
+        workers[i].shard = i;
+        workers[i].producers_done = &producers_done;
+        pthread_create(&worker_threads[i], NULL, work_queue, &workers[i]);
+    }
+    for (size_t i = 0; i < QUEUE_PRODUCERS; i++) {
+        producers[i].queue = &shards;
+        producers[i].type = (uint16_t)(i * 8);
+        producers[i].queued = 0;
+        pthread_create(&producer_threads[i], NULL, produce_queue, &producers[i]);
+    }
+    for (size_t i = 0; i < QUEUE_PRODUCERS; i++) {
+        pthread_join(producer_threads[i], NULL);
+        atomic_fetch_add(&producers_done, 1);
+    }
+
+    size_t queued = 0;
+    size_t received = 0;
+    size_t out_of_order = 0;
+    for (size_t i = 0; i < QUEUE_WORKERS; i++) {
+        pthread_join(worker_threads[i], NULL);
+        received += workers[i].received;
+        out_of_order += workers[i].out_of_order;
+    }
+    for (size_t i = 0; i < QUEUE_PRODUCERS; i++) {
+        queued += producers[i].queued;
+    }
+    size_t expected = QUEUE_PRODUCERS * ((QUEUE_PACKETS + 63) / 64) * 64;
+    TEST_ASSERT("Shards deliver every packet", queued == expected && received == expected);
+    TEST_ASSERT("Shards keep order within a type", out_of_order == 0);
+
+    free(workers);
+
+    // A one-slot pool could never hand out a packet, so the receiver refuses it
+    // and pakit_receive_enqueue returns instead of waiting forever
+    PakitPacketPool single;
+    pakit_packet_pool_create(&single, 1, 64);
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    TEST_ASSERT("Enqueue needs two pool slots", pakit_attach_packet_pool(&receiver, &single) ==
+                PAKIT_STATUS_ERROR_NULL_PARAM && receiver.pooled == NULL);
+    uint8_t wire[HEADER_SIZE + 4] = {EXPECTED_SOP_0, EXPECTED_SOP_1, 0, 1, 0, 0, 0, 4, 1, 2, 3, 4};
+    size_t consumed = 0;
+    TEST_ASSERT("Enqueue without a pool", pakit_receive_enqueue(&receiver, wire, sizeof(wire), &shards,
+                &consumed) == 0 && consumed == 0);
+    pakit_destroy(&receiver);
+    pakit_packet_pool_destroy(&single);
+
+    pakit_shards_destroy(&shards);
+}
+
+// The library's own layout, and a variant without count field, other SOP
+// bytes, a 1-byte size and little-endian fields
+PAKIT_SPEC_RECEIVER(spec_default, EXPECTED_SOP_0, EXPECTED_SOP_1, 2, 2, 2, true, 255)
+PAKIT_SPEC_RECEIVER(spec_short, 0xAA, 0x55, 2, 0, 1, false, 200)
+
+void test_spec_receiver() {
+    TEST_ASSERT("Spec header sizes", spec_default_HEADER_SIZE == HEADER_SIZE && spec_short_HEADER_SIZE == 5);
+
+    // The default specialization decodes exactly what the library does
+    uint8_t stream[1024];
+    size_t length = 0;
+    uint8_t payload[40];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i + 1);
+    }
+    for (uint16_t i = 0; i < 12; i++) {
+        stream[length++] = (i % 3 == 0) ? EXPECTED_SOP_0 : 0x11;  // Garbage, sometimes a lone SOP byte
+        Packet packet;
+        pakit_packet_create(&packet, 0x0100 + i, i, (i % 4) ? payload : NULL, (i % 4) ? (uint16_t)(i * 3) : 0);
+        size_t written = 0;
+        pakit_encode_batch(&packet, 1, &stream[length], sizeof(stream) - length, &written, NULL);
+        length += written;
+    }
+
+    PakitReceiver reference;
+    pakit_create(&reference, NULL, 0);
+    PakitView expected[16];
+    size_t expected_count = 0;
+    size_t position = 0;
+    while (position < length) {
+        if (pakit_next_view(&reference, stream, length, &position, &expected[expected_count]) == PAKIT_STATUS_SUCCESS) {
+            expected_count++;
+        }
+    }
+    pakit_destroy(&reference);
+
+    spec_default_receiver* receiver = malloc(sizeof(spec_default_receiver));
+    spec_default_init(receiver);
+    size_t matched = 0;
+    for (size_t i = 0; i < length; i++) {
+        PakitView view;
+        if (spec_default_receive_byte(receiver, stream[i], &view) == PAKIT_STATUS_SUCCESS) {
+            matched += matched < expected_count && view.type == expected[matched].type &&
+                       view.count == expected[matched].count && view.size == expected[matched].size &&
+                       memcmp(view.payload, expected[matched].payload, view.size) == 0;
+        }
+    }
+    TEST_ASSERT("Spec byte path matches library", expected_count == 12 && matched == 12);
+
+    // Buffered path across uneven reads; packets inside a read come back in place
+    size_t in_place = 0;
+    matched = 0;
+    spec_default_init(receiver);
+    for (size_t offset = 0; offset < length; offset += 37) {
+        size_t end = (length - offset < 37) ? length : offset + 37;
+        position = offset;
+        while (position < end) {
+            PakitView view;
+            if (spec_default_receive_buffer(receiver, stream, end, &position, &view) == PAKIT_STATUS_SUCCESS) {
+                in_place += view.payload >= stream && view.payload < stream + length;
+                matched += view.type == expected[matched].type && view.size == expected[matched].size &&
+                           memcmp(view.payload, expected[matched].payload, view.size) == 0;
+            }
+        }
+    }
+    TEST_ASSERT("Spec buffer path matches library", matched == 12 && in_place > 0 && in_place < 12);
+    free(receiver);
+
+    // Input dense in first SOP bytes resyncs at the same places, with the same errors
+    uint8_t dense[600];
+    uint32_t seed = 4242;
+    for (size_t i = 0; i < sizeof(dense); i++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t pick = (seed >> 16) % 8;
+        dense[i] = (pick < 4) ? EXPECTED_SOP_0 : (pick < 6) ? EXPECTED_SOP_1 : (pick == 6) ? 0x00 : (uint8_t)seed;
+    }
+    pakit_create(&reference, NULL, 255);
+    size_t spec_position = 0;
+    size_t library_position = 0;
+    size_t results = 0;
+    bool same = true;
+    while (same && spec_position < sizeof(dense)) {
+        PakitView spec_view;
+        PakitView library_view;
+        PakitStatus spec_status = spec_default_parse(dense, sizeof(dense), &spec_position, &spec_view);
+        PakitStatus library_status = pakit_next_view(&reference, dense, sizeof(dense), &library_position,
+                                                     &library_view);
+        same = spec_status == library_status;
+        results++;
+        if (spec_status == PAKIT_STATUS_IN_PROGRESS) {
+            break;   // The library receiver buffers the tail, the parser leaves it
+        }
+        same = same && spec_position == library_position;
+    }
+    pakit_destroy(&reference);
+    TEST_ASSERT("Spec resync matches library", same && results > 20);
+
+    // Short format: AA 55 type(LE) size(1 byte) payload
+    const uint8_t short_stream[] = {0xAA, 0xAA, 0x55, 0x34, 0x12, 0x03, 'a', 'b', 'c',
+                                    0x00, 0xAA, 0x55, 0x01, 0x00, 0xC9,   // Size 201 is too large
+                                    0xAA, 0x55, 0x02, 0x00, 0x00};
+    spec_short_receiver short_receiver;
+    spec_short_init(&short_receiver);
+    PakitView views[3];
+    size_t count = 0;
+    PakitStatus statuses[sizeof(short_stream)];
+    for (size_t i = 0; i < sizeof(short_stream); i++) {
+        statuses[i] = spec_short_receive_byte(&short_receiver, short_stream[i], &views[count]);
+        count += statuses[i] == PAKIT_STATUS_SUCCESS;
+    }
+    TEST_ASSERT("Spec short format", count == 2 && views[0].type == 0x1234 && views[0].count == 0 &&
+                views[0].size == 3 && statuses[14] == PAKIT_STATUS_ERROR_SIZE_LARGE && views[1].type == 2 &&
+                views[1].size == 0 && memcmp(views[0].payload, "abc", 3) == 0);
+
+    position = 0;
+    size_t parsed = 0;
+    while (position < sizeof(short_stream)) {
+        PakitView view;
+        parsed += spec_short_parse(short_stream, sizeof(short_stream), &position, &view) == PAKIT_STATUS_SUCCESS;
+    }
+    TEST_ASSERT("Spec short in place", parsed == 2);
+}
+
+void test_timing() {
+    // Histogram buckets: exact below 16, within 1/16 above
+    bool buckets_ok = true;
+    const uint64_t values[] = {0, 1, 15, 16, 17, 100, 1000, 123456789, PAKIT_HISTOGRAM_MAX_NS - 1};
+    static PakitHistogram histogram;
+    static PakitHistogramSnapshot snapshot;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        memset(&histogram, 0, sizeof(histogram));
+        pakit_histogram_record(&histogram, values[i]);
+        pakit_histogram_snapshot(&histogram, &snapshot);
+        uint64_t reported = pakit_histogram_percentile(&snapshot, 50);
+        buckets_ok = buckets_ok && snapshot.total == 1 && reported == values[i];
+
+        size_t index = 0;
+        while (snapshot.counts[index] == 0) {
+            index++;
+        }
+        uint64_t low = pakit_histogram_bucket_value(index);
+        buckets_ok = buckets_ok && low <= values[i] && values[i] - low <= (values[i] >> 4);
+    }
+    TEST_ASSERT("Histogram buckets", buckets_ok);
+
+    memset(&histogram, 0, sizeof(histogram));
+    for (uint64_t v = 1; v <= 1000; v++) {
+        pakit_histogram_record(&histogram, v);
+    }
+    pakit_histogram_snapshot(&histogram, &snapshot);
+    uint64_t p50 = pakit_histogram_percentile(&snapshot, 50);
+    uint64_t p99 = pakit_histogram_percentile(&snapshot, 99);
+    TEST_ASSERT("Histogram percentiles", snapshot.total == 1000 && snapshot.max_ns == 1000 &&
+                p50 >= 500 && p50 <= 500 + 500 / 16 && p99 >= 990 && p99 <= 990 + 990 / 16 &&
+                pakit_histogram_percentile(&snapshot, 100) == 1000);
+
+    // A packet arriving in three reads
+    uint8_t payload[20];
+    memset(payload, 0x5A, sizeof(payload));
+    Packet packet;
+    pakit_packet_create(&packet, 0x0707, 3, payload, sizeof(payload));
+    uint8_t stream[2 * (HEADER_SIZE + sizeof(payload))];
+    size_t length = 0;
+    pakit_encode_batch(&packet, 1, stream, sizeof(stream), &length, NULL);
+    memcpy(&stream[length], stream, length);
+
+    PakitTiming* timing = malloc(sizeof(PakitTiming));
+    pakit_timing_reset(timing);
+    PakitReceiver receiver;
+    pakit_create(&receiver, NULL, 0);
+    pakit_set_timing(&receiver, timing);
+
+    const size_t cuts[] = {0, 5, 17, length};
+    const uint64_t arrivals[] = {100, 250, 1000};
+    PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
+    for (size_t i = 0; i < 3; i++) {
+        size_t position = 0;
+        status = pakit_receive_buffer_at(&receiver, &stream[cuts[i]], cuts[i + 1] - cuts[i], &position, arrivals[i]);
+    }
+    PakitPacketTimes times;
+    pakit_histogram_snapshot(&timing->complete, &snapshot);
+    TEST_ASSERT("Timing across reads", status == PAKIT_STATUS_SUCCESS && pakit_packet_times(&receiver, &times) &&
+                times.first_byte_ns == 100 && times.complete_ns == 1000 && snapshot.total == 1 &&
+                snapshot.max_ns == 900);
+    pakit_histogram_snapshot(&timing->stall, &snapshot);
+    TEST_ASSERT("Timing stalls", snapshot.total == 2 && snapshot.max_ns == 750 &&
+                pakit_histogram_percentile(&snapshot, 50) >= 150 &&
+                pakit_histogram_percentile(&snapshot, 50) <= 150 + 150 / 16);
+
+    // In place: first byte and completion in the same read
+    PakitView view;
+    size_t position = length;
+    memset(&times, 0, sizeof(times));
+    status = pakit_next_view_at(&receiver, stream, 2 * length, &position, 5000, &view, &times);
+    pakit_histogram_snapshot(&timing->complete, &snapshot);
+    TEST_ASSERT("Timing in place", status == PAKIT_STATUS_SUCCESS && view.payload == &stream[length + HEADER_SIZE] &&
+                times.first_byte_ns == 5000 && times.complete_ns == 5000 && snapshot.total == 2 &&
+                snapshot.counts[0] == 1);
+
+    // Byte at a time, 10 ns apart: every byte after the first is a stall
+    pakit_timing_reset(timing);
+    for (size_t i = 0; i < length; i++) {
+        status = pakit_receive_byte_at(&receiver, stream[i], 10000 + 10 * i);
+    }
+    pakit_histogram_snapshot(&timing->stall, &snapshot);
+    TEST_ASSERT("Timing byte path", status == PAKIT_STATUS_SUCCESS && snapshot.total == length - 1 &&
+                snapshot.counts[10] == length - 1 && timing->last.complete_ns - timing->last.first_byte_ns ==
+                10 * (length - 1));
+
+    // Pickup latency
+    pakit_timing_pickup(timing, times.complete_ns, times.complete_ns + 300);
+    pakit_histogram_snapshot(&timing->wait, &snapshot);
+    TEST_ASSERT("Timing pickup", snapshot.total == 1 && pakit_histogram_percentile(&snapshot, 99) == 300);
+
+    // Detached: the timed calls behave like the plain ones
+    pakit_set_timing(&receiver, NULL);
+    position = 0;
+    TEST_ASSERT("Timing detached", pakit_receive_buffer_at(&receiver, stream, length, &position, 1) ==
+                PAKIT_STATUS_SUCCESS && !pakit_packet_times(&receiver, &times));
+
+    pakit_destroy(&receiver);
+    free(timing);
+}
+
+void test_type_filter() {
+    // Ten packets of types 1..10, payload bytes equal to the type
+    uint8_t stream[10 * (HEADER_SIZE + 30 + PAKIT_CRC_SIZE)];
+    uint8_t payloads[10][30];
+    Packet packets[10];
+    for (uint16_t i = 0; i < 10; i++) {
+        memset(payloads[i], i + 1, sizeof(payloads[i]));
+        pakit_packet_create(&packets[i], i + 1, i, payloads[i], (uint16_t)(10 + i * 2));
+    }
+    size_t length = 0;
+    pakit_encode_batch(packets, 10, stream, sizeof(stream), &length, NULL);
+
+    PakitTypeFilter* filter = malloc(sizeof(PakitTypeFilter));
+    pakit_filter_init(filter, false);
+    pakit_filter_set(filter, 2, 2, true);
+    pakit_filter_set(filter, 7, 7, true);
+    TEST_ASSERT("Filter bitmap", pakit_filter_accepts(filter, 2) && pakit_filter_accepts(filter, 7) &&
+                !pakit_filter_accepts(filter, 1) && !pakit_filter_accepts(filter, 0xFFFF));
+
+    uint8_t storage[64];
+    PakitReceiver receiver;
+    pakit_create(&receiver, storage, sizeof(storage));
+    pakit_set_filter(&receiver, filter);
+
+    // In place: filtered packets are stepped over within the same call
+    PakitView view;
+    size_t position = 0;
+    PakitStatus status = pakit_next_view(&receiver, stream, length, &position, &view);
+    TEST_ASSERT("Filter skips in place", status == PAKIT_STATUS_SUCCESS && view.type == 2 &&
+                view.payload == &stream[HEADER_SIZE + 10 + HEADER_SIZE] &&
+                position == 2 * HEADER_SIZE + 10 + 12);
+    status = pakit_next_view(&receiver, stream, length, &position, &view);
+    TEST_ASSERT("Filter next wanted packet", status == PAKIT_STATUS_SUCCESS && view.type == 7 && view.size == 22);
+    status = pakit_next_view(&receiver, stream, length, &position, &view);
+    TEST_ASSERT("Filter rest skipped", status == PAKIT_STATUS_IN_PROGRESS && position == length &&
+                receiver.received_bytes == 0);
+
+    // Byte by byte: rejected payloads never reach the storage
+    memset(storage, 0xEE, sizeof(storage));
+    int delivered = 0;
+    uint16_t types = 0;
+    bool storage_untouched = true;
+    for (size_t i = 0; i < length; i++) {
+        Packet packet;
+        if (pakit_receive_byte(&receiver, stream[i]) == PAKIT_STATUS_SUCCESS &&
+            pakit_is_packet_complete(&receiver, &packet)) {
+            delivered++;
+            types = (uint16_t)(types * 16 + packet.type[1]);
+        }
+        // Packet 2 (type 2) is the first one stored
+        if (i < HEADER_SIZE + 10 + HEADER_SIZE) {
+            storage_untouched = storage_untouched && storage[0] == 0xEE;
+        }
+    }
+    TEST_ASSERT("Filter byte path", delivered == 2 && types == 0x27 && storage_untouched);
+
+    // Short reads: the skip continues across reads
+    delivered = 0;
+    for (size_t offset = 0; offset < length; offset += 3) {
+        size_t end = (length - offset < 3) ? length : offset + 3;
+        position = offset;
+        while (position < end) {
+            delivered += pakit_receive_buffer(&receiver, stream, end, &position) == PAKIT_STATUS_SUCCESS;
+        }
+    }
+    TEST_ASSERT("Filter short reads", delivered == 2);
+
+    // CRC mode: trailers of filtered packets are skipped unchecked
+    pakit_set_crc(&receiver, true);
+    length = 0;
+    for (size_t i = 0; i < 10; i++) {
+        length += pakit_encode_crc(&packets[i], &stream[length], sizeof(stream) - length);
+    }
+    stream[HEADER_SIZE + 5] ^= 0xFF;   // Corrupt packet 1, which is filtered
+    PakitView views[8];
+    size_t consumed = 0;
+    size_t count = pakit_receive_batch(&receiver, stream, length, views, 8, &consumed);
+    TEST_ASSERT("Filter CRC mode", count == 2 && consumed == length && views[0].type == 2 && views[1].type == 7);
+
+    // Everything passes once the filter is removed
+    pakit_set_crc(&receiver, false);
+    pakit_set_filter(&receiver, NULL);
+    length = 0;
+    pakit_encode_batch(packets, 10, stream, sizeof(stream), &length, NULL);
+    count = pakit_receive_batch(&receiver, stream, length, views, 8, &consumed);
+    TEST_ASSERT("Filter removed", receiver.filter == NULL && count == 8);
+
+    pakit_destroy(&receiver);
+    free(filter);
+}
+
+// Fields as the spec defines them: big-endian, decoded byte by byte
+static void header_fields(const uint8_t* header, uint16_t* type, uint16_t* count, uint16_t* size) {
+    *type = (uint16_t)((header[2] << 8) | header[3]);
+    *count = (uint16_t)((header[4] << 8) | header[5]);
+    *size = (uint16_t)((header[6] << 8) | header[7]);
+}
+
+void test_header_word_decode() {
+    // Every reader of a stored or in-place header decodes it with one 64-bit
+    // load; check each against the byte-wise fields on arbitrary headers
+    uint32_t seed = 12345;
+    uint8_t wire[HEADER_SIZE + 64];
+    bool stream_ok = true;
+    bool byte_ok = true;
+    bool view_ok = true;
+    bool buffered_ok = true;
+    bool filter_ok = true;
+
+    PakitTypeFilter* filter = malloc(sizeof(PakitTypeFilter));
+    pakit_filter_init(filter, false);
+    pakit_filter_set(filter, 0x8000, 0xFFFF, true);
+
+    for (int round = 0; round < 500; round++) {
+        wire[0] = EXPECTED_SOP_0;
+        wire[1] = EXPECTED_SOP_1;
+        for (size_t i = 2; i < sizeof(wire); i++) {
+            seed = seed * 1103515245u + 12345u;
+            wire[i] = (uint8_t)(seed >> 16);
+        }
+        wire[6] = 0;
+        wire[7] &= 0x3F;   // Payload up to 63 bytes
+        uint16_t type, count, size;
+        header_fields(wire, &type, &count, &size);
+        size_t length = HEADER_SIZE + size;
+
+        // Stream header callback
+        StreamLog* log = calloc(1, sizeof(StreamLog));
+        PakitStream stream = {stream_header, NULL, NULL, log, 64};
+        PakitReceiver receiver;
+        pakit_create(&receiver, NULL, 64);
+        pakit_set_stream(&receiver, &stream);
+        pakit_receive_buffer(&receiver, wire, length, NULL);
+        stream_ok = stream_ok && log->headers == 1 && log->header.type == type &&
+                    log->header.count == count && log->header.size == size;
+        pakit_set_stream(&receiver, NULL);
+        free(log);
+
+        // Byte path and pakit_is_packet_complete
+        Packet packet;
+        PakitStatus status = PAKIT_STATUS_IN_PROGRESS;
+        for (size_t i = 0; i < length; i++) {
+            status = pakit_receive_byte(&receiver, wire[i]);
+        }
+        byte_ok = byte_ok && status == PAKIT_STATUS_SUCCESS && pakit_is_packet_complete(&receiver, &packet) &&
+                  ((packet.type[0] << 8) | packet.type[1]) == type && packet.count == count && packet.size == size;
+
+        // In place, and buffered across two reads
+        PakitView view;
+        size_t position = 0;
+        status = pakit_next_view(&receiver, wire, length, &position, &view);
+        view_ok = view_ok && status == PAKIT_STATUS_SUCCESS && view.type == type && view.count == count &&
+                  view.size == size && view.payload == &wire[HEADER_SIZE];
+        position = 0;
+        pakit_next_view(&receiver, wire, 5, &position, &view);
+        status = pakit_next_view(&receiver, wire, length, &position, &view);
+        buffered_ok = buffered_ok && status == PAKIT_STATUS_SUCCESS && view.type == type &&
+                      view.count == count && view.size == size && view.payload == receiver.payload;
+
+        // The type filter decides on the decoded type, byte by byte too
+        pakit_set_filter(&receiver, filter);
+        bool delivered = false;
+        for (size_t i = 0; i < length; i++) {
+            delivered = pakit_receive_byte(&receiver, wire[i]) == PAKIT_STATUS_SUCCESS || delivered;
+        }
+        filter_ok = filter_ok && delivered == (type >= 0x8000);
+        pakit_destroy(&receiver);
+    }
+    free(filter);
+
+    TEST_ASSERT("Header word: stream header", stream_ok);
+    TEST_ASSERT("Header word: byte path", byte_ok);
+    TEST_ASSERT("Header word: in-place view", view_ok);
+    TEST_ASSERT("Header word: buffered view", buffered_ok);
+    TEST_ASSERT("Header word: filtered type", filter_ok);
+}
+
+typedef struct {
+    uint16_t counts[8];
+    size_t seen;
+    size_t stop_after;           // Return false after this many packets, 0 never
+    bool in_place;
+} DemuxLog;
+
+static bool log_demux(void* context, const PakitView* view) {
+    DemuxLog* log = context;
+    if (log->seen < 8) {
+        log->counts[log->seen] = view->count;
+    }
+    log->seen++;
+    return log->stop_after == 0 || log->seen < log->stop_after;
+}
+
+typedef struct {
+    PakitQueue* queue;
+    size_t packets;
+    size_t bad;
+} DemuxConsumer;
+
+static void* drain_demux(void* argument) {
+    DemuxConsumer* consumer = argument;
+    PakitPacket* packets[4];
+    size_t received = 0;
+    while (received < consumer->packets) {
+        size_t count = pakit_queue_pop_batch(consumer->queue, packets, 4);
+        for (size_t i = 0; i < count; i++) {
+            if (packets[i]->view.count != (uint16_t)(received + i) || packets[i]->view.payload[0] != 1) {
+                consumer->bad++;
+            }
+            pakit_packet_release(packets[i]);
+        }
+        received += count;
+        if (count == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void test_demux() {
+    // Four logical streams: type 1 queued (wait), type 2 queued (drop), type 3
+    // to a callback, type 9 without a stream. Type 2 skips counts 2..4.
+    static const uint16_t types[9] = {1, 2, 3, 9, 1, 2, 3, 2, 1};
+    static const uint16_t counts[9] = {0, 0, 0, 0, 1, 1, 1, 5, 2};
+    uint8_t payloads[10][20];
+    Packet packets[9];
+    for (size_t i = 0; i < 9; i++) {
+        memset(payloads[types[i]], types[i], sizeof(payloads[types[i]]));
+        pakit_packet_create(&packets[i], types[i], counts[i], payloads[types[i]], 20);
+    }
+    uint8_t stream[9 * (HEADER_SIZE + 20)];
+    size_t length = 0;
+    pakit_encode_batch(packets, 9, stream, sizeof(stream), &length, NULL);
+
+    PakitPacketPool pool;
+    pakit_packet_pool_create(&pool, 16, 64);
+    uint8_t storage[64];
+    PakitReceiver receiver;
+    pakit_create(&receiver, storage, sizeof(storage));
+    TEST_ASSERT("Demux receiver pooled", pakit_attach_packet_pool(&receiver, &pool) == PAKIT_STATUS_SUCCESS);
+
+    PakitQueue waiting;
+    PakitQueue dropping;
+    pakit_queue_create(&waiting, 4);
+    pakit_queue_create(&dropping, 2);
+
+    PakitDemux demux;
+    PakitDemuxStream streams[3];
+    DemuxLog log = {0};
+    pakit_demux_init(&demux, &pool);
+    TEST_ASSERT("Demux needs a sink", pakit_demux_add_queue(&demux, &streams[0], 1, NULL, PAKIT_DEMUX_WAIT) ==
+                PAKIT_STATUS_ERROR_NULL_PARAM);
+    TEST_ASSERT("Demux add streams",
+                pakit_demux_add_queue(&demux, &streams[0], 1, &waiting, PAKIT_DEMUX_WAIT) == PAKIT_STATUS_SUCCESS &&
+                pakit_demux_add_queue(&demux, &streams[1], 2, &dropping, PAKIT_DEMUX_DROP) == PAKIT_STATUS_SUCCESS &&
+                pakit_demux_add_callback(&demux, &streams[2], 3, log_demux, &log) == PAKIT_STATUS_SUCCESS);
+    TEST_ASSERT("Demux find", pakit_demux_find(&demux, 2) == &streams[1] && pakit_demux_find(&demux, 9) == NULL &&
+                pakit_demux_find(&demux, 0x0301) == NULL);
+
+    // One read: the full drop queue sheds type 2 only
+    size_t consumed = 0;
+    size_t delivered = pakit_demux_receive(&demux, &receiver, stream, length, &consumed);
+    TEST_ASSERT("Demux routes", delivered == 7 && consumed == length && demux.unrouted == 1);
+    TEST_ASSERT("Demux stream stats", streams[0].stats.packets == 3 && streams[0].stats.dropped == 0 &&
+                streams[1].stats.packets == 2 && streams[1].stats.dropped == 1 && streams[2].stats.packets == 2);
+    TEST_ASSERT("Demux callback", log.seen == 2 && log.counts[0] == 0 && log.counts[1] == 1);
+    TEST_ASSERT("Demux sequences per stream", streams[1].sequence.stats.gaps == 1 &&
+                streams[1].sequence.stats.lost == 3 && streams[0].sequence.stats.gaps == 0 &&
+                streams[2].sequence.stats.gaps == 0);
+
+    PakitPacket* popped[8];
+    size_t count = pakit_queue_pop_batch(&waiting, popped, 8);
+    bool intact = count == 3;
+    for (size_t i = 0; i < count; i++) {
+        intact = intact && popped[i]->view.type == 1 && popped[i]->view.count == i &&
+                 popped[i]->view.size == 20 && popped[i]->view.payload[19] == 1;
+        pakit_packet_release(popped[i]);
+    }
+    TEST_ASSERT("Demux queue holds copies", intact);
+    count = pakit_queue_pop_batch(&dropping, popped, 8);
+    TEST_ASSERT("Demux drop queue", count == 2 && popped[0]->view.count == 0 && popped[1]->view.count == 1);
+    for (size_t i = 0; i < count; i++) {
+        pakit_packet_release(popped[i]);
+    }
+
+    // Short reads: packets spanning reads are taken from the receiver's slot
+    size_t before = streams[0].stats.packets;
+    for (size_t offset = 0; offset < length; offset += 7) {
+        size_t end = (length - offset < 7) ? length - offset : 7;
+        pakit_demux_receive(&demux, &receiver, &stream[offset], end, NULL);
+    }
+    count = pakit_queue_pop_batch(&waiting, popped, 8);
+    intact = count == 3 && streams[0].stats.packets == before + 3;
+    for (size_t i = 0; i < count; i++) {
+        intact = intact && popped[i]->view.count == i && popped[i]->view.payload[0] == 1 &&
+                 popped[i]->view.payload[19] == 1;
+        pakit_packet_release(popped[i]);
+    }
+    TEST_ASSERT("Demux short reads", intact && log.seen == 4 && demux.unrouted == 2);
+    count = pakit_queue_pop_batch(&dropping, popped, 8);
+    for (size_t i = 0; i < count; i++) {
+        pakit_packet_release(popped[i]);
+    }
+
+    // A callback returning false ends the call right after its packet
+    log.seen = 0;
+    log.stop_after = 1;
+    delivered = pakit_demux_receive(&demux, &receiver, stream, length, &consumed);
+    TEST_ASSERT("Demux callback pauses", delivered == 3 && consumed == 3 * (HEADER_SIZE + 20));
+    count = pakit_queue_pop_batch(&waiting, popped, 8);
+    count += pakit_queue_pop_batch(&dropping, &popped[count], 8 - count);
+    for (size_t i = 0; i < count; i++) {
+        pakit_packet_release(popped[i]);
+    }
+    log.stop_after = 0;
+
+    // The filter follows the routed types
+    PakitTypeFilter* filter = malloc(sizeof(PakitTypeFilter));
+    pakit_demux_set_filter(&demux, filter);
+    TEST_ASSERT("Demux filter synced", pakit_filter_accepts(filter, 1) && pakit_filter_accepts(filter, 3) &&
+                !pakit_filter_accepts(filter, 9) && !pakit_filter_accepts(filter, 0));
+    pakit_demux_remove(&demux, 3);
+    TEST_ASSERT("Demux remove", pakit_demux_find(&demux, 3) == NULL && !pakit_filter_accepts(filter, 3));
+    pakit_set_filter(&receiver, filter);
+    size_t unrouted = demux.unrouted;
+    delivered = pakit_demux_receive(&demux, &receiver, stream, length, &consumed);
+    TEST_ASSERT("Demux filtered receiver", delivered == 5 && demux.unrouted == unrouted);
+    count = pakit_queue_pop_batch(&waiting, popped, 8);
+    count += pakit_queue_pop_batch(&dropping, &popped[count], 8 - count);
+    for (size_t i = 0; i < count; i++) {
+        pakit_packet_release(popped[i]);
+    }
+    pakit_set_filter(&receiver, NULL);
+    pakit_demux_set_filter(&demux, NULL);
+    free(filter);
+
+    // Wait: a slow consumer holds the reader back without losing packets
+    enum { DEMUX_PACKETS = 200 };
+    size_t burst_size = DEMUX_PACKETS * (HEADER_SIZE + 20);
+    uint8_t* burst = malloc(burst_size);
+    Packet* burst_packets = malloc(DEMUX_PACKETS * sizeof(Packet));
+    for (uint16_t i = 0; i < DEMUX_PACKETS; i++) {
+        pakit_packet_create(&burst_packets[i], 1, i, payloads[1], 20);
+    }
+    length = 0;
+    pakit_encode_batch(burst_packets, DEMUX_PACKETS, burst, burst_size, &length, NULL);
+    free(burst_packets);
+    pakit_sequence_reset(&streams[0].sequence);
+    DemuxConsumer consumer = {&waiting, DEMUX_PACKETS, 0};
+    pthread_t thread;
+    pthread_create(&thread, NULL, drain_demux, &consumer);
+    delivered = pakit_demux_receive(&demux, &receiver, burst, length, &consumed);
+    pthread_join(thread, NULL);
+    TEST_ASSERT("Demux wait policy", delivered == DEMUX_PACKETS && consumer.bad == 0 &&
+                streams[0].sequence.stats.gaps == 0);
+
+    // Wait on the smallest pool a receiver takes: short reads make every packet
+    // come from the receiver's slot, handed over as the consumer frees the other
+    PakitPacketPool pair;
+    pakit_packet_pool_create(&pair, 2, 64);
+    PakitReceiver tight;
+    pakit_create(&tight, NULL, 0);
+    TEST_ASSERT("Demux two-slot pool", pakit_attach_packet_pool(&tight, &pair) == PAKIT_STATUS_SUCCESS);
+    pakit_demux_destroy(&demux);
+    pakit_demux_init(&demux, NULL);
+    pakit_demux_add_queue(&demux, &streams[0], 1, &waiting, PAKIT_DEMUX_WAIT);
+    DemuxConsumer tight_consumer = {&waiting, DEMUX_PACKETS, 0};
+    pthread_create(&thread, NULL, drain_demux, &tight_consumer);
+    delivered = 0;
+    for (size_t offset = 0; offset < length; offset += 5) {
+        size_t end = (length - offset < 5) ? length - offset : 5;
+        delivered += pakit_demux_receive(&demux, &tight, &burst[offset], end, NULL);
+    }
+    pthread_join(thread, NULL);
+    TEST_ASSERT("Demux wait on receiver slots", delivered == DEMUX_PACKETS && tight_consumer.bad == 0 &&
+                streams[0].stats.dropped == 0);
+    pakit_destroy(&tight);
+    pakit_packet_pool_destroy(&pair);
+    free(burst);
+
+    pakit_demux_destroy(&demux);
+    pakit_queue_destroy(&waiting);
+    pakit_queue_destroy(&dropping);
+    pakit_destroy(&receiver);
+    pakit_packet_pool_destroy(&pool);
+}
+
 int main() {
     printf("Starting Pakit tests...\n");
 
@@ -395,6 +2768,8 @@ int main() {
     RUN_TEST(test_initialization);
     RUN_TEST(test_valid_packet_byte_by_byte);
     RUN_TEST(test_packet_create);
+    RUN_TEST(test_encode_header);
+    RUN_TEST(test_encode_batch);
 
     // Edge case tests
     RUN_TEST(test_invalid_packet_handling);
@@ -406,6 +2781,33 @@ int main() {
 
     // Multiple packet tests
     RUN_TEST(test_multiple_packets);
+    RUN_TEST(test_receive_buffer_bulk_matches_byte_path);
+    RUN_TEST(test_resync_skips_garbage_run);
+    RUN_TEST(test_find_sop_matches_scalar_scan);
+    RUN_TEST(test_reset_and_clear);
+    RUN_TEST(test_caller_storage);
+    RUN_TEST(test_receiver_pool);
+    RUN_TEST(test_ring_receive);
+    RUN_TEST(test_parallel_decode_matches_single_thread);
+    RUN_TEST(test_capture_file_round_trip);
+    RUN_TEST(test_capture_index);
+    RUN_TEST(test_crc32c);
+    RUN_TEST(test_crc_trailer);
+    RUN_TEST(test_sequence_tracking);
+    RUN_TEST(test_receiver_stats);
+    RUN_TEST(test_type_dispatch);
+    RUN_TEST(test_stream_delivery);
+    RUN_TEST(test_packet_pool);
+    RUN_TEST(test_packet_queue);
+    RUN_TEST(test_spec_receiver);
+    RUN_TEST(test_timing);
+    RUN_TEST(test_type_filter);
+    RUN_TEST(test_header_word_decode);
+    RUN_TEST(test_demux);
+    RUN_TEST(test_io_loop);
+    RUN_TEST(test_back_to_back_max_size_packets);
+    RUN_TEST(test_next_view_zero_copy);
+    RUN_TEST(test_receive_batch);
 
     print_test_summary();
 